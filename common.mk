@@ -17,6 +17,39 @@ endif
 
 WARNFLAGS+=-Wno-psabi
 
+# LOOP_TIMING=1 times every LemLib motion and odometry loop, see include/loopTiming.hpp. The timing hooks are linked in
+# with --wrap, which only reaches LemLib when it is linked into the same image as the project, so LemLib is kept out
+# of the cold package. Clean the project after changing it
+LOOP_TIMING?=0
+# SENSOR_LOG=1 records what the odometry task reads, see include/sensorLog.hpp. It finds the odometry task with the
+# loop timing hooks, so it turns those on too
+ifeq ($(SENSOR_LOG),1)
+	override LOOP_TIMING = 1
+	CPPFLAGS += -DSENSOR_LOG
+endif
+LOOP_TIMING_WRAP=delay task_delay task_delay_until _ZN6lemlib13TrackingWheel19getDistanceTraveledEv
+ifeq ($(LOOP_TIMING),1)
+	CPPFLAGS += -DLOOP_TIMING
+	EXCLUDE_COLD_LIBRARIES += $(FWDIR)/LemLib.a
+endif
+# ODOM_TASK=1 runs odometry in its own fixed rate task, see include/odomTask.hpp. Hooked in the same way as the loop
+# timing
+ODOM_TASK?=0
+ODOM_TASK_WRAP=_ZN6lemlib4initEv _ZN6lemlib7getPoseEb _ZN6lemlib7setPoseENS_4PoseEb
+# both of the above need to know which tasks run motions, see include/motionTasks.hpp. The hooks are shared, since a
+# function can only be wrapped once
+MOTION_WRAP=_ZN6lemlib7Chassis18requestMotionStartEv _ZN6lemlib7Chassis9endMotionEv
+ifeq ($(ODOM_TASK),1)
+	CPPFLAGS += -DODOM_TASK
+	EXCLUDE_COLD_LIBRARIES += $(FWDIR)/LemLib.a
+endif
+# BATTERY_COMP=1 scales the commands of the compensated motors by the battery voltage, see
+# include/batteryCompensation.hpp. It needs no hooks, so the cold package is left alone
+BATTERY_COMP?=0
+ifeq ($(BATTERY_COMP),1)
+	CPPFLAGS += -DBATTERY_COMP
+endif
+
 SPACE := $() $()
 COMMA := ,
 
@@ -34,6 +67,9 @@ LIBRARIES+=$(wildcard $(FWDIR)/*.a)
 EXCLUDE_COLD_LIBRARIES+=$(FWDIR)/libc.a $(FWDIR)/libm.a
 COLD_LIBRARIES=$(filter-out $(EXCLUDE_COLD_LIBRARIES), $(LIBRARIES))
 wlprefix=-Wl,$(subst $(SPACE),$(COMMA),$1)
+HOOK_WRAP=$(if $(filter 1,$(LOOP_TIMING)),$(LOOP_TIMING_WRAP)) $(if $(filter 1,$(ODOM_TASK)),$(ODOM_TASK_WRAP)) \
+          $(if $(filter 1,$(LOOP_TIMING) $(ODOM_TASK)),$(MOTION_WRAP))
+HOOK_LDFLAGS=$(if $(strip $(HOOK_WRAP)),$(call wlprefix,$(addprefix --wrap=,$(strip $(HOOK_WRAP)))))
 LNK_FLAGS=--gc-sections --start-group $(strip $(LIBRARIES)) -lgcc -lstdc++ --end-group -T$(FWDIR)/v5-common.ld
 
 ASMFLAGS=$(MFLAGS) $(WARNFLAGS)
@@ -230,7 +266,7 @@ $(MONOLITH_BIN): $(MONOLITH_ELF) $(BINDIR)
 
 $(MONOLITH_ELF): $(ELF_DEPS) $(LIBRARIES)
 	$(call _pros_ld_timestamp)
-	$(call test_output_2,Linking project with $(ARCHIVE_TEXT_LIST) ,$(LD) $(LDFLAGS) $(ELF_DEPS) $(LDTIMEOBJ) $(call wlprefix,-T$(FWDIR)/v5.ld $(LNK_FLAGS)) -o $@,$(OK_STRING))
+	$(call test_output_2,Linking project with $(ARCHIVE_TEXT_LIST) ,$(LD) $(LDFLAGS) $(ELF_DEPS) $(LDTIMEOBJ) $(HOOK_LDFLAGS) $(call wlprefix,-T$(FWDIR)/v5.ld $(LNK_FLAGS)) -o $@,$(OK_STRING))
 	@echo Section sizes:
 	-$(VV)$(SIZETOOL) $(SIZEFLAGS) $@ $(SIZES_SED) $(SIZES_NUMFMT)
 
@@ -249,7 +285,7 @@ $(HOT_BIN): $(HOT_ELF) $(COLD_BIN)
 
 $(HOT_ELF): $(COLD_ELF) $(ELF_DEPS)
 	$(call _pros_ld_timestamp)
-	$(call test_output_2,Linking hot project with $(COLD_ELF) and $(ARCHIVE_TEXT_LIST) ,$(LD) -nostartfiles $(LDFLAGS) $(call wlprefix,-R $<) $(filter-out $<,$^) $(LDTIMEOBJ) $(LIBRARIES) $(call wlprefix,-T$(FWDIR)/v5-hot.ld $(LNK_FLAGS) -o $@),$(OK_STRING))
+	$(call test_output_2,Linking hot project with $(COLD_ELF) and $(ARCHIVE_TEXT_LIST) ,$(LD) -nostartfiles $(LDFLAGS) $(call wlprefix,-R $<) $(filter-out $<,$^) $(LDTIMEOBJ) $(LIBRARIES) $(HOOK_LDFLAGS) $(call wlprefix,-T$(FWDIR)/v5-hot.ld $(LNK_FLAGS) -o $@),$(OK_STRING))
 	@printf "%s\n" "Section sizes:"
 	-$(VV)$(SIZETOOL) $(SIZEFLAGS) $@ $(SIZES_SED) $(SIZES_NUMFMT)
 
@@ -296,6 +332,120 @@ $(VV)mkdir -p $(dir $(LDTIMEOBJ))
 $(call test_output_2,Adding timestamp ,echo 'const int _PROS_COMPILE_TIMESTAMP_INT = $(shell echo $$(($$(date +%s)+($$(date +%-z)/100*3600)))); char const * const _PROS_COMPILE_TIMESTAMP = __DATE__ " " __TIME__; char const * const _PROS_COMPILE_DIRECTORY = "$(wildcard $(shell pwd | tail -c 23))";' | $(CC) -c -x c $(CFLAGS) $(EXTRA_CFLAGS) -o $(LDTIMEOBJ) -,$(OK_STRING))
 endef
 
+# host simulator: builds the project against the simulated PROS devices in sim/ and runs it on the host.
+# LemLib is only shipped as headers in this project, so point LEMLIB_SRC at a checkout of the LemLib sources
+HOSTCXX?=g++
+SIMDIR=$(ROOT)/sim
+SIMBIN=$(BINDIR)/sim
+AUTONBENCH=$(BINDIR)/auton-bench
+MATHBENCH=$(BINDIR)/math-bench
+ODOMREPLAY=$(BINDIR)/odom-replay
+GAINSWEEP=$(BINDIR)/gain-sweep
+AUTOTUNE=$(BINDIR)/auto-tune
+BENCHCHECK=$(BINDIR)/bench-check
+SYSID=$(BINDIR)/sys-id
+# results `make bench` checks for regressions against. Regenerate it with `make bench-baseline` on the machine that
+# runs the check, since ns/call depends on the host
+BENCH_BASELINE?=$(SIMDIR)/bench-baseline.json
+# set to 1 to pass `make bench` when there is no baseline at BENCH_BASELINE, rather than fail
+BENCH_ALLOW_MISSING_BASELINE?=0
+BENCHOUT=$(BINDIR)/bench
+SIMOBJDIR=$(BINDIR)/host
+LEMLIB_SRC?=
+SIMFLAGS=$(CPPFLAGS) -O2 -g -pthread --std=$(CXX_STANDARD) -iquote"$(INCDIR)" -iquote"$(SIMDIR)/include"
+SIMSRC=$(call rwildcard,$(SRCDIR),*.cpp) $(call rwildcard,$(SIMDIR)/src,*.cpp)
+SIMLIBSRC=$(if $(LEMLIB_SRC),$(call rwildcard,$(LEMLIB_SRC)/src/lemlib,*.cpp))
+SIMOBJ=$(addprefix $(SIMOBJDIR)/,$(patsubst $(ROOT)/%,%.o,$(SIMSRC))) \
+       $(addprefix $(SIMOBJDIR)/lemlib/,$(patsubst $(LEMLIB_SRC)/src/lemlib/%,%.o,$(SIMLIBSRC)))
+SIMTOOLOBJ=$(SIMOBJDIR)/sim/tools
+# the autonomous benchmark intercepts these LemLib calls, and the profiled motions of include/profiledChassis.hpp, to
+# time every motion. With ODOM_TASK it hears about motions starting and ending from the project's own MOTION_WRAP hooks
+AUTONBENCH_WRAP=_ZN6lemlib7Chassis10moveToPoseEfffiNS_16MoveToPoseParamsEb \
+                _ZN6lemlib7Chassis11moveToPointEffiNS_17MoveToPointParamsEb \
+                _ZN6lemlib7Chassis13turnToHeadingEfiNS_19TurnToHeadingParamsEb \
+                $(MOTION_WRAP) \
+                _ZN15ProfiledChassis18moveToPoseProfiledEfffiN6lemlib16MoveToPoseParamsEb \
+                _ZN15ProfiledChassis19moveToPointProfiledEffiN6lemlib17MoveToPointParamsEb \
+                _ZN15ProfiledChassis21turnToHeadingProfiledEfiN6lemlib19TurnToHeadingParamsEb
+
+define check_lemlib_src
+$(if $(LEMLIB_SRC),,$(error Set LEMLIB_SRC to a checkout of the LemLib $(VERSION) sources to build the simulator))
+endef
+
+.PHONY: sim auton-bench math-bench odom-replay gain-sweep auto-tune bench bench-baseline sys-id
+sim: $(SIMBIN)
+
+auton-bench: $(AUTONBENCH)
+
+math-bench: $(MATHBENCH)
+
+odom-replay: $(ODOMREPLAY)
+
+gain-sweep: $(GAINSWEEP)
+
+auto-tune: $(AUTOTUNE)
+
+sys-id: $(SYSID)
+
+# runs the autonomous and math benchmarks, and fails if they got worse than BENCH_BASELINE allows, if there is no
+# baseline, or if the math benchmark's accuracy checks fail
+bench: $(AUTONBENCH) $(MATHBENCH) $(BENCHCHECK)
+	$(VV)mkdir -p $(BENCHOUT)
+	$(AUTONBENCH) --out $(BENCHOUT)/auton-bench.json
+	$(MATHBENCH) --out $(BENCHOUT)/math-bench.json
+	$(BENCHCHECK) --baseline $(BENCH_BASELINE) --auton $(BENCHOUT)/auton-bench.json --math $(BENCHOUT)/math-bench.json \
+	    $(if $(filter 1,$(BENCH_ALLOW_MISSING_BASELINE)),--allow-missing-baseline)
+
+bench-baseline: $(AUTONBENCH) $(MATHBENCH) $(BENCHCHECK)
+	$(VV)mkdir -p $(BENCHOUT)
+	$(AUTONBENCH) --out $(BENCHOUT)/auton-bench.json
+	$(MATHBENCH) --out $(BENCHOUT)/math-bench.json
+	$(BENCHCHECK) --baseline $(BENCH_BASELINE) --auton $(BENCHOUT)/auton-bench.json --math $(BENCHOUT)/math-bench.json \
+	    --update
+
+$(SIMBIN): $(SIMOBJ) $(SIMTOOLOBJ)/runner.cpp.o
+	$(call check_lemlib_src)
+	$(call test_output_2,Linking simulator ,$(HOSTCXX) -pthread $^ $(HOOK_LDFLAGS) -o $@,$(OK_STRING))
+
+$(AUTONBENCH): $(SIMOBJ) $(SIMTOOLOBJ)/autonBench.cpp.o
+	$(call check_lemlib_src)
+	$(if $(filter 1,$(LOOP_TIMING)),$(error The autonomous benchmark wraps the LemLib motion calls itself, build it without LOOP_TIMING))
+	$(call test_output_2,Linking autonomous benchmark ,$(HOSTCXX) -pthread $^ $(call wlprefix,$(addprefix --wrap=,$(AUTONBENCH_WRAP) $(if $(filter 1,$(ODOM_TASK)),$(ODOM_TASK_WRAP)))) -o $@,$(OK_STRING))
+
+$(MATHBENCH): $(SIMOBJ) $(SIMTOOLOBJ)/mathBench.cpp.o
+	$(call check_lemlib_src)
+	$(call test_output_2,Linking math benchmark ,$(HOSTCXX) -pthread $^ $(HOOK_LDFLAGS) -o $@,$(OK_STRING))
+
+$(ODOMREPLAY): $(SIMOBJ) $(SIMTOOLOBJ)/odomReplay.cpp.o
+	$(call check_lemlib_src)
+	$(if $(filter 1,$(LOOP_TIMING)),$(error The odometry replay wraps the tracking wheels itself, build it without LOOP_TIMING or SENSOR_LOG))
+	$(if $(filter 1,$(ODOM_TASK)),$(error The odometry replay updates odometry itself, build it without ODOM_TASK))
+	$(call test_output_2,Linking odometry replay ,$(HOSTCXX) -pthread $^ $(call wlprefix,--wrap=_ZN6lemlib13TrackingWheel19getDistanceTraveledEv) -o $@,$(OK_STRING))
+
+$(GAINSWEEP): $(SIMOBJ) $(SIMTOOLOBJ)/gainSweep.cpp.o
+	$(call check_lemlib_src)
+	$(call test_output_2,Linking gain sweep ,$(HOSTCXX) -pthread $^ $(HOOK_LDFLAGS) -o $@,$(OK_STRING))
+
+$(AUTOTUNE): $(SIMOBJ) $(SIMTOOLOBJ)/autoTune.cpp.o
+	$(call check_lemlib_src)
+	$(call test_output_2,Linking auto tuner ,$(HOSTCXX) -pthread $^ $(HOOK_LDFLAGS) -o $@,$(OK_STRING))
+
+$(SYSID): $(SIMOBJ) $(SIMTOOLOBJ)/sysId.cpp.o
+	$(call check_lemlib_src)
+	$(call test_output_2,Linking drivetrain characterization ,$(HOSTCXX) -pthread $^ $(HOOK_LDFLAGS) -o $@,$(OK_STRING))
+
+# only reads the JSON the benchmarks write, so it doesn't need the simulator or LemLib
+$(BENCHCHECK): $(SIMTOOLOBJ)/benchCheck.cpp.o
+	$(call test_output_2,Linking benchmark check ,$(HOSTCXX) $^ -o $@,$(OK_STRING))
+
+$(SIMOBJDIR)/%.cpp.o: $(ROOT)/%.cpp
+	$(VV)mkdir -p $(dir $@)
+	$(call test_output_2,Compiled $< for host ,$(HOSTCXX) -c $(SIMFLAGS) -o $@ $<,$(OK_STRING))
+
+$(SIMOBJDIR)/lemlib/%.cpp.o: $(LEMLIB_SRC)/src/lemlib/%.cpp
+	$(VV)mkdir -p $(dir $@)
+	$(call test_output_2,Compiled $< for host ,$(HOSTCXX) -c $(SIMFLAGS) -o $@ $<,$(OK_STRING))
+
 # these rules are for build-compile-commands, which just print out sysroot information
 cc-sysroot:
 	@echo | $(CC) -c -x c $(CFLAGS) $(EXTRA_CFLAGS) --verbose -o /dev/null -
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "lemlib/api.hpp" // IWYU pragma: keep
+#include "pros/rtos.hpp"
+
+/**
+ * @brief What a background calibration is doing
+ */
+enum class CalibrationStage { CHECKING_SENSORS, CALIBRATING_IMU, STARTING_ODOMETRY, DONE };
+
+/**
+ * @brief Progress of a background calibration, passed to its callback
+ */
+struct CalibrationProgress {
+        CalibrationStage stage = CalibrationStage::CHECKING_SENSORS;
+        // roughly how much of the calibration is done, from 0 to 1
+        float fraction = 0;
+        // a short line for the brain screen or the controller, at most 15 characters
+        const char* message = "";
+};
+
+struct CalibrationResult {
+        // whether every sensor was found and the IMU calibrated. Odometry runs either way
+        bool ok = false;
+        // why it isn't ok, if it isn't
+        const char* error = nullptr;
+        bool imuCalibrated = false;
+        // how many times the IMU was calibrated
+        int imuAttempts = 0;
+        // drive motors that aren't plugged in
+        int missingMotors = 0;
+        // how long the calibration took, in milliseconds
+        uint32_t time = 0;
+};
+
+struct CalibrationSettings {
+        // how many times the IMU is calibrated before odometry goes on without it, like Chassis::calibrate()
+        int imuAttempts = 3;
+        // how long one IMU calibration may take, in milliseconds. It usually takes about 2 seconds
+        uint32_t imuTimeout = 3000;
+        // called from the calibration task when the stage changes, and every progressInterval while the IMU
+        // calibrates. Keep it short, and don't wait for the calibration in it
+        std::function<void(const CalibrationProgress&)> onProgress = nullptr;
+        uint32_t progressInterval = 100;
+        // called from the calibration task once odometry runs
+        std::function<void(const CalibrationResult&)> onDone = nullptr;
+};
+
+/**
+ * @brief A calibration running in the background
+ *
+ * Copies refer to the same calibration. An empty handle, made by the default constructor, is always done and never
+ * ok.
+ */
+class CalibrationHandle {
+    public:
+        CalibrationHandle() = default;
+
+        /**
+         * @brief Whether the calibration has finished, and odometry runs
+         */
+        bool done() const;
+
+        /**
+         * @brief Wait for the calibration to finish
+         *
+         * @param timeout how long to wait at most, in milliseconds. Forever by default
+         * @return false it hasn't finished yet
+         */
+        bool wait(uint32_t timeout = TIMEOUT_MAX) const;
+
+        CalibrationStage stage() const;
+
+        /**
+         * @brief The result of the calibration
+         *
+         * @return a result that isn't ok, saying the calibration hasn't finished, until it has
+         */
+        CalibrationResult result() const;
+    private:
+        struct State {
+                std::atomic<CalibrationStage> stage = CalibrationStage::CHECKING_SENSORS;
+                // written once, before the stage is DONE
+                CalibrationResult result;
+        };
+
+        explicit CalibrationHandle(std::shared_ptr<State> state)
+            : state(std::move(state)) {}
+
+        std::shared_ptr<State> state;
+
+        friend CalibrationHandle calibrateAsync(lemlib::Chassis&, const lemlib::OdomSensors&,
+                                                const lemlib::Drivetrain&, const CalibrationSettings&);
+};
+
+/**
+ * @brief Calibrate the chassis on a background task, so initialize() can go on in the meantime
+ *
+ * Does what Chassis::calibrate() does, but returns straight away. The task starts calibrating the IMU, and while it
+ * does, checks that the IMU and every drive motor are plugged in and resets the tracking wheels. Once the IMU is
+ * ready it starts odometry with Chassis::calibrate(false). If the IMU fails to calibrate imuAttempts times, odometry
+ * starts without it, taking its heading from the tracking wheels or drive motors like Chassis::calibrate() would, and
+ * the result says why.
+ *
+ * Don't move the robot, or set its pose, until the calibration is done. Wait for it before autonomous.
+ *
+ * @param chassis the chassis
+ * @param sensors the sensors the chassis was created with
+ * @param drivetrain the drivetrain the chassis was created with
+ * @param settings the settings, and the callbacks
+ * @return CalibrationHandle to check on or wait for the calibration
+ *
+ * @b Example
+ * @code {.cpp}
+ * CalibrationHandle calibration;
+ *
+ * void initialize() {
+ *     pros::lcd::initialize();
+ *     calibration = calibrateAsync(chassis, sensors, drivetrain,
+ *                                  {.onProgress = [](const CalibrationProgress& progress) {
+ *                                      pros::lcd::print(4, "%s", progress.message);
+ *                                  }});
+ *     // runs while the IMU calibrates
+ *     armrotation.reset();
+ * }
+ *
+ * void autonomous() {
+ *     calibration.wait();
+ *     ...
+ * }
+ * @endcode
+ */
+CalibrationHandle calibrateAsync(lemlib::Chassis& chassis, const lemlib::OdomSensors& sensors,
+                                 const lemlib::Drivetrain& drivetrain, const CalibrationSettings& settings = {});
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include "lemlib/api.hpp" // IWYU pragma: keep
+
+/**
+ * @brief Finds gains for the chassis motion controllers with a relay feedback test
+ *
+ * The tuner drives the robot with Chassis::tank, switching between full relay power one way and the other every time
+ * the robot crosses the test target. That makes the robot oscillate around the target. The size and period of the
+ * oscillation give the ultimate gain and period of the drivetrain, and the PID gains follow from those with
+ * Ziegler-Nichols style rules.
+ *
+ * Everything goes through the chassis, so the same test runs on the robot and against the simulated robot in sim/.
+ * Each test moves the robot by about the relay amplitude either side of the target, so leave a few feet of clear
+ * field around it.
+ *
+ * @b Example
+ * @code {.cpp}
+ * AutoTuner tuner(chassis);
+ * const AutoTuner::Result angular = tuner.tune(AutoTuner::Controller::ANGULAR, angularController);
+ * if (angular.ok) logTuneResult(angular);
+ * @endcode
+ */
+class AutoTuner {
+    public:
+        enum class Controller { LATERAL, ANGULAR };
+
+        /**
+         * @brief How to turn the ultimate gain and period into gains
+         *
+         * CLASSIC is the original Ziegler-Nichols rule, and overshoots. PD leaves out the integral, like most LemLib
+         * tunes. NO_OVERSHOOT gives up speed for motions that stop on the target
+         */
+        enum class Rule { CLASSIC, PD, SOME_OVERSHOOT, NO_OVERSHOOT };
+
+        /**
+         * @brief The test the tuner runs
+         */
+        struct Experiment {
+                // power to drive the robot with, out of 127
+                int relayPower = 50;
+                // how far past the target the robot has to go before the relay switches, in inches or degrees. Raised
+                // to twice the sensor noise if that is larger
+                float hysteresis = 0.25;
+                // where the robot oscillates around, relative to where it starts, in inches forwards or degrees
+                // clockwise
+                float target = 0;
+                // oscillations to measure. The first two are left out, while the robot settles into the cycle
+                int cycles = 6;
+                // give up after this long, in milliseconds
+                int timeout = 15000;
+                Rule rule = Rule::PD;
+        };
+
+        /**
+         * @brief What a test found
+         */
+        struct Result {
+                bool ok = false;
+                // why the test failed, if it did
+                const char* error = nullptr;
+                // gain at which the drivetrain oscillates on its own, in power per inch or degree
+                float ultimateGain = 0;
+                // period of that oscillation, in milliseconds
+                float ultimatePeriod = 0;
+                // half of the oscillation from peak to peak, in inches or degrees
+                float amplitude = 0;
+                // peak to peak change in the measurement while the robot stood still, in inches or degrees
+                float noise = 0;
+                // smallest power that got the robot moving, out of 127
+                float breakawayPower = 0;
+                int measuredCycles = 0;
+                // the settings the test started from, with the gains and exit ranges replaced
+                lemlib::ControllerSettings settings {0, 0, 0, 0, 0, 0, 0, 0, 0};
+        };
+
+        /**
+         * @brief Create a new tuner
+         *
+         * @param chassis the chassis to tune. It must be calibrated, and shouldn't be running a motion
+         */
+        AutoTuner(lemlib::Chassis& chassis);
+
+        /**
+         * @brief Run a relay feedback test, and suggest settings for a controller
+         *
+         * Blocks until the test finishes. The drivetrain is stopped afterwards, and the chassis pose is left where
+         * odometry tracked the robot to.
+         *
+         * The suggested kI and kD are scaled to how LemLib's PID uses them, once per 10ms update, rather than per
+         * second. The small error range is what the robot can hold given the sensor noise and how much power it takes
+         * to move, and the large error range is three times that, like the ranges in main.cpp. The windup range and
+         * slew are kept from the settings passed in.
+         *
+         * @param controller LATERAL for the lateralPID, ANGULAR for the angularPID
+         * @param base the settings the controller uses now
+         * @param experiment the test to run
+         * @return Result what the test found. If ok is false, settings is the same as base
+         */
+        Result tune(Controller controller, const lemlib::ControllerSettings& base, const Experiment& experiment);
+        /**
+         * @brief Run the default test
+         */
+        Result tune(Controller controller, const lemlib::ControllerSettings& base);
+    private:
+        /**
+         * @brief The position being controlled, relative to where the test started
+         */
+        float measure(Controller controller) const;
+        void drive(Controller controller, int power);
+
+        lemlib::Chassis& chassis;
+        lemlib::Pose start {0, 0, 0};
+};
+
+/**
+ * @brief Log what a test found, with the settings in the form main.cpp creates them, to the LemLib info sink
+ */
+void logTuneResult(const AutoTuner::Result& result);
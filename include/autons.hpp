@@ -0,0 +1,42 @@
+#pragma once
+
+#include "lemlib/api.hpp" // IWYU pragma: keep
+#include "profiledChassis.hpp"
+
+extern ProfiledChassis chassis;
+
+// what the chassis was built from in main.cpp, for tools that build their own
+extern lemlib::Drivetrain drivetrain;
+extern lemlib::ControllerSettings linearController;
+extern lemlib::ControllerSettings angularController;
+extern lemlib::OdomSensors sensors;
+
+/**
+ * An autonomous routine, the name it shows up as, and where it starts
+ */
+struct AutonRoutine {
+    const char* name;
+    void (*run)();
+    // where the robot is put down for the routine, in the frame of FieldWalls, in inches and degrees. The routine
+    // itself starts at (0, 0, 0) there, see include/startPose.hpp
+    lemlib::Pose start;
+    // how long the routine has, in seconds. The autonomous period in a match, and the whole run in skills
+    double budget = 15;
+};
+
+extern const AutonRoutine autonRoutines[];
+
+extern const int autonRoutineCount;
+
+// index of the routine autonomous() runs
+extern int selectedAuton;
+
+void stakeLeft();
+
+void stakeRight();
+
+void goalRight();
+
+void goalLeft();
+
+void skills();
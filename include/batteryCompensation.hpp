@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include "pros/motor_group.hpp"
+#include "pros/motors.hpp"
+
+/**
+ * A motor command is a fraction of the battery, not a voltage: 127, or 12000 millivolts, switches the whole battery
+ * through to the motor. So the same motion pushes harder on a fresh battery at 12.8V than on a tired one at 11.9V,
+ * and routines tuned on one run long or overshoot on the other.
+ *
+ * Battery compensation filters the battery voltage on a background task, and scales the commands of the compensated
+ * motors by how far it is from a reference voltage, so a command of 12000 millivolts puts the reference voltage on
+ * the motor whatever the battery is at. Build the drivetrain out of CompensatedMotorGroups, and every controller that
+ * drives it gets it: LemLib's motions, driver control and the project's own.
+ *
+ * Build the project with BATTERY_COMP=1. Without it, startBatteryCompensation() does nothing, and the compensated
+ * motors act like plain ones.
+ */
+
+struct BatteryCompensationSettings {
+        // the battery voltage commands are scaled to act like, in volts. Above it, commands are scaled down. Below it,
+        // they are scaled up, except for those that would need more than the battery has, which run at full power
+        float referenceVoltage = 12;
+        // how quickly the filter follows the battery, in milliseconds. Slow enough that the sag of the robot
+        // accelerating doesn't feed back into the commands that caused it
+        uint32_t timeConstant = 500;
+        // readings are taken to be at least this, in volts, so a brownout doesn't scale commands up further
+        float minVoltage = 10;
+};
+
+/**
+ * @brief Start filtering the battery voltage, and scaling every motor command by it
+ *
+ * Call it once, from initialize(). Calling it again changes the settings. Until the first reading, commands are
+ * left alone.
+ *
+ * @param settings the settings
+ * @return false the project was built without BATTERY_COMP
+ *
+ * @b Example
+ * @code {.cpp}
+ * void initialize() {
+ *     startBatteryCompensation({.referenceVoltage = 12});
+ * }
+ * @endcode
+ */
+bool startBatteryCompensation(const BatteryCompensationSettings& settings = {});
+
+/**
+ * @brief The filtered battery voltage, in volts. 0 before compensation starts
+ */
+float batteryVoltage();
+
+/**
+ * @brief How much motor commands are scaled by. 1 before compensation starts
+ */
+float batteryCompensation();
+
+/**
+ * @brief Scale a motor command by the battery compensation
+ *
+ * Called by the compensated motors for every move() and move_voltage().
+ *
+ * @param millivolts the command, from -12000 to 12000
+ * @return int32_t the scaled command, clamped to the same range
+ */
+int32_t compensateVoltage(int32_t millivolts);
+
+/**
+ * @brief A motor group whose move() and move_voltage() are battery compensated
+ *
+ * LemLib drives the motor groups of the drivetrain through virtual calls, so pass these to lemlib::Drivetrain in
+ * place of pros::MotorGroups. move() is sent as a voltage, so the scaled command isn't rounded to one of 255 steps.
+ * move_velocity() and the position moves are closed loop in the motor, and are left alone.
+ */
+class CompensatedMotorGroup : public pros::MotorGroup {
+    public:
+        using pros::MotorGroup::MotorGroup;
+        std::int32_t move(std::int32_t voltage) const override;
+        std::int32_t move_voltage(std::int32_t voltage) const override;
+};
+
+/**
+ * @brief A motor whose move() and move_voltage() are battery compensated, like CompensatedMotorGroup
+ */
+class CompensatedMotor : public pros::Motor {
+    public:
+        using pros::Motor::Motor;
+        std::int32_t move(std::int32_t voltage) const override;
+        std::int32_t move_voltage(std::int32_t voltage) const override;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "feedforward.hpp"
+#include "lemlib/api.hpp" // IWYU pragma: keep
+
+/**
+ * @brief The patterns characterizeDrivetrain() drives
+ *
+ * Each pattern is driven forwards and then backwards, so the robot ends up roughly where it started. Straight tests
+ * stop after maxDistance, so leave that much room in front of and behind the robot.
+ */
+struct CharacterizationTest {
+        // how fast the quasistatic ramps raise the voltage, in volts per second. Slow enough that acceleration is
+        // negligible, so these fit kS and kV
+        float rampRate = 0.5;
+        // highest voltage of the ramps, in volts
+        float rampVoltage = 6;
+        // voltage of the step tests, which fit kA, in volts
+        float stepVoltage = 6;
+        // how long each step lasts at most, in milliseconds
+        int stepTime = 1500;
+        // furthest a straight test may drive, in inches
+        float maxDistance = 36;
+        // furthest a turning test may turn, in degrees
+        float maxAngle = 720;
+        // samples slower than this are left out of the fit, since static friction doesn't follow the model. In inches
+        // per second for straight tests, and degrees per second for turns
+        float minLinearVelocity = 1;
+        float minAngularVelocity = 5;
+};
+
+/**
+ * @brief How well the model fits one kind of motion
+ */
+struct CharacterizationFit {
+        Feedforward gains;
+        // coefficient of determination of the fit. 1 is perfect
+        float rSquared = 0;
+        int samples = 0;
+};
+
+struct CharacterizationResult {
+        bool ok = false;
+        // why the characterization failed, if it did
+        const char* error = nullptr;
+        CharacterizationFit linear;
+        CharacterizationFit angular;
+        // the gains of both fits, ready to use
+        DriveCharacterization model;
+};
+
+/**
+ * @brief Measure kS, kV and kA of a drivetrain for driving straight and turning in place
+ *
+ * Drives quasistatic voltage ramps and voltage steps on the left and right motor groups, reads how the robot moves
+ * from the chassis pose, and fits the Feedforward model to every sample with least squares. Blocks until every test
+ * has run, about half a minute with the default test. The motors are left stopped, in whatever brake mode they were
+ * in.
+ *
+ * @param chassis the chassis, calibrated and not running a motion. Only its pose is used
+ * @param drivetrain the drivetrain the chassis was created with
+ * @param test the patterns to drive
+ * @return CharacterizationResult the fitted model
+ *
+ * @b Example
+ * @code {.cpp}
+ * const CharacterizationResult result = characterizeDrivetrain(chassis, drivetrain);
+ * logCharacterization(result);
+ * @endcode
+ */
+CharacterizationResult characterizeDrivetrain(lemlib::Chassis& chassis, const lemlib::Drivetrain& drivetrain,
+                                              const CharacterizationTest& test = {});
+
+/**
+ * @brief Log a characterization, with the model in the form main.cpp can create it, to the LemLib info sink
+ */
+void logCharacterization(const CharacterizationResult& result);
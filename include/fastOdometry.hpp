@@ -0,0 +1,130 @@
+#pragma once
+
+#include "lemlib/api.hpp" // IWYU pragma: keep
+#include "sensorSnapshot.hpp"
+
+/**
+ * @brief Sine and cosine of an angle
+ */
+struct SinCos {
+        float sin;
+        float cos;
+};
+
+// largest error of fastSinCos() against the double precision functions, over the range it is accurate for
+constexpr float FAST_SIN_COS_MAX_ERROR = 2e-7;
+
+/**
+ * @brief Sine and cosine of an angle, in one call and without the C library
+ *
+ * Reduces the angle to [-pi/4, pi/4] and evaluates short polynomials there. Accurate to FAST_SIN_COS_MAX_ERROR for
+ * angles up to about 10000 radians, which is far more than odometry ever turns.
+ *
+ * @param angle the angle, in radians
+ */
+SinCos fastSinCos(float angle);
+
+/**
+ * @brief Odometry that calculates the same pose as lemlib::update() with far less trig
+ *
+ * Reads the same sensors and picks them the same way as LemLib, through a SnapshotReader, and moves the robot along
+ * the same arc each update.
+ * Instead of dividing by the change in heading, it uses 2 * sin(h) / (2 * h) expanded as a series for small turns, so
+ * there is no special case at 0. It keeps the sine and cosine of the heading from the last update and rotates them
+ * by half the turn, twice, so an update makes no full range trig calls at all. The cached values are worked out
+ * again from the heading every RESYNC_INTERVAL updates, and after large turns, so their errors can't build up.
+ */
+class FastOdometry {
+    public:
+        /**
+         * @brief Create the odometry, starting at 0, 0, 0
+         *
+         * @param sensors the sensors the chassis was created with. Missing vertical wheels are made out of the
+         * drivetrain, like LemLib does
+         * @param drivetrain the drivetrain the chassis was created with
+         */
+        FastOdometry(const lemlib::OdomSensors& sensors, const lemlib::Drivetrain& drivetrain);
+
+        /**
+         * @brief Read the sensors and move the pose by how far they say the robot moved since the last update
+         */
+        void update();
+
+        /**
+         * @brief Move the pose by how far a snapshot says the robot moved since the last update
+         */
+        void update(const OdometrySnapshot& snapshot);
+
+        /**
+         * @brief Set the pose, and start measuring from the sensors' current readings
+         *
+         * @param pose the pose, in radians
+         */
+        void setPose(const lemlib::Pose& pose);
+
+        /**
+         * @brief Take the heading from a GyroBiasEstimator instead of the chassis IMU, from the next update
+         *
+         * Only changes the heading when it comes from the IMU, see useGyroBias().
+         *
+         * @param estimator the estimator, or nullptr for the chassis IMU
+         */
+        void setGyroBias(GyroBiasEstimator* estimator);
+
+        /**
+         * @brief The pose, in radians
+         */
+        lemlib::Pose getPose() const;
+
+        /**
+         * @brief The readings of the last update
+         */
+        const OdometrySnapshot& lastSnapshot() const { return previous; }
+
+        // how many updates the cached heading trig is kept before it is worked out again
+        static constexpr int RESYNC_INTERVAL = 64;
+    private:
+        enum class HeadingSource { HORIZONTAL_WHEELS, VERTICAL_WHEELS, IMU, DRIVETRAIN };
+
+        void resync();
+
+        SnapshotReader reader;
+        HeadingSource headingSource;
+        // the wheels that measure how far the robot moves forwards and sideways, as slots of the snapshot
+        int vertical;
+        int horizontal;
+        float verticalOffset;
+        float horizontalOffset;
+        // 1 over the distance between the two wheels heading is measured with
+        float inverseSpan = 0;
+
+        OdometrySnapshot previous;
+        float x = 0;
+        float y = 0;
+        float theta = 0;
+        float sinTheta = 0;
+        float cosTheta = 1;
+        int sinceResync = 0;
+};
+
+/**
+ * @brief Switch the odometry task to FastOdometry, from the current pose
+ *
+ * Only does anything when the project is built with ODOM_TASK=1, see include/odomTask.hpp. The sensors of the first
+ * call are kept; later calls only switch back.
+ *
+ * @param sensors the sensors the chassis was created with
+ * @param drivetrain the drivetrain the chassis was created with
+ * @return false the project was built without ODOM_TASK
+ */
+bool useFastOdometry(const lemlib::OdomSensors& sensors, const lemlib::Drivetrain& drivetrain);
+
+/**
+ * @brief Switch the odometry task back to lemlib::update(), from the current pose
+ */
+void useLemLibOdometry();
+
+/**
+ * @brief The FastOdometry the odometry task should use, or nullptr for lemlib::update()
+ */
+FastOdometry* selectedFastOdometry();
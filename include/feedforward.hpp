@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cmath>
+
+/**
+ * @brief Voltage a drivetrain needs to hold a velocity and acceleration
+ *
+ * The usual DC motor model of a drivetrain: voltage = kS * sign(velocity) + kV * velocity + kA * acceleration. kS
+ * overcomes friction, kV the back EMF of the motors and kA the inertia of the robot.
+ */
+struct Feedforward {
+        // volts
+        float kS = 0;
+        // volts per unit of velocity
+        float kV = 0;
+        // volts per unit of acceleration
+        float kA = 0;
+
+        /**
+         * @brief The voltage to apply
+         *
+         * @param velocity the velocity to hold
+         * @param acceleration the acceleration to reach it with
+         * @return float voltage in volts
+         */
+        float voltage(float velocity, float acceleration = 0) const {
+            const float sign = (velocity > 0) - (velocity < 0);
+            return kS * sign + kV * velocity + kA * acceleration;
+        }
+
+        /**
+         * @brief The highest velocity a voltage can hold
+         *
+         * @param voltage the voltage available, in volts
+         */
+        float maxVelocity(float voltage) const { return kV > 0 ? std::fmax(0.0f, voltage - kS) / kV : 0; }
+};
+
+/**
+ * @brief Measured plant model of a differential drivetrain
+ *
+ * Linear gains are per inch per second (squared) of the robot driving straight, angular gains per degree per second
+ * (squared) of the robot turning in place, with both sides driven at the voltage. Measure them with
+ * characterizeDrivetrain() in driveCharacterization.hpp, or the sys-id host tool for the simulated robot.
+ */
+struct DriveCharacterization {
+        Feedforward linear;
+        Feedforward angular;
+};
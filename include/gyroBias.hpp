@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "pros/imu.hpp"
+#include "pros/motor_group.hpp"
+
+/**
+ * @brief Settings for a GyroBiasEstimator
+ */
+struct GyroBiasSettings {
+        // a motor slower than this counts as stopped, in rpm
+        float stoppedVelocity = 2;
+        // how long every motor has to be stopped before the robot counts as stationary, in milliseconds. Gives the
+        // robot time to stop sliding
+        uint32_t settleTime = 250;
+        // the bias is the average drift of at most this many seconds of stationary readings, so it can follow changes
+        // in temperature
+        float biasMemory = 30;
+        // the largest bias believed, in degrees per second
+        float maxBias = 0.5;
+        // an IMU this far from the median of all of them is left out, in degrees. Needs 3 IMUs or more
+        float outlierThreshold = 3;
+        // whether the heading is kept still while the robot is stationary, instead of only correcting it by the bias
+        bool holdWhenStationary = true;
+};
+
+/**
+ * @brief Heading from one or more IMUs, corrected for gyro drift that is measured whenever the robot stands still
+ *
+ * Whenever every drivetrain motor has been stopped for a moment, the robot can't be turning, so whatever rotation
+ * the IMUs report is drift. The estimator averages that drift into a bias for each IMU, takes it away from their
+ * readings while the robot moves, and keeps the heading still while it doesn't. With several IMUs each is corrected
+ * on its own, those further than outlierThreshold from the median are voted out, and the heading turns by the average
+ * of the rest. An IMU that was voted out, or stops reading, is lined up with the heading again once the robot is
+ * stationary.
+ *
+ * The robot being pushed while its wheels don't turn looks like drift, so keep settleTime long enough to ride out a
+ * collision.
+ */
+class GyroBiasEstimator {
+    public:
+        /**
+         * @param imus the IMUs, calibrated before the first update. Chassis::calibrate() only calibrates the one in
+         * the chassis sensors
+         * @param motors the motors that move the robot, which tell whether it is stationary
+         * @param settings the settings
+         */
+        GyroBiasEstimator(std::vector<pros::Imu*> imus, std::vector<pros::MotorGroup*> motors,
+                          const GyroBiasSettings& settings = {});
+
+        /**
+         * @brief Read the IMUs and motors, and update the heading
+         *
+         * Not thread safe. Only one task should update an estimator.
+         *
+         * @param timeMicros when the readings are taken, from pros::micros()
+         * @return the corrected rotation, in degrees, which starts at the average IMU rotation. NAN if no IMU has
+         * read yet
+         */
+        double update(uint32_t timeMicros);
+
+        /**
+         * @brief The rotation of the last update, in degrees
+         */
+        float rotation() const { return lastRotation.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief The average bias of the IMUs used in the last update, in degrees per second
+         */
+        float bias() const { return lastBias.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Whether the robot was stationary in the last update
+         */
+        bool stationary() const { return wasStationary.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief How many IMUs the last update used
+         */
+        int imusUsed() const { return lastUsed.load(std::memory_order_relaxed); }
+    private:
+        struct Gyro {
+                pros::Imu* imu;
+                // the last reading, or NAN when the IMU has to be lined up with the heading again
+                double last = NAN;
+                // the corrected rotation
+                double heading = 0;
+                // how much the corrected rotation turned this update
+                double step = 0;
+                // in degrees per second
+                double bias = 0;
+                // how many seconds of stationary readings the bias is the average of
+                float biasWeight = 0;
+                bool reading = false;
+                bool used = false;
+        };
+
+        bool motorsStopped() const;
+
+        std::vector<Gyro> gyros;
+        std::vector<pros::MotorGroup*> motors;
+        GyroBiasSettings settings;
+        // the headings being voted on, kept between updates so they don't allocate
+        std::vector<double> votes;
+        bool started = false;
+        uint32_t lastTime = 0;
+        // when the motors were last seen moving, in microseconds
+        uint32_t movedTime = 0;
+        double heading = NAN;
+
+        std::atomic<float> lastRotation = NAN;
+        std::atomic<float> lastBias = 0;
+        std::atomic<bool> wasStationary = false;
+        std::atomic<int> lastUsed = 0;
+};
+
+/**
+ * @brief An inertial sensor that reads as the heading of the selected GyroBiasEstimator
+ *
+ * lemlib::update() reads the IMU through a virtual call, so pass one of these to lemlib::OdomSensors for its heading
+ * to be corrected too. Only reads by the odometry task are corrected, since only it may update the estimator; every
+ * other task gets the sensor's own rotation. Switching the estimator on or off carries on from the last rotation
+ * returned, so the heading doesn't jump.
+ */
+class GyroBiasImu : public pros::Imu {
+    public:
+        using pros::Imu::Imu;
+        double get_rotation() const override;
+    private:
+        // only touched by the odometry task
+        mutable GyroBiasEstimator* source = nullptr;
+        mutable double offset = 0;
+        mutable double last = NAN;
+};
+
+/**
+ * @brief Correct the odometry heading with a GyroBiasEstimator
+ *
+ * Only does anything when the project is built with ODOM_TASK=1, see include/odomTask.hpp. FastOdometry, see
+ * include/fastOdometry.hpp, reads the estimator itself. lemlib::update() reads the chassis IMU, so it is only corrected
+ * when that is a GyroBiasImu. The estimator stands in for the chassis IMU, so it only steers odometry that already
+ * takes its heading from an IMU. The IMUs and motors of the first call are kept; later calls only switch back.
+ *
+ * @param imus the IMUs, calibrated. Usually the chassis IMU and any others on the robot
+ * @param motors the drivetrain motors
+ * @param settings the settings
+ * @return false the project was built without ODOM_TASK
+ */
+bool useGyroBias(std::vector<pros::Imu*> imus, std::vector<pros::MotorGroup*> motors,
+                 const GyroBiasSettings& settings = {});
+
+/**
+ * @brief Go back to the plain chassis IMU
+ */
+void stopGyroBias();
+
+/**
+ * @brief The GyroBiasEstimator odometry should use, or nullptr for the chassis IMU
+ */
+GyroBiasEstimator* selectedGyroBias();
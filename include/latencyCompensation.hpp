@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include "lemlib/api.hpp" // IWYU pragma: keep
+
+/**
+ * Controllers act on a pose that is already old: a sensor reports a new reading every few milliseconds, so the
+ * reading odometry gets is on average half of that old, and a voltage the controller sets takes a while to reach the
+ * motor and move the robot. At 60 inches per second, 15ms of both is almost an inch, which motions overshoot by.
+ *
+ * measureLatency() measures both on the robot, and setLatencyCompensation() has every motion steer by where the robot
+ * will be by the time a command sent now takes effect, extrapolated from the filtered velocity and acceleration of
+ * include/motionEstimator.hpp. lemlib::getPose() returns the prediction to a task while it runs a motion, see
+ * include/motionTasks.hpp, so LemLib's own motions and the profiled motions of include/profiledChassis.hpp both see
+ * ahead. Every other task keeps getting the measured pose, so code that reads the pose and sets it again between
+ * motions, like relocalize(), never writes a prediction back into odometry. getCompensatedPose() returns the
+ * prediction to any task.
+ *
+ * Compensation needs the odometry task of include/odomTask.hpp, so build the project with ODOM_TASK=1.
+ */
+
+/**
+ * @brief The steps measureLatency() drives
+ *
+ * Steps go forwards, backwards, clockwise and counterclockwise in turn, so every sensor moves, and the robot ends up
+ * roughly where it started. Leave a foot or so of room in front of and behind it.
+ */
+struct LatencyTest {
+        // voltage of each step, in volts
+        float stepVoltage = 4;
+        // how long each step drives, in milliseconds. Long enough for every sensor to report a few times
+        uint32_t stepTime = 300;
+        int steps = 8;
+        // a step that hasn't moved the robot after this long fails the measurement, in milliseconds
+        uint32_t timeout = 200;
+};
+
+struct LatencyMeasurement {
+        bool ok = false;
+        // why the measurement failed, if it did
+        const char* error = nullptr;
+        // how long after a voltage is set the robot starts to move, in milliseconds, the median of the steps
+        float actuatorLatency = 0;
+        // how old a sensor reading is on average when odometry reads it, in milliseconds. Half the interval of the
+        // slowest odometry sensor
+        float sensorLatency = 0;
+        // how often the slowest odometry sensor reports a new reading, in milliseconds
+        float sensorInterval = 0;
+        // how far ahead controllers should see, in milliseconds
+        float total = 0;
+};
+
+/**
+ * @brief Measure how long the drivetrain takes to respond, and how old the odometry sensors are
+ *
+ * Drives short voltage steps on the drivetrain and reads every odometry sensor as fast as it can: the time from
+ * setting the voltage to the first reading that moves, less the time the reading sat in the sensor, is the actuator
+ * latency, and how often each sensor's reading changes while the robot moves is how old its readings are.
+ * The wheels are held still between steps. Blocks until every step has run, about ten seconds with the default test.
+ * The motors are left braked, in whatever brake mode they were in.
+ *
+ * @param sensors the sensors the chassis was created with
+ * @param drivetrain the drivetrain the chassis was created with. No motion may be running on it
+ * @param test the steps to drive
+ * @return LatencyMeasurement the latencies
+ *
+ * @b Example
+ * @code {.cpp}
+ * const LatencyMeasurement latency = measureLatency(sensors, drivetrain);
+ * logLatency(latency);
+ * if (latency.ok) setLatencyCompensation(latency.total);
+ * @endcode
+ */
+LatencyMeasurement measureLatency(const lemlib::OdomSensors& sensors, const lemlib::Drivetrain& drivetrain,
+                                  const LatencyTest& test = {});
+
+/**
+ * @brief Log a latency measurement to the LemLib info sink
+ */
+void logLatency(const LatencyMeasurement& measurement);
+
+/**
+ * @brief Have motions and getCompensatedPose() see where the robot will be, rather than where it was
+ *
+ * @param milliseconds how far ahead to predict, from 0, which turns compensation off, to 50. Usually the total of a
+ * LatencyMeasurement
+ * @return false the project was built without ODOM_TASK
+ */
+bool setLatencyCompensation(float milliseconds);
+
+/**
+ * @brief How far ahead motions and getCompensatedPose() predict, in milliseconds. 0 while compensation is off
+ */
+float latencyCompensation();
+
+/**
+ * @brief Where the robot will be by the time a command sent now takes effect
+ *
+ * The measured pose, moved ahead by the latency compensation, which is what lemlib::getPose() returns to a motion.
+ * Never waits for the odometry task. Only for steering by: setting the pose to it would move odometry ahead by the
+ * compensation every time.
+ *
+ * @param radians true for theta in radians, false for degrees. False by default
+ * @return lemlib::Pose the predicted pose. The measured pose while compensation is off, or without a recent motion
+ * estimate
+ */
+lemlib::Pose getCompensatedPose(bool radians = false);
+
+/**
+ * @brief Move a measured pose ahead by the latency compensation
+ *
+ * Called by the lemlib::getPose() hook of the odometry task for tasks running a motion.
+ *
+ * @param pose the measured pose, in radians
+ * @return lemlib::Pose the predicted pose, in radians. pose while compensation is off, or without a recent motion
+ * estimate
+ */
+lemlib::Pose compensatePose(const lemlib::Pose& pose);
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Counts of loop iterations, in fixed width bins
+ *
+ * Each bin is a separate atomic, so the loop being measured never takes a lock and a reader on another task can read
+ * the histogram while it is being filled in. A reader can see a sample in one histogram and not yet in another.
+ */
+struct LoopHistogram {
+        // width of each bin, in microseconds
+        static constexpr uint32_t BIN_WIDTH = 500;
+        // the last bin counts everything longer than the others can hold
+        static constexpr uint32_t BINS = 64;
+
+        std::atomic<uint32_t> counts[BINS] = {};
+
+        /**
+         * @brief Count a sample
+         *
+         * @param micros the sample, in microseconds
+         */
+        void record(uint32_t micros);
+        /**
+         * @brief Estimate a percentile
+         *
+         * @param fraction the percentile, from 0 to 1
+         * @return uint32_t the upper edge of the bin the percentile falls in, in microseconds. 0 if nothing was counted
+         */
+        uint32_t percentile(float fraction) const;
+        uint32_t total() const;
+        void reset();
+};
+
+/**
+ * @brief How regularly a loop ran
+ *
+ * An iteration starts when the loop wakes from its delay, and ends when it wakes from the next one. The LemLib loops
+ * are only timed when the project is built with LOOP_TIMING=1, otherwise their stats stay empty.
+ */
+struct LoopStats {
+        // time between the start of one iteration and the start of the next
+        LoopHistogram period;
+        // time each iteration spent running before it called delay
+        LoopHistogram work;
+        // how late the loop woke up, after the delay it asked for
+        LoopHistogram jitter;
+        std::atomic<uint32_t> iterations = 0;
+        // iterations that took longer than the delay they asked for, plus DEADLINE_SLACK
+        std::atomic<uint32_t> missedDeadlines = 0;
+        std::atomic<uint32_t> maxPeriod = 0;
+        std::atomic<uint32_t> maxJitter = 0;
+
+        // how much longer than its delay an iteration may run before it counts as a missed deadline, in microseconds
+        static constexpr uint32_t DEADLINE_SLACK = 2000;
+
+        /**
+         * @brief Add the samples of another loop to these
+         */
+        void add(const LoopStats& other);
+        void reset();
+};
+
+/**
+ * @brief Timing of the odometry task, since the program started or resetLoopTiming() was called
+ */
+const LoopStats& odometryTiming();
+
+/**
+ * @brief Timing of the motion that is running, or of the last motion to finish if none is
+ *
+ * Every Chassis motion resets this when it starts, so read it after waitUntilDone() to get the timing of one motion.
+ *
+ * @b Example
+ * @code {.cpp}
+ * chassis.moveToPoint(0, 24, 2000);
+ * chassis.waitUntilDone();
+ * logLoopTiming("moveToPoint", motionTiming());
+ * @endcode
+ */
+const LoopStats& motionTiming();
+
+/**
+ * @brief Timing of every motion that has finished, since the program started or resetLoopTiming() was called
+ */
+const LoopStats& allMotionTiming();
+
+/**
+ * @brief Clear the timing of every loop
+ */
+void resetLoopTiming();
+
+/**
+ * @brief Log a summary of the timing of a loop to the LemLib info sink
+ *
+ * @param name what to call the loop in the log
+ * @param stats the timing of the loop
+ */
+void logLoopTiming(const char* name, const LoopStats& stats);
+
+/**
+ * @brief Start timing the motion the calling task just started. Called by the LemLib hooks in motionTasks.cpp
+ */
+void startMotionTiming();
+
+/**
+ * @brief Stop timing the motion the calling task is ending. Called by the LemLib hooks in motionTasks.cpp
+ */
+void endMotionTiming();
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include "lemlib/pose.hpp"
+
+/**
+ * Velocity and acceleration of the robot, filtered out of the odometry pose, for feedforward, derivative terms and
+ * predicting where the robot will be.
+ *
+ * lemlib::getSpeed() and getLocalSpeed() are the difference between the last two poses, so encoder ticks and sensor
+ * readings that land a little early or late come through as spikes in the speed, and much worse in anything derived
+ * from it. Instead, the odometry task of include/odomTask.hpp runs each of x, y and theta through a critically damped
+ * alpha-beta-gamma filter after every update: the filter predicts the pose from its velocity and acceleration, and
+ * corrects all three by a fraction of how far the pose it is given is off. The fractions follow from a time constant
+ * and the time between updates, so the smoothing doesn't change with the odometry period, and the filter follows a
+ * constant acceleration without lagging behind it.
+ *
+ * Needs ODOM_TASK=1. The pose history of include/poseHistory.hpp records the filtered velocity. Setting the pose moves
+ * the filter to it without stopping it, since the robot keeps moving.
+ */
+
+/**
+ * @brief Settings for the motion estimator
+ */
+struct MotionEstimatorSettings {
+        // roughly how long the filtered speeds take to catch up with a change, in milliseconds. Longer is smoother
+        float linearTimeConstant = 30;
+        float angularTimeConstant = 30;
+        // how long the noise estimates average over, in milliseconds
+        float noiseMemory = 250;
+        // after a gap between updates longer than this, in milliseconds, the filter starts again from rest
+        uint32_t maxGap = 100;
+};
+
+/**
+ * @brief How the robot is moving
+ *
+ * Local values are in the frame of the robot: x to its right, y forwards, and theta clockwise, like the pose.
+ */
+struct MotionEstimate {
+        // when the pose the estimate is from was read, in milliseconds, on the clock of pros::millis()
+        uint32_t time = 0;
+        // the pose odometry published, in inches and the units of theta
+        lemlib::Pose pose = {0, 0, 0};
+        // in inches and the units of theta, per second and per second squared
+        lemlib::Pose velocity = {0, 0, 0};
+        lemlib::Pose acceleration = {0, 0, 0};
+        lemlib::Pose localVelocity = {0, 0, 0};
+        lemlib::Pose localAcceleration = {0, 0, 0};
+        // roughly how much the velocity and acceleration jitter from one update to the next, as standard deviations
+        // in the same units. Differences smaller than this are noise
+        lemlib::Pose velocityNoise = {0, 0, 0};
+        lemlib::Pose accelerationNoise = {0, 0, 0};
+};
+
+/**
+ * @brief Change the settings of the motion estimator
+ *
+ * Takes effect from the next update.
+ *
+ * @param settings the settings
+ */
+void setMotionEstimatorSettings(const MotionEstimatorSettings& settings);
+
+/**
+ * @brief The last motion estimate
+ *
+ * Never waits for the odometry task, like lemlib::getPose().
+ *
+ * @param estimate where to put it
+ * @param radians true for theta in radians, false for degrees. False by default
+ * @return false the project was built without ODOM_TASK, or odometry hasn't updated twice yet. estimate is then left
+ * alone
+ */
+bool getMotionEstimate(MotionEstimate& estimate, bool radians = false);
+
+/**
+ * @brief The filtered velocity of the robot
+ *
+ * @param local true for the frame of the robot, false for the field. False by default
+ * @param radians true for theta in radians, false for degrees. False by default
+ * @return lemlib::Pose the velocity, or no velocity without an estimate
+ */
+lemlib::Pose getVelocity(bool local = false, bool radians = false);
+
+/**
+ * @brief The filtered acceleration of the robot
+ *
+ * @param local true for the frame of the robot, false for the field. False by default
+ * @param radians true for theta in radians, false for degrees. False by default
+ * @return lemlib::Pose the acceleration, or no acceleration without an estimate
+ */
+lemlib::Pose getAcceleration(bool local = false, bool radians = false);
+
+/**
+ * @brief Where the robot will be, if it keeps accelerating like it is now
+ *
+ * Like lemlib::estimatePose(), but from the filtered velocity and acceleration. The time since the sensors were last
+ * read is added on, so the prediction is from now. Without an estimate, this is lemlib::getPose().
+ *
+ * @param time how far ahead of now, in seconds
+ * @param radians true for theta in radians, false for degrees. False by default
+ *
+ * @b Example
+ * @code {.cpp}
+ * // the intake takes 80ms to react, so aim it where the robot will be by then
+ * const lemlib::Pose ahead = predictPose(0.08);
+ * @endcode
+ */
+lemlib::Pose predictPose(float time, bool radians = false);
+
+/**
+ * @brief Run the filter once
+ *
+ * Called by the odometry task after every update, with the pose it published.
+ *
+ * @param time when the sensors were read, in microseconds
+ * @param pose the pose, in radians
+ * @return lemlib::Pose the filtered velocity, in the field frame, in inches and radians per second
+ */
+lemlib::Pose updateMotionEstimate(uint32_t time, const lemlib::Pose& pose);
+
+/**
+ * @brief Move the filter to a pose, keeping its velocity and acceleration
+ *
+ * Called by the odometry task when the pose is set.
+ *
+ * @param pose the pose, in radians
+ */
+void moveMotionEstimate(const lemlib::Pose& pose);
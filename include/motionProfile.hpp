@@ -0,0 +1,75 @@
+#pragma once
+
+/**
+ * @brief How fast a profile may go, in inches per second, squared and cubed
+ */
+struct ProfileConstraints {
+        float maxVelocity = 0;
+        float maxAcceleration = 0;
+        // 0 for a trapezoidal profile, which switches between accelerating and cruising at once
+        float maxJerk = 0;
+};
+
+/**
+ * @brief Where a profile is at some time
+ */
+struct ProfileState {
+        float position = 0;
+        float velocity = 0;
+        float acceleration = 0;
+};
+
+/**
+ * @brief A time-optimal, jerk-limited velocity profile along a path
+ *
+ * The profile ramps up from the start velocity to a peak, cruises, and ramps down to the end velocity, each ramp an
+ * S-curve that builds up its acceleration at the jerk limit, holds it, and lets it off again. The peak is the highest
+ * velocity that still leaves room to ramp down within the distance, found by bisection. A robot already moving too
+ * fast to ramp down within the distance gets a profile that ends past it.
+ *
+ * @b Example
+ * @code {.cpp}
+ * const MotionProfile profile(48, {60, 120, 1200});
+ * const ProfileState state = profile.sample(0.5); // half a second in
+ * @endcode
+ */
+class MotionProfile {
+    public:
+        MotionProfile() = default;
+        /**
+         * @brief Plan a profile
+         *
+         * @param distance how far to go, in inches. Negative to go backwards
+         * @param constraints the limits
+         * @param startVelocity how fast the robot already goes in the direction of the distance, in inches per second
+         * @param endVelocity how fast to arrive, in inches per second
+         */
+        MotionProfile(float distance, const ProfileConstraints& constraints, float startVelocity = 0,
+                      float endVelocity = 0);
+
+        /**
+         * @brief Where the profile is some time after it starts
+         *
+         * @param time in seconds. Past the end, the profile stays where it ends
+         */
+        ProfileState sample(float time) const;
+
+        /**
+         * @brief How long the profile takes, in seconds
+         */
+        float duration() const { return startTimes[PHASES]; }
+
+        /**
+         * @brief Where the profile ends, in inches. The distance it was planned for, unless it had to overshoot
+         */
+        float end() const { return sign * starts[PHASES].position; }
+    private:
+        // ramp up, cruise and ramp down, each ramp three phases of constant jerk
+        static constexpr int PHASES = 7;
+
+        float sign = 1;
+        float jerks[PHASES] = {};
+        // the state and time each phase starts at, and after the last, where the profile ends
+        ProfileState starts[PHASES + 1];
+        float startTimes[PHASES + 1] = {};
+};
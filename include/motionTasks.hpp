@@ -0,0 +1,32 @@
+#pragma once
+
+#include "lemlib/api.hpp" // IWYU pragma: keep
+
+/**
+ * Keeps track of which tasks are running a LemLib motion, for the loop timing of include/loopTiming.hpp and the
+ * latency compensation of include/latencyCompensation.hpp.
+ *
+ * A motion runs from Chassis::requestMotionStart() to Chassis::endMotion(), in the task that called it, or in a task
+ * of its own when it is async. When the project is built with LOOP_TIMING=1 or ODOM_TASK=1, LemLib is linked with
+ * hooks on both (see MOTION_WRAP in common.mk). A function can only be wrapped once, so these hooks are the one place
+ * every feature hears about motions from.
+ */
+#if defined(LOOP_TIMING) || defined(ODOM_TASK)
+#define MOTION_HOOKS
+#endif
+
+/**
+ * @brief Whether the calling task is running a LemLib motion
+ *
+ * @return false the project was built without LOOP_TIMING or ODOM_TASK
+ */
+bool inMotionTask();
+
+/**
+ * @brief Hear about every motion that starts and ends, for a tool that would otherwise wrap them itself
+ *
+ * Only called with MOTION_HOOKS. started is called each time Chassis::requestMotionStart() returns, including for a
+ * motion that was cancelled while it waited. ended is called as a task ends its motion, once it no longer counts as
+ * in one.
+ */
+void setMotionListener(void (*started)(lemlib::Chassis* chassis), void (*ended)(lemlib::Chassis* chassis));
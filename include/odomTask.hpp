@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Runs LemLib odometry in its own high priority task, at a fixed rate of its own, instead of LemLib's 10ms tracking
+ * task.
+ *
+ * Only active when the project is built with ODOM_TASK=1. LemLib is then linked with hooks (see ODOM_TASK_WRAP and
+ * MOTION_WRAP in common.mk) that start this task in place of LemLib's when the chassis is calibrated, and that route
+ * lemlib::getPose() and lemlib::setPose() through it:
+ *
+ * - after every update the task publishes the pose through a seqlock, so getPose() from any other task, including
+ * Chassis::getPose() and every motion, reads a consistent pose without taking a lock
+ * - setPose() from another task is handed to the odometry task and applied before its next update, so it can't land
+ * in the middle of one. getPose() returns it straight away
+ * - getPose() from a task running a motion is moved ahead by the latency compensation of
+ * include/latencyCompensation.hpp. Every other task gets the measured pose
+ *
+ * The task wakes with Task::delay_until, so the period doesn't stretch with the time each update takes. Sensors only
+ * report new readings every 10ms by default, so set the data rate of rotation sensors to 5ms to get anything out of a
+ * faster period. lemlib::getSpeed(), getLocalSpeed() and estimatePose() still read LemLib's state directly, and the
+ * speeds assume a 10ms period, so use the filtered speeds of include/motionEstimator.hpp instead. The task also keeps
+ * the pose history of include/poseHistory.hpp, and can integrate with FastOdometry instead of lemlib::update(), see
+ * include/fastOdometry.hpp, and correct its IMU heading for drift, see include/gyroBias.hpp. It also watches for slip
+ * and pushes, see include/slipDetector.hpp, and keeps the motion estimate that motions see ahead by the latency of the
+ * drivetrain with, see include/latencyCompensation.hpp.
+ */
+
+/**
+ * @brief Set how often odometry updates
+ *
+ * Takes effect from the next update. Without ODOM_TASK, LemLib always updates every 10ms.
+ *
+ * @param milliseconds the period, from 1 to 10. 5 by default
+ */
+void setOdometryPeriod(uint32_t milliseconds);
+
+/**
+ * @brief How often odometry updates, in milliseconds
+ */
+uint32_t odometryPeriod();
+
+/**
+ * @brief Whether odometry runs in its own task
+ *
+ * @return true the project was built with ODOM_TASK=1 and the chassis has been calibrated
+ */
+bool odometryTaskRunning();
+
+/**
+ * @brief Whether the calling task is the odometry task
+ *
+ * @return false the project was built without ODOM_TASK, or the task isn't running
+ */
+bool inOdometryTask();
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "lemlib/pose.hpp"
+#include "pros/gps.hpp"
+#include "pros/imu.hpp"
+
+/**
+ * An extended Kalman filter that corrects odometry with absolute measurements, for long autonomous and skills runs
+ * where dead reckoning drifts.
+ *
+ * Runs in the odometry task of include/odomTask.hpp, so it needs ODOM_TASK=1. Every update, the change in the
+ * LemLib odometry pose is the prediction step, with an uncertainty that grows with how far the robot drove and
+ * turned. IMU heading and GPS readings are then fused as measurements. lemlib::getPose() and Chassis::getPose(), and
+ * so every motion, return the fused pose, and lemlib::setPose() resets it.
+ *
+ * The GPS reports where it is in meters, with the origin in the middle of the field, so the LemLib pose has to be set
+ * in the frame of the GPS, in inches, for its readings to make sense. Set the offset of the GPS from the tracking
+ * center with pros::Gps::set_offset().
+ */
+
+struct PoseEstimatorSettings {
+        // how far odometry may be off after driving an inch, as a standard deviation in inches: along the direction
+        // of travel, and sideways, from wheel scrub. Errors add up like a random walk, so after driving n inches the
+        // standard deviation is sqrt(n) times this
+        float forwardNoise = 0.1;
+        float lateralNoise = 0.1;
+        // how far the heading may be off, as a standard deviation in degrees: after turning a degree, and after
+        // driving an inch
+        float turnNoise = 0.1;
+        float driftNoise = 0.05;
+        // standard deviation of the IMU heading, in degrees
+        float imuNoise = 0.5;
+        // GPS readings whose RMS error is larger than this are left out, in inches
+        float gpsMaxError = 4;
+        // standard deviation of the GPS heading, in degrees. 0 to only fuse its position
+        float gpsHeadingNoise = 2;
+        // how often a GPS reading is fused, in milliseconds. Fusing the same reading twice would make the filter more
+        // sure of it than it should be
+        uint32_t gpsInterval = 50;
+        // GPS positions further from the estimate than this many standard deviations are left out as outliers
+        float gpsGate = 3;
+        // after this many outliers in a row, the estimate is the one that is wrong, so the next reading is fused anyway
+        int gpsMaxOutliers = 10;
+        // how sure the filter is of a pose that was set, as standard deviations in inches and degrees
+        float initialPositionError = 1;
+        float initialHeadingError = 1;
+};
+
+/**
+ * @brief A fused pose and how sure the filter is of it
+ */
+struct PoseEstimate {
+        lemlib::Pose pose = {0, 0, 0};
+        // covariance of x, y and theta, in inches and the units of theta
+        std::array<std::array<float, 3>, 3> covariance = {};
+        // GPS readings fused, and left out as outliers, since the estimator started
+        uint32_t gpsFused = 0;
+        uint32_t gpsRejected = 0;
+};
+
+/**
+ * @brief Start fusing the IMU and GPS into odometry
+ *
+ * Call once, before or after calibrating the chassis. The filter starts from the odometry pose of the next update.
+ *
+ * If the IMU is in lemlib::OdomSensors, odometry already takes its heading from it, so pass nullptr here rather than
+ * fuse the same readings twice. Passing it here instead lets the filter weigh it against the tracking wheels.
+ *
+ * @param imu the IMU to fuse the heading of, or nullptr
+ * @param gps the GPS to fuse, or nullptr
+ * @param settings how noisy odometry and the sensors are
+ * @return false the project was built without ODOM_TASK, or the estimator was already started
+ *
+ * @b Example
+ * @code {.cpp}
+ * pros::Gps gps(5);
+ * gps.set_offset(-0.1, 0.05);
+ * startPoseEstimator(nullptr, &gps);
+ * chassis.setPose(-48, -60, 0);
+ * @endcode
+ */
+bool startPoseEstimator(pros::Imu* imu, pros::Gps* gps, const PoseEstimatorSettings& settings = {});
+
+bool poseEstimatorRunning();
+
+/**
+ * @brief The last fused pose, and its covariance
+ *
+ * Never waits for the odometry task, like lemlib::getPose().
+ *
+ * @param estimate where to put it
+ * @param radians true for theta in radians, false for degrees. False by default
+ * @return false the estimator isn't running, or hasn't updated yet. estimate is then left alone
+ */
+bool getPoseEstimate(PoseEstimate& estimate, bool radians = false);
+
+/**
+ * @brief Run one step of the filter
+ *
+ * Called by the odometry task after every update.
+ *
+ * @param odometry the pose LemLib calculated, in radians
+ * @return lemlib::Pose the fused pose, in radians
+ */
+lemlib::Pose fusePose(const lemlib::Pose& odometry);
+
+/**
+ * @brief Start the filter again from a pose
+ *
+ * Called by the odometry task when the pose is set, after it is set in LemLib.
+ *
+ * @param pose the pose, in radians
+ */
+void resetPoseEstimate(const lemlib::Pose& pose);
+
+/**
+ * @brief Make the filter less sure of its pose, after odometry is known to have gone wrong
+ *
+ * Called by the odometry task before fusePose(), by include/slipDetector.hpp while the robot slips or is pushed, so
+ * GPS readings pull the estimate back at once rather than being left out as outliers.
+ *
+ * @param positionError how much further the position may be off now, as a standard deviation in inches
+ * @param headingError how much further the heading may be off now, as a standard deviation in radians
+ */
+void widenPoseEstimate(float positionError, float headingError);
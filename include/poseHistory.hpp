@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include "lemlib/pose.hpp"
+
+/**
+ * Keeps the last POSE_HISTORY_CAPACITY poses the odometry task calculated, with the time the sensors were read and
+ * the velocity of the robot, so a reading that is a few tens of milliseconds old (a distance sensor, the GPS) can be
+ * compared against where the robot was when it was taken instead of where it is now.
+ *
+ * The history is only filled in by the odometry task of include/odomTask.hpp, so build the project with ODOM_TASK=1.
+ * It lives in a fixed ring buffer, and the odometry task never waits for a reader: a reader that is too slow to copy a
+ * sample before it is overwritten looks it up again. Setting the pose clears the history, since the poses before it
+ * are in a different frame.
+ */
+
+// at the default 5ms odometry period, a little over a second of history
+constexpr uint32_t POSE_HISTORY_CAPACITY = 256;
+
+/**
+ * @brief Where the robot was, and how fast it was moving
+ */
+struct PoseSample {
+        // when the sensors were read, in milliseconds since the program started
+        uint32_t time = 0;
+        // in radians
+        lemlib::Pose pose = {0, 0, 0};
+        // in inches and radians per second, in the global frame, filtered by include/motionEstimator.hpp
+        lemlib::Pose velocity = {0, 0, 0};
+};
+
+/**
+ * @brief Add a sample to the history
+ *
+ * Called by the odometry task after every update. Only one task may record.
+ *
+ * @param time when the sensors were read, in microseconds
+ * @param pose the pose, in radians
+ * @param velocity the velocity, in inches and radians per second
+ */
+void recordPoseSample(uint32_t time, const lemlib::Pose& pose, const lemlib::Pose& velocity);
+
+/**
+ * @brief Forget every sample
+ *
+ * Called by the odometry task when the pose is set.
+ */
+void clearPoseHistory();
+
+/**
+ * @brief Where the robot was at a time, interpolated between the samples either side of it
+ *
+ * @param time the time, in milliseconds since the program started
+ * @param sample the interpolated sample
+ * @return true the time is covered by the history
+ * @return false the time is older than the history, newer than the last update, or nothing has been recorded yet.
+ * sample is then left alone
+ */
+bool getPoseSampleAt(uint32_t time, PoseSample& sample);
+
+/**
+ * @brief Where the robot was at a time
+ *
+ * Interpolates between the samples either side of the time. Times older than the history get the oldest sample, and
+ * times newer than the last update get the last one. Without any history, this is lemlib::getPose().
+ *
+ * @param time the time, in milliseconds since the program started
+ * @param radians true for theta in radians, false for degrees. False by default
+ *
+ * @b Example
+ * @code {.cpp}
+ * // a distance sensor reading is about 30ms old by the time it is read
+ * const lemlib::Pose then = getPoseAt(pros::millis() - 30);
+ * @endcode
+ */
+lemlib::Pose getPoseAt(uint32_t time, bool radians = false);
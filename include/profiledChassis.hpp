@@ -0,0 +1,146 @@
+#pragma once
+
+#include <optional>
+#include "feedforward.hpp"
+#include "lemlib/api.hpp" // IWYU pragma: keep
+#include "motionProfile.hpp"
+
+/**
+ * @brief Gains of a PID, on the scale of lemlib::ControllerSettings, out of 127 per inch or per degree
+ */
+struct CorrectionGains {
+        float kP = 0;
+        float kI = 0;
+        float kD = 0;
+};
+
+/**
+ * @brief How the profiled motions plan their profiles, and correct what feedforward misses
+ */
+struct ProfileSettings {
+        // the most voltage a profile plans for, in volts. What's left of 12 is for the correction to catch up with
+        float maxVoltage = 10;
+        // in inches per second squared. 0 for what maxVoltage gives at half the top speed. Set it lower if the wheels
+        // slip
+        float maxAcceleration = 0;
+        // how long the acceleration takes to build up and let off, in milliseconds, which limits jerk. 0 for a
+        // trapezoidal profile
+        float rampTime = 100;
+        // the profile waits while the robot is further behind it than this, in inches, or in degrees for turns, so a
+        // robot that had to turn first, or got pushed, doesn't chase a profile that went on without it
+        float maxLag = 4;
+        float maxAngularLag = 15;
+        // the PIDs that correct how far the robot is from the profile, and steer it. Feedforward does most of the
+        // work, so they need much less kP than LemLib's feedback only motions. A kP of 0 uses the chassis controllers
+        CorrectionGains lateral;
+        CorrectionGains angular;
+};
+
+/**
+ * @brief A chassis with motion profiled versions of moveToPoint() and moveToPose()
+ *
+ * LemLib's motions drive with a PID on the distance left, capped by maxSpeed and slewed. Tuned to start hard, it
+ * overshoots, and tuned not to, it crawls through a long tail as the error gets small. The profiled motions plan a
+ * time-optimal, jerk-limited velocity profile along the path instead, from the top speed and acceleration of the
+ * drivetrain's feedforward model, and drive it with the kS, kV and kA feedforward voltage for the profile's velocity
+ * and acceleration, sent to the motors in millivolts. The lateral PID only corrects how far the robot is from where
+ * the profile says it should be. Steering adds the angular feedforward for turning along the arc to the carrot, and
+ * the angular PID corrects the rest. Turns are profiled the same way with the angular model. The motions still settle
+ * with the chassis exit conditions, and steer by getCompensatedPose(), so with latency compensation on they see where
+ * the robot will be, see include/latencyCompensation.hpp.
+ *
+ * The motions share LemLib's motion queue, so they can be mixed with LemLib's motions, waited for with
+ * waitUntilDone() and waitUntil(), and cancelled with cancelMotion(). Without a model they run LemLib's motions
+ * instead.
+ *
+ * @b Example
+ * @code {.cpp}
+ * chassis.setProfile({{1.1, 0.19, 0.03}, {1.2, 0.016, 0.002}}, {.lateral = {8, 0, 12}, .angular = {2, 0, 20}});
+ * chassis.moveToPointProfiled(0, 48, 2000);
+ * chassis.moveToPoseProfiled(24, 24, 90, 3000, {.lead = 0.5});
+ * chassis.turnToHeadingProfiled(180, 1000);
+ * @endcode
+ */
+class ProfiledChassis : public lemlib::Chassis {
+    public:
+        using lemlib::Chassis::Chassis;
+
+        /**
+         * @brief Set the model the profiled motions plan and drive with
+         *
+         * Set it before running a profiled motion, not while one runs.
+         *
+         * @param model the feedforward model of the drivetrain, measured with characterizeDrivetrain()
+         * @param settings how to plan the profiles
+         */
+        void setProfile(const DriveCharacterization& model, const ProfileSettings& settings = {});
+
+        /**
+         * @brief The limits the profiled motions plan with at full speed
+         *
+         * @param angular the limits of turns, in degrees per second, squared and cubed, rather than in inches
+         */
+        ProfileConstraints profileConstraints(bool angular = false) const;
+
+        /**
+         * @brief Move the chassis to a point along a motion profile
+         *
+         * Like moveToPoint(). The profile starts from how fast the robot is already going, so motions chain. With a
+         * minSpeed, the profile arrives at that speed rather than stopping, and the motion ends once the robot is
+         * within earlyExitRange of the point, or passes it.
+         *
+         * @param x x location
+         * @param y y location
+         * @param timeout longest time the robot can spend moving
+         * @param params the forwards, maxSpeed, minSpeed and earlyExitRange of moveToPoint()
+         * @param async whether the function should be run asynchronously. true by default
+         */
+        void moveToPointProfiled(float x, float y, int timeout, lemlib::MoveToPointParams params = {},
+                                 bool async = true);
+
+        /**
+         * @brief Move the chassis to a pose along a motion profile
+         *
+         * Like moveToPose(). The robot steers towards a carrot point like moveToPose() does, and the profile runs
+         * along the curve that makes, to the pose.
+         *
+         * @param x x location
+         * @param y y location
+         * @param theta target heading in degrees
+         * @param timeout longest time the robot can spend moving
+         * @param params the forwards, lead, maxSpeed, minSpeed and earlyExitRange of moveToPose()
+         * @param async whether the function should be run asynchronously. true by default
+         */
+        void moveToPoseProfiled(float x, float y, float theta, int timeout, lemlib::MoveToPoseParams params = {},
+                                bool async = true);
+
+        /**
+         * @brief Turn the chassis to a heading along a motion profile
+         *
+         * Like turnToHeading(), driven with the angular feedforward model. With a minSpeed, the profile arrives at
+         * that speed, and the motion ends once the robot is within earlyExitRange of the heading, or passes it.
+         *
+         * @param theta heading location
+         * @param timeout longest time the robot can spend moving
+         * @param params the direction, maxSpeed, minSpeed and earlyExitRange of turnToHeading()
+         * @param async whether the function should be run asynchronously. true by default
+         */
+        void turnToHeadingProfiled(float theta, int timeout, lemlib::TurnToHeadingParams params = {},
+                                   bool async = true);
+    private:
+        /**
+         * @brief Drive a profile to a point, or to a pose if there is a heading. Runs in the task of the motion
+         */
+        void followProfile(float x, float y, std::optional<float> theta, int timeout,
+                           const lemlib::MoveToPoseParams& params);
+        /**
+         * @brief Drive an angular profile to a heading. Runs in the task of the motion
+         */
+        void followTurn(float theta, int timeout, const lemlib::TurnToHeadingParams& params);
+
+        DriveCharacterization model;
+        ProfileSettings settings;
+        // the correction PIDs of the settings, if they have gains
+        std::optional<lemlib::PID> lateralCorrection;
+        std::optional<lemlib::PID> angularCorrection;
+};
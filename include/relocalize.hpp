@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "lemlib/api.hpp" // IWYU pragma: keep
+#include "pros/distance.hpp"
+
+/**
+ * @brief A distance sensor that can see the field walls
+ */
+struct WallSensor {
+        pros::Distance* sensor;
+        // where the sensor is from the tracking center, in inches. x is to the right of the robot, y to its front
+        float x;
+        float y;
+        // which way the sensor faces, in degrees clockwise from the front of the robot. 90 faces right, -90 left
+        float heading;
+};
+
+/**
+ * @brief Where the inside faces of the field walls are, in the frame of the odometry pose, in inches
+ *
+ * The default is a 12 foot field with the origin in its middle. Measure the field to get more out of relocalizing.
+ */
+struct FieldWalls {
+        float left = -70.2;
+        float right = 70.2;
+        float bottom = -70.2;
+        float top = 70.2;
+};
+
+struct RelocalizeSettings {
+        // a sensor only measures a wall it faces squarely, within this many degrees
+        float maxAngleError = 5;
+        // readings with a lower Distance::get_confidence() are left out. The sensor only reports a confidence for
+        // readings further than about 8 inches
+        int minConfidence = 40;
+        // readings outside this range are left out, in inches
+        float minDistance = 1;
+        float maxDistance = 78;
+        // readings that would move the pose further than this are taken to be of something other than a wall, in
+        // inches
+        float maxCorrection = 6;
+        // sensors on the same wall that disagree by more than this are both left out, in inches
+        float maxDisagreement = 1;
+        // how old a reading is by the time it is read, in milliseconds. The correction is worked out against the pose
+        // at the time the reading was taken, see include/poseHistory.hpp
+        uint32_t latency = 30;
+};
+
+struct RelocalizeResult {
+        bool correctedX = false;
+        bool correctedY = false;
+        // how far the pose was moved, in inches
+        float dx = 0;
+        float dy = 0;
+        // sensors whose readings were used, and sensors that faced a wall but whose readings were left out
+        int accepted = 0;
+        int rejected = 0;
+};
+
+/**
+ * @brief Correct x and y of the odometry pose with the distance from the robot to the field walls
+ *
+ * Every sensor that faces a wall squarely measures the robot's distance from it, which sets x for the left and right
+ * walls and y for the top and bottom ones. Readings with a low confidence, out of range, that disagree with another
+ * sensor on the same wall or that would move the pose too far are left out, since they are likely of a game element
+ * or another robot. Heading is left alone; it has to be close enough to tell which wall each sensor faces.
+ *
+ * The robot can be moving, since the correction is worked out against the pose when the reading was taken and then
+ * added to the current pose, but readings are cleaner when the robot is still.
+ *
+ * @param chassis the chassis whose pose to correct
+ * @param sensors the sensors that can see the walls
+ * @param walls where the walls are
+ * @param settings when to trust a reading
+ * @return RelocalizeResult what was corrected
+ *
+ * @b Example
+ * @code {.cpp}
+ * pros::Distance backSensor(15);
+ * // 6 inches behind the tracking center, facing backwards
+ * const std::vector<WallSensor> wallSensors = {{&backSensor, 0, -6, 180}};
+ * chassis.turnToHeading(0, 1000);
+ * chassis.waitUntilDone();
+ * relocalize(chassis, wallSensors);
+ * @endcode
+ */
+RelocalizeResult relocalize(lemlib::Chassis& chassis, const std::vector<WallSensor>& sensors,
+                            const FieldWalls& walls = {}, const RelocalizeSettings& settings = {});
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include "gyroBias.hpp"
+#include "lemlib/api.hpp" // IWYU pragma: keep
+
+/**
+ * Records every sensor reading the odometry task makes, so sim/tools/odomReplay.cpp can feed them back through
+ * lemlib::update() on the host.
+ *
+ * The log is only written when the project is built with SENSOR_LOG=1. It starts with a SensorLogHeader and one
+ * SensorLogWheel per tracking wheel, in the order the odometry task reads them. Each odometry update then adds one
+ * record:
+ *
+ * uint32_t sequence, uint32_t time in microseconds, float distance of every wheel in inches, double IMU rotation in
+ * degrees if there is an IMU, float left and right motor group positions, each the average of the group's motors,
+ * and float x, y and theta in radians of the pose odometry calculated from them.
+ *
+ * Everything is little endian, the byte order of both the brain and the host.
+ */
+
+/**
+ * @brief The start of a sensor log
+ */
+struct SensorLogHeader {
+        // "OLOG"
+        char magic[4];
+        uint8_t version;
+        uint8_t wheelCount;
+        uint8_t hasImu;
+        uint8_t reserved;
+};
+
+/**
+ * @brief A tracking wheel the odometry task reads
+ */
+struct SensorLogWheel {
+        enum Slot : uint8_t { VERTICAL1, VERTICAL2, HORIZONTAL1, HORIZONTAL2 };
+        // where the wheel is in lemlib::OdomSensors
+        uint8_t slot;
+        // TrackingWheel::getType(). 1 for a wheel LemLib made out of a drivetrain motor group
+        uint8_t type;
+        uint16_t reserved;
+        float offset;
+};
+
+constexpr char SENSOR_LOG_MAGIC[4] = {'O', 'L', 'O', 'G'};
+constexpr uint8_t SENSOR_LOG_VERSION = 1;
+
+/**
+ * @brief An inertial sensor whose readings are recorded by the sensor log
+ *
+ * LemLib reads the IMU through a virtual call, which the linker hooks can't intercept, so pass one of these to
+ * lemlib::OdomSensors in place of a pros::Imu. It is a GyroBiasImu, so the log records the corrected heading
+ * lemlib::update() reads while useGyroBias() is on.
+ */
+class LoggedImu : public GyroBiasImu {
+    public:
+        using GyroBiasImu::GyroBiasImu;
+        double get_rotation() const override;
+};
+
+/**
+ * @brief Start recording the odometry task's sensor readings
+ *
+ * A low priority task writes the log, so the odometry task never waits for the SD card. Readings are dropped when
+ * the writer falls behind; the sequence numbers of the records show where.
+ *
+ * @param path where to write the log, usually on the SD card
+ * @param sensors the sensors the chassis was created with
+ * @param drivetrain the drivetrain the chassis was created with
+ * @return true the log was started
+ * @return false the project was built without SENSOR_LOG, a log is already running or the file can't be opened
+ */
+bool startSensorLog(const char* path, const lemlib::OdomSensors& sensors, const lemlib::Drivetrain& drivetrain);
+
+/**
+ * @brief Stop recording, and wait for everything recorded to be written
+ */
+void stopSensorLog();
+
+/**
+ * @brief How many records have been written, and dropped because the writer fell behind
+ */
+uint32_t sensorLogRecords();
+uint32_t sensorLogDropped();
+
+/**
+ * @brief Record a tracking wheel reading. Called by the LemLib hooks in loopTiming.cpp
+ */
+void logWheelReading(lemlib::TrackingWheel* wheel, float distance);
+
+/**
+ * @brief Finish the record of an odometry update. Called by the LemLib hooks in loopTiming.cpp
+ */
+void finishSensorLogRecord();
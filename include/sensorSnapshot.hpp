@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "gyroBias.hpp"
+#include "lemlib/api.hpp" // IWYU pragma: keep
+
+/**
+ * @brief Every odometry input, read once in one pass
+ */
+struct OdometrySnapshot {
+        // when the reads started, in microseconds
+        uint32_t time = 0;
+        // distance traveled by vertical 1, vertical 2, horizontal 1 and horizontal 2, in inches. 0 for a missing wheel
+        float wheels[4] = {};
+        // IMU rotation, in degrees. NAN without an IMU
+        double imu = NAN;
+};
+
+/**
+ * @brief Reads the odometry sensors into an OdometrySnapshot
+ *
+ * Reads the same sensors lemlib::update() does, but each of them once per snapshot, and without allocating: the
+ * vertical wheels LemLib makes out of the drivetrain are read motor by motor, with the gear ratios worked out when the
+ * reader is created, instead of through TrackingWheel::getDistanceTraveled(), which allocates three vectors every
+ * call for a motor group. Tracking wheels with their own sensor are read with getDistanceTraveled().
+ */
+class SnapshotReader {
+    public:
+        /**
+         * @param sensors the sensors the chassis was created with. Missing vertical wheels are made out of the
+         * drivetrain, like LemLib does
+         * @param drivetrain the drivetrain the chassis was created with
+         */
+        SnapshotReader(const lemlib::OdomSensors& sensors, const lemlib::Drivetrain& drivetrain);
+
+        void read(OdometrySnapshot& snapshot);
+
+        /**
+         * @brief Read only the IMU rotation, like read() does
+         *
+         * @param timeMicros when it is read, from pros::micros()
+         */
+        double readImu(uint32_t timeMicros);
+
+        /**
+         * @brief Take the IMU rotation from a GyroBiasEstimator instead of the chassis IMU
+         *
+         * @param estimator the estimator, or nullptr for the chassis IMU
+         */
+        void setGyroBias(GyroBiasEstimator* estimator) { gyroBias = estimator; }
+
+        GyroBiasEstimator* getGyroBias() const { return gyroBias; }
+
+        bool hasWheel(int slot) const { return wheels[slot].wheel != nullptr || wheels[slot].motors != nullptr; }
+
+        /**
+         * @brief How far a wheel is from the tracking center, like TrackingWheel::getOffset()
+         */
+        float offset(int slot) const { return wheels[slot].offset; }
+
+        /**
+         * @brief Whether a wheel is made out of drivetrain motors, like TrackingWheel::getType()
+         */
+        bool powered(int slot) const { return wheels[slot].powered; }
+
+        bool hasImu() const { return imu != nullptr; }
+    private:
+        struct Wheel {
+                // a tracking wheel with its own sensor, or nullptr
+                lemlib::TrackingWheel* wheel = nullptr;
+                // the motors of a wheel made out of the drivetrain, or nullptr
+                pros::MotorGroup* motors = nullptr;
+                // inches the robot moves per rotation of each motor
+                std::vector<float> inchesPerRotation;
+                float offset = 0;
+                bool powered = false;
+        };
+
+        float distance(Wheel& wheel);
+
+        Wheel wheels[4];
+        pros::Imu* imu;
+        GyroBiasEstimator* gyroBias = nullptr;
+};
+
+/**
+ * @brief Publish the snapshot an odometry update used, for anything else that wants the same readings
+ *
+ * Called by the odometry task after every update it makes with a SnapshotReader.
+ */
+void publishOdometrySnapshot(const OdometrySnapshot& snapshot);
+
+/**
+ * @brief The snapshot of the last odometry update
+ *
+ * Never waits for the odometry task. Only filled in while the odometry task of include/odomTask.hpp runs
+ * FastOdometry, since lemlib::update() reads its sensors itself.
+ *
+ * @param snapshot where to put it
+ * @return false there is no snapshot yet. snapshot is then left alone
+ */
+bool getOdometrySnapshot(OdometrySnapshot& snapshot);
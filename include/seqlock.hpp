@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "pros/rtos.hpp"
+
+/**
+ * @brief A value that one task writes and any task can read without a lock
+ *
+ * The writer makes the sequence odd while it writes, and even again when it is done. A reader that sees the same even
+ * sequence before and after reading got a value from a single write. The value is kept as atomic words, so a read
+ * that overlaps a write copies a torn value that is thrown away, rather than racing with the writer.
+ *
+ * Only one task may write at a time. Readers never block the writer, so the odometry task publishes with it.
+ */
+template <typename T> class Seqlock {
+        static_assert(std::is_trivially_copyable_v<T>, "a seqlock copies its value word by word");
+    public:
+        void write(const T& value) {
+            uint32_t buffer[WORDS] = {};
+            std::memcpy(buffer, &value, sizeof(T));
+            const uint32_t start = sequence.load(std::memory_order_relaxed);
+            sequence.store(start + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < WORDS; i++) words[i].store(buffer[i], std::memory_order_relaxed);
+            sequence.store(start + 2, std::memory_order_release);
+        }
+
+        /**
+         * @brief Copy the value of the last write
+         *
+         * @param value where to put it
+         * @return false nothing has been written yet. value is then left alone
+         */
+        bool read(T& value) const {
+            while (true) {
+                const uint32_t before = sequence.load(std::memory_order_acquire);
+                if (before == 0) return false;
+                // the writer was interrupted by this task. Let it finish
+                if (before & 1) {
+                    pros::delay(1);
+                    continue;
+                }
+                uint32_t buffer[WORDS];
+                for (size_t i = 0; i < WORDS; i++) buffer[i] = words[i].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before) {
+                    std::memcpy(&value, buffer, sizeof(T));
+                    return true;
+                }
+            }
+        }
+    private:
+        static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+        std::atomic<uint32_t> sequence = 0;
+        std::atomic<uint32_t> words[WORDS] = {};
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include "lemlib/api.hpp" // IWYU pragma: keep
+#include "sensorSnapshot.hpp"
+
+/**
+ * Detects wheel slip, pushes and collisions while odometry runs, by comparing what the drive motors, the tracking
+ * wheels and the IMU each say the robot did.
+ *
+ * Runs in the odometry task of include/odomTask.hpp, so it needs ODOM_TASK=1. Every update it works out:
+ *
+ * - how fast the drive motors and an unpowered vertical tracking wheel say the robot moves forwards. Drive wheels that
+ * spin faster than the robot moves, or skid while it slows down, are slipping. Otherwise the robot is pushed
+ * - how fast a horizontal tracking wheel says the robot moves sideways, which a tank drive can't do by itself, so it
+ * is pushed
+ * - how fast the drive motors and the IMU say the robot turns. An IMU that turns faster means the robot is pushed, and
+ * drive wheels that turn much faster are slipping
+ * - how hard the IMU says the robot accelerates. More than the drivetrain can manage is a collision
+ *
+ * Speeds are averaged over a short window, so single noisy readings don't count. Each time one of these starts it is
+ * counted as an event, and for recoveryTime after the last one the pose isn't trusted, see poseTrusted(). When the
+ * pose estimator of include/poseEstimator.hpp runs, it is made less sure of the pose by however far the sensors
+ * disagree, so GPS readings pull it back.
+ */
+
+/**
+ * @brief Settings for the slip detector
+ */
+struct SlipDetectorSettings {
+        // how long speeds are averaged over, in milliseconds
+        uint32_t window = 50;
+        // the drive wheels go this much faster than the tracking wheel, in inches per second
+        float slipSpeed = 8;
+        // the tracking wheel goes this much faster than the drive wheels, in inches per second
+        float pushSpeed = 6;
+        // the robot moves sideways this fast, in inches per second
+        float lateralSpeed = 6;
+        // the drive wheels and the IMU turn this much faster than each other, in degrees per second
+        float turnRate = 45;
+        // drive wheels scrub when the robot turns, so they may turn this much faster than the IMU on top of turnRate,
+        // as a fraction of the IMU rate
+        float scrubRatio = 0.3;
+        // the IMU accelerates this hard sideways and forwards together, in g
+        float collisionAcceleration = 1.2;
+        // how long the pose isn't trusted after the last event, in milliseconds
+        uint32_t recoveryTime = 500;
+        // whether the pose estimator is made less sure of the pose while the sensors disagree
+        bool degrade = true;
+        // how far the pose estimator is made less sure of the position by a collision, in inches
+        float collisionError = 1;
+};
+
+enum class MotionEventType { SLIP, PUSH, COLLISION };
+
+/**
+ * @brief One slip, push or collision
+ */
+struct MotionEvent {
+        MotionEventType type = MotionEventType::SLIP;
+        // when it started, in milliseconds
+        uint32_t time = 0;
+        // how far the sensors disagreed when it started, in inches per second, degrees per second, or g for a
+        // collision
+        float magnitude = 0;
+};
+
+/**
+ * @brief What the slip detector has seen
+ */
+struct MotionStatus {
+        // whether each has been seen within the last window
+        bool slipping = false;
+        bool pushed = false;
+        bool colliding = false;
+        // how many of each there have been since the detector started
+        uint32_t slips = 0;
+        uint32_t pushes = 0;
+        uint32_t collisions = 0;
+        // the last one to start. Only set once there has been one
+        MotionEvent last;
+        // see poseTrusted()
+        bool trusted = true;
+};
+
+/**
+ * @brief Start detecting slip, pushes and collisions
+ *
+ * Call once, before or after calibrating the chassis.
+ *
+ * @param sensors the sensors the chassis was created with
+ * @param drivetrain the drivetrain the chassis was created with
+ * @param settings the settings
+ * @return false the project was built without ODOM_TASK, or the detector was already started
+ *
+ * @b Example
+ * @code {.cpp}
+ * startSlipDetector(sensors, drivetrain);
+ * chassis.moveToPose(24, 48, 90, 3000);
+ * while (chassis.isInMotion()) {
+ *     // shoved off course, so stop and relocalize rather than finish the motion from a bad pose
+ *     if (!poseTrusted()) chassis.cancelMotion();
+ *     pros::delay(10);
+ * }
+ * @endcode
+ */
+bool startSlipDetector(const lemlib::OdomSensors& sensors, const lemlib::Drivetrain& drivetrain,
+                       const SlipDetectorSettings& settings = {});
+
+bool slipDetectorRunning();
+
+/**
+ * @brief What the slip detector has seen so far
+ *
+ * Never waits for the odometry task.
+ *
+ * @param status where to put it
+ * @return false the detector isn't running, or hasn't updated yet. status is then left alone
+ */
+bool getMotionStatus(MotionStatus& status);
+
+/**
+ * @brief Whether the pose can be trusted
+ *
+ * @return false the robot slipped, was pushed or collided less than recoveryTime ago. Always true while the
+ * detector isn't running
+ */
+bool poseTrusted();
+
+/**
+ * @brief Compare the sensors once
+ *
+ * Called by the odometry task after every update, before fusing the pose.
+ *
+ * @param snapshot the readings odometry just used, or nullptr to read them here
+ */
+void detectSlip(const OdometrySnapshot* snapshot);
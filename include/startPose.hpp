@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+#include "lemlib/api.hpp" // IWYU pragma: keep
+#include "pros/gps.hpp"
+#include "relocalize.hpp"
+
+struct StartPoseSettings {
+        // how far the robot may be from where the routine starts before it counts as misplaced, in inches and degrees
+        float tolerance = 2;
+        float headingTolerance = 5;
+        // how long the sensors are read for, in milliseconds. Each distance sensor counts as the median of its
+        // readings, and the GPS as their average
+        uint32_t sampleTime = 300;
+        // how far from a start the robot may plausibly have been put down, as standard deviations in inches and
+        // degrees. Keeps what the sensors can't see close to the start
+        float placementSpread = 6;
+        float headingSpread = 10;
+        // standard deviation of a distance reading, in inches
+        float distanceNoise = 0.5;
+        // a distance reading this far from what a start predicts is taken to be of something other than a wall, like
+        // a game element, in inches
+        float outlierDistance = 4;
+        // readings with a lower Distance::get_confidence() are left out, as are readings beyond maxDistance, in inches
+        int minConfidence = 40;
+        float maxDistance = 78;
+        // GPS readings whose RMS error is larger than this are left out, in inches
+        float gpsMaxError = 4;
+        // standard deviation of the GPS heading, in degrees. 0 to only use its position
+        float gpsHeadingNoise = 2;
+};
+
+struct StartPoseResult {
+        bool ok = false;
+        // why no start pose was found, if it wasn't
+        const char* error = nullptr;
+        // which of the starts the robot was put down at, or -1
+        int start = -1;
+        // where the robot is on the field, in the frame of the walls and the GPS, in inches and degrees
+        lemlib::Pose fieldPose = {0, 0, 0};
+        // how far that is from where the routine expects to start, in inches and degrees
+        float positionError = 0;
+        float headingError = 0;
+        // further from the expected start than the tolerance, or at another start altogether
+        bool misplaced = false;
+        // whether the pose was set. Not when the robot is at another start, since the routine would then run in the
+        // frame of the wrong start
+        bool poseSet = false;
+        // distance sensors whose readings fit the start, and those left out
+        int accepted = 0;
+        int rejected = 0;
+        bool usedGps = false;
+};
+
+/**
+ * @brief Work out where the robot was put down before autonomous, and set the pose to match
+ *
+ * Autonomous routines are written as if the robot starts at (0, 0, 0), exactly where they expect. This checks that.
+ * The distance sensors and the GPS are read for a moment, and then each start the robot could have been put down at is
+ * tried in turn: the pose near it that best explains the readings is found by least squares, leaving out readings that
+ * must be of something other than a wall, and the start whose pose explains them best wins. So a robot set up for the
+ * wrong routine is caught, as well as one set up a little off.
+ *
+ * The pose is then set to where the robot is relative to the expected start, so the routine drives to the same
+ * places on the field wherever the robot was put down. Without any readings, when they fit none of the starts, or when
+ * they fit another start better than the expected one, the pose is left alone.
+ *
+ * Call it once the chassis is calibrated, with the robot still.
+ *
+ * @param chassis the chassis whose pose to set
+ * @param sensors the distance sensors that can see the field walls
+ * @param gps the GPS, or nullptr. Set its offset from the tracking center with pros::Gps::set_offset()
+ * @param expected where the selected routine starts, in the frame of the walls, in inches and degrees
+ * @param starts every start the robot could have been put down at, in the same frame. The expected one is always
+ * tried
+ * @param walls where the walls are
+ * @param settings the settings
+ * @return StartPoseResult where the robot is
+ *
+ * @b Example
+ * @code {.cpp}
+ * void competition_initialize() {
+ *     calibration.wait();
+ *     const StartPoseResult start = detectStartPose(chassis, wallSensors, nullptr, {-63, 12, 90});
+ *     if (start.misplaced) pros::lcd::print(4, "Misplaced by %.1f in", start.positionError);
+ *     if (start.ok && !start.poseSet) pros::lcd::print(5, "Set up at the wrong start");
+ * }
+ * @endcode
+ */
+StartPoseResult detectStartPose(lemlib::Chassis& chassis, const std::vector<WallSensor>& sensors, pros::Gps* gps,
+                                const lemlib::Pose& expected, const std::vector<lemlib::Pose>& starts = {},
+                                const FieldWalls& walls = {}, const StartPoseSettings& settings = {});
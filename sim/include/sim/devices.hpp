@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "sim/motor.hpp"
+#include "sim/plant.hpp"
+
+namespace sim {
+/**
+ * @brief Model of a V5 rotation sensor
+ *
+ * The sensor samples its source at the data rate, quantizes it to centidegrees and adds noise
+ */
+struct RotationSensor {
+        // true angle of the sensor shaft, in centidegrees. Not wrapped
+        std::function<double()> source;
+        // standard deviation of the measurement noise, in centidegrees
+        double noise = 1;
+        uint32_t dataRate = 10;
+        bool reversed = false;
+        bool connected = false;
+        // latest sample of the shaft angle, in centidegrees, including noise
+        double raw = 0;
+        // latest sample, in centidegrees, relative to the last reset
+        int32_t position = 0;
+        // latest sample wrapped to 0-36000, unaffected by resets
+        int32_t angle = 0;
+        int32_t velocity = 0;
+        // raw reading that the position is measured from
+        double zero = 0;
+        uint32_t lastSample = 0;
+};
+
+/**
+ * @brief Model of a V5 inertial sensor
+ *
+ * The sensor integrates the true angular velocity with a scale error, a slowly wandering bias and white noise.
+ * Calibrating estimates the bias present at the time, so drift comes from the bias changing afterwards.
+ */
+struct InertialSensor {
+        // standard deviation of the gyro noise, in degrees per second
+        double rateNoise = 0.05;
+        // bias random walk, in degrees per second per sqrt(second)
+        double biasWalk = 0.003;
+        // gyro scale error, 0.01 means 1% too much rotation is reported
+        double scaleError = 0.002;
+        // standard deviation of the accelerometer noise, in g
+        double accelNoise = 0.01;
+        uint32_t dataRate = 10;
+        bool connected = false;
+        // state
+        double bias = 0.02;
+        double calibratedBias = 0;
+        double rotation = 0;
+        double rotationOffset = 0;
+        double rate = 0;
+        double accelX = 0;
+        double accelY = 0;
+        uint32_t calibrationEnd = 0;
+        bool calibrating = false;
+        uint32_t lastSample = 0;
+        double lastHeading = 0;
+};
+
+/**
+ * @brief A reading from a distance sensor
+ */
+struct DistanceReading {
+        // distance in millimeters, 9999 if nothing is in range
+        int32_t distance = 9999;
+        // confidence, 0 to 63
+        int32_t confidence = 0;
+        int32_t objectSize = 0;
+};
+
+/**
+ * @brief Model of a V5 distance sensor
+ */
+struct DistanceSensor {
+        std::function<DistanceReading()> source;
+        // standard deviation of the measurement noise, as a fraction of the distance
+        double noise = 0.01;
+        uint32_t dataRate = 33;
+        bool connected = false;
+        DistanceReading reading;
+        uint32_t lastSample = 0;
+};
+
+/**
+ * @brief A 3-wire port on the brain
+ */
+struct AdiPort {
+        // adi_port_config_e_t the program configured the port as
+        int32_t config = 255;
+        // value written by the program
+        int32_t value = 0;
+        // reading that a quadrature encoder was last reset at
+        int32_t zero = 0;
+        // value read by the program. If not set, reads back what was written
+        std::function<int32_t()> source;
+        bool lastPressed = false;
+};
+
+/**
+ * @brief The simulated V5 controller
+ */
+struct ControllerState {
+        int32_t analog[4] = {0, 0, 0, 0};
+        bool digital[18] = {};
+        bool lastPressed[18] = {};
+        // called every tick before the program reads the controller, used to script driver input
+        std::function<void(ControllerState&, uint32_t)> script;
+};
+
+/**
+ * @brief The simulated battery
+ */
+struct BatteryState {
+        // open circuit voltage, in volts
+        float nominal = 12.8;
+        // internal resistance, in ohms
+        float resistance = 0.08;
+        // terminal voltage, in volts
+        float voltage = 12.8;
+        // total current, in amps
+        float current = 0;
+        float capacity = 100;
+        float temperature = 25;
+};
+
+/**
+ * @brief State of the field control or competition switch
+ */
+struct CompetitionState {
+        bool connected = false;
+        bool disabled = false;
+        bool autonomous = false;
+        bool field = false;
+};
+
+/**
+ * @brief Get the motor on a smart port
+ *
+ * @param port 1-21
+ */
+Motor& motor(uint8_t port);
+
+/**
+ * @brief Get the rotation sensor on a smart port
+ *
+ * @param port 1-21
+ */
+RotationSensor& rotation(uint8_t port);
+
+/**
+ * @brief Get the inertial sensor on a smart port
+ *
+ * @param port 1-21
+ */
+InertialSensor& imu(uint8_t port);
+
+/**
+ * @brief Get the distance sensor on a smart port
+ *
+ * @param port 1-21
+ */
+DistanceSensor& distance(uint8_t port);
+
+/**
+ * @brief Get a 3-wire port
+ *
+ * @param port 1-8, or 'a'-'h' / 'A'-'H'
+ */
+AdiPort& adi(uint8_t port);
+
+/**
+ * @brief Get a controller
+ *
+ * @param id 0 for the master controller, 1 for the partner controller
+ */
+ControllerState& controller(uint8_t id);
+
+/**
+ * @brief Get the battery
+ */
+BatteryState& battery();
+
+/**
+ * @brief Get the competition state
+ */
+CompetitionState& competition();
+
+/**
+ * @brief Get a line of the emulated LCD on the brain screen
+ *
+ * @param line 0-7
+ */
+std::string& screenLine(uint8_t line);
+
+/**
+ * @brief Set the drivetrain plant
+ *
+ * Motors on the plant's ports are stepped by the plant. Every other motor that has been commanded is stepped as a
+ * free motor with its own load
+ *
+ * @param model physical description of the drivetrain
+ */
+void setDrivetrain(const DrivetrainModel& model);
+
+/**
+ * @brief Get the drivetrain plant
+ */
+DifferentialDrive& drivetrain();
+
+/**
+ * @brief Start stepping the devices. Registers the device models with the scheduler tick
+ */
+void startDevices();
+} // namespace sim
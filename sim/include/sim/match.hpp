@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+namespace sim {
+/**
+ * @brief How a competition period went
+ */
+struct PeriodResult {
+        // whether the function returned before the period ended
+        bool finished = false;
+        // how long the function ran for, in microseconds
+        uint64_t duration = 0;
+};
+
+/**
+ * @brief Run a competition period, then delete the task like field control does when the period ends
+ *
+ * @param function the competition function
+ * @param name name of the task
+ * @param seconds length of the period. Negative means the period only ends when the function returns
+ * @return PeriodResult how the period went
+ */
+PeriodResult runPeriod(void (*function)(), const char* name, double seconds);
+} // namespace sim
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+
+namespace sim {
+/**
+ * @brief Model of a V5 smart motor
+ *
+ * The motor is modelled as a brushed DC motor behind the cartridge gearbox. Output torque falls linearly from the
+ * stall torque at 0 rpm to 0 at the free speed, scaled by the applied voltage. The motor's built in velocity and
+ * position controllers are modelled as simple proportional loops on top of that.
+ *
+ * All positions are in degrees and all velocities are in rpm, measured at the cartridge output shaft. Software
+ * reversing is handled by pros::Motor, so the model only ever sees the raw direction of the shaft.
+ */
+class Motor {
+    public:
+        enum class Mode { VOLTAGE, VELOCITY, POSITION, BRAKE };
+        enum class Brake { COAST = 0, BRAKE = 1, HOLD = 2 };
+
+        /**
+         * @brief Set the cartridge
+         *
+         * @param freeSpeed free speed of the cartridge in rpm. 100, 200 or 600
+         */
+        void setCartridge(float freeSpeed);
+        /**
+         * @brief Command the motor
+         *
+         * The command takes effect after the smart port latency set with setCommandDelay
+         *
+         * @param mode control mode
+         * @param target voltage in millivolts, velocity in rpm, or position in degrees depending on the mode
+         * @param velocityLimit maximum velocity in rpm, only used in position mode
+         */
+        void command(Mode mode, float target, float velocityLimit = 0);
+        /**
+         * @brief Set how long a command takes to reach the motor
+         *
+         * @param ms delay in milliseconds. 5 by default
+         */
+        void setCommandDelay(uint32_t ms);
+        /**
+         * @brief Apply any pending command that has reached the motor and update the applied voltage
+         *
+         * @param time current time in milliseconds
+         * @param batteryVoltage battery voltage in volts
+         */
+        void updateVoltage(uint32_t time, float batteryVoltage);
+        /**
+         * @brief Get the torque the motor produces at a given output speed with the current voltage
+         *
+         * @param speed output shaft speed in rpm
+         * @return float torque in N*m
+         */
+        float torqueAt(float speed) const;
+        /**
+         * @brief Move the motor with an externally determined speed, for motors that drive a mechanism
+         *
+         * @param speed output shaft speed in rpm
+         * @param dt time step in seconds
+         */
+        void drive(float speed, float dt);
+        /**
+         * @brief Step a motor that is not connected to the drivetrain plant
+         *
+         * @param dt time step in seconds
+         */
+        void stepFree(float dt);
+        /**
+         * @brief Set the load driven by a motor that is not part of the drivetrain
+         *
+         * @param inertia load inertia in kg*m^2 at the output shaft
+         * @param damping viscous damping in N*m per rpm
+         */
+        void setLoad(float inertia, float damping);
+        /**
+         * @brief Reset the position counter so the current position reads as the given value
+         *
+         * @param newPosition the new position, in degrees
+         */
+        void setZero(float newPosition);
+        /**
+         * @brief Get the position reported by the motor's encoder
+         *
+         * @return float position in degrees, relative to the last setZero
+         */
+        float getPosition() const;
+
+        // physical angle of the output shaft, unaffected by taring
+        float rawPosition = 0;
+        float velocity = 0;
+        float voltage = 0;
+        float current = 0;
+        float torque = 0;
+        float temperature = 25;
+        float targetPosition = 0;
+        float targetVelocity = 0;
+        float currentLimit = 2500;
+        float voltageLimit = 12000;
+        float freeSpeed = 200;
+        Brake brakeMode = Brake::COAST;
+        int32_t encoderUnits = 0;
+        bool connected = false;
+    private:
+        struct Command {
+                Mode mode = Mode::BRAKE;
+                float target = 0;
+                float velocityLimit = 0;
+        };
+
+        float stallTorque() const;
+        Command active;
+        Command pending;
+        bool hasPending = false;
+        uint32_t pendingTime = 0;
+        uint32_t commandDelay = 5;
+        uint32_t lastTime = 0;
+        float holdPosition = 0;
+        bool coasting = true;
+        float offset = 0;
+        float loadInertia = 0.002;
+        float loadDamping = 0.00005;
+};
+} // namespace sim
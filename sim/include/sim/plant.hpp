@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "feedforward.hpp"
+
+namespace sim {
+/**
+ * @brief Physical description of a differential drivetrain
+ *
+ * Ports are signed the same way they are in the robot code: a negative port means the motor is mounted so that a
+ * positive raw command drives that side of the robot backwards.
+ */
+struct DrivetrainModel {
+        std::vector<int8_t> leftPorts;
+        std::vector<int8_t> rightPorts;
+        // motor cartridge free speed, in rpm
+        float cartridge = 600;
+        // distance between the left and right wheels, in inches
+        float trackWidth = 10.4;
+        // diameter of the powered wheels, in inches
+        float wheelDiameter = 2.75;
+        // wheel rpm divided by motor rpm
+        float gearRatio = 480.0 / 600.0;
+        // mass of the robot, in kg
+        float mass = 6.8;
+        // moment of inertia of the robot about its center, in kg*m^2
+        float inertia = 0.2;
+        // reflected inertia of the wheels, gears and motor rotors on one side, as an equivalent mass in kg
+        float sideMass = 0.4;
+        // wheel to floor friction coefficient. Limits how much force each side can put into the floor
+        float traction = 1.0;
+        // rolling resistance of each side, in N
+        float rollingResistance = 2.0;
+};
+
+/**
+ * @brief The feedforward gains a drivetrain model behaves with while its wheels keep traction
+ *
+ * Angular kS is always 0, since the plant has no turning friction.
+ */
+DriveCharacterization expectedCharacterization(const DrivetrainModel& model);
+
+/**
+ * @brief Set the mass, moment of inertia and rolling resistance of a model to match a measured robot
+ *
+ * kV comes from the motors and gearing, so it is left to the cartridge and gear ratio. Angular kS has nothing to set.
+ *
+ * @param model the model to change
+ * @param characterization gains measured with characterizeDrivetrain()
+ */
+void applyCharacterization(DrivetrainModel& model, const DriveCharacterization& characterization);
+
+/**
+ * @brief A position and heading on the field
+ *
+ * Uses the same convention as LemLib: x and y in inches, theta in radians, 0 facing +y and increasing clockwise
+ */
+struct PlantPose {
+        double x = 0;
+        double y = 0;
+        double theta = 0;
+};
+
+/**
+ * @brief Rigid body model of a differential drive robot
+ *
+ * Each side of the drivetrain pushes on the floor through its wheels. The force a side can transmit is limited by
+ * traction, so hard acceleration or a push from another robot makes the powered wheels slip relative to the floor.
+ * Unpowered tracking wheels always follow the floor.
+ */
+class DifferentialDrive {
+    public:
+        /**
+         * @brief Create a new drivetrain plant
+         *
+         * @param model physical description of the drivetrain
+         */
+        DifferentialDrive(const DrivetrainModel& model);
+        /**
+         * @brief Step the plant forward
+         *
+         * @param dt time step in seconds
+         */
+        void step(float dt);
+        /**
+         * @brief Get the true pose of the robot
+         */
+        PlantPose getPose() const;
+        /**
+         * @brief Teleport the robot
+         */
+        void setPose(PlantPose pose);
+        /**
+         * @brief Get the distance the floor has moved under a point on the robot
+         *
+         * This is what an unpowered tracking wheel measures
+         *
+         * @param offset offset of the wheel from the center of rotation, in inches. For a vertical wheel, positive is
+         * to the right. For a horizontal wheel, positive is forwards
+         * @param horizontal whether the wheel measures sideways motion
+         * @return double distance in inches. Forwards or rightwards is positive
+         */
+        double trackingDistance(double offset, bool horizontal) const;
+        /**
+         * @brief Apply an external force to the robot, such as a push from another robot
+         *
+         * @param forward force along the robot's forward axis, in N
+         * @param right force along the robot's rightward axis, in N
+         * @param duration how long the force lasts, in seconds
+         */
+        void push(float forward, float right, float duration);
+        /**
+         * @brief Whether a port drives this drivetrain
+         */
+        bool usesPort(uint8_t port) const;
+        /**
+         * @brief Get the physical description the plant was created with
+         */
+        const DrivetrainModel& getModel() const;
+
+        // forward velocity, in inches per second
+        double velocity = 0;
+        // sideways velocity, in inches per second. Rightwards is positive
+        double lateralVelocity = 0;
+        // angular velocity, in radians per second. Clockwise is positive
+        double angularVelocity = 0;
+        // forward acceleration, in inches per second squared
+        double acceleration = 0;
+        // sideways acceleration, in inches per second squared
+        double lateralAcceleration = 0;
+        // whether each side is slipping on the floor this step
+        bool leftSlipping = false;
+        bool rightSlipping = false;
+    private:
+        struct Side {
+                std::vector<int8_t> ports;
+                // surface speed of the wheels, in inches per second
+                double wheelSpeed = 0;
+        };
+
+        float stepSide(Side& side, double floorSpeed, float dt, bool& slipping);
+
+        DrivetrainModel model;
+        Side left;
+        Side right;
+        PlantPose pose;
+        // integrated floor motion at the center of rotation
+        double forwardTravel = 0;
+        double lateralTravel = 0;
+        double headingTravel = 0;
+        float pushForward = 0;
+        float pushRight = 0;
+        float pushTime = 0;
+};
+} // namespace sim
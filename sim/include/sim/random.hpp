@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+namespace sim {
+/**
+ * @brief Seed the random number generator used by every noise model in the simulator
+ *
+ * The same seed always produces the same run
+ *
+ * @param seed the seed
+ */
+void seed(uint64_t seed);
+
+/**
+ * @brief Get the random number generator used by the simulator
+ */
+std::mt19937_64& rng();
+
+/**
+ * @brief Sample normally distributed noise
+ *
+ * @param stddev standard deviation. Returns 0 if the standard deviation is 0
+ * @return double the sample
+ */
+double gaussian(double stddev);
+
+/**
+ * @brief Sample a uniformly distributed number
+ *
+ * @param min lower bound
+ * @param max upper bound
+ * @return double the sample
+ */
+double uniform(double min, double max);
+} // namespace sim
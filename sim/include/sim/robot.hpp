@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include "sim/plant.hpp"
+
+namespace sim {
+/**
+ * @brief Options for the simulated robot
+ */
+struct RobotOptions {
+        // seed for every noise model. The same seed always produces the same run
+        uint64_t seed = 0;
+        // open circuit battery voltage, in volts
+        float batteryVoltage = 12.8;
+        // multiplier on every sensor noise level. 0 disables noise entirely
+        float noise = 1;
+        // wheel to floor friction coefficient
+        float traction = 1.0;
+        // where the robot starts on the field, in LemLib's convention
+        PlantPose startPose;
+        // gains measured on the robot with characterizeDrivetrain(), to simulate its mass, moment of inertia and
+        // rolling resistance rather than the defaults in DrivetrainModel
+        std::optional<DriveCharacterization> characterization;
+};
+
+/**
+ * @brief Set up the simulated devices to match the robot in src/
+ *
+ * Connects the drivetrain, tracking wheels, inertial sensor, arm, intake, ring loader sensors and 3-wire devices on
+ * the same ports as the robot code, and starts stepping them.
+ *
+ * @param options robot options
+ */
+void setupRobot(const RobotOptions& options);
+
+/**
+ * @brief Get the angle of the arm
+ *
+ * @return double angle in degrees, 0 when the arm is down
+ */
+double armAngle();
+} // namespace sim
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace sim {
+/**
+ * @brief A task managed by the simulator
+ *
+ * Every pros::Task created by the program is backed by one of these. Only one task runs at a time, and the
+ * scheduler decides which one. The struct is opaque outside of the scheduler.
+ */
+struct Task;
+
+/**
+ * @brief Get the current virtual time
+ *
+ * @return uint64_t microseconds since the simulation started
+ */
+uint64_t micros();
+
+/**
+ * @brief Get the current virtual time
+ *
+ * @return uint32_t milliseconds since the simulation started
+ */
+uint32_t millis();
+
+/**
+ * @brief Charge virtual CPU time to the running task
+ *
+ * Every simulated PROS call charges a small amount of time, so busy loops that never call pros::delay still let
+ * virtual time advance. If the charge crosses a 1ms tick boundary, the running task is preempted just like it would
+ * be by the FreeRTOS tick interrupt.
+ *
+ * @param us microseconds to charge. Defaults to the per-call cost set with setCallCost
+ */
+void charge(uint32_t us);
+
+/**
+ * @brief Charge the default per-call cost to the running task
+ */
+void charge();
+
+/**
+ * @brief Set how much virtual time each simulated PROS call costs
+ *
+ * @param us microseconds per call. 5 by default
+ */
+void setCallCost(uint32_t us);
+
+/**
+ * @brief Seed the order in which tasks of the same priority run
+ *
+ * With seed 0, tasks of the same priority take turns like they do under FreeRTOS. Any other seed makes the scheduler
+ * pick between them pseudo-randomly, so different seeds explore different interleavings. Either way, a run is
+ * completely determined by its seeds and can be replayed by running it again with the same ones.
+ *
+ * @param seed the seed
+ */
+void setScheduleSeed(uint64_t seed);
+
+/**
+ * @brief Create a new task
+ *
+ * The task does not start running until the scheduler picks it in run()
+ *
+ * @param function the function the task will run
+ * @param parameters parameter passed to the function
+ * @param priority task priority, higher runs first
+ * @param name task name
+ * @return Task* the new task
+ */
+Task* spawn(void (*function)(void*), void* parameters, uint32_t priority, const std::string& name);
+
+/**
+ * @brief Get the task that is currently running
+ *
+ * @return Task* the running task, or nullptr if called from outside of a task
+ */
+Task* current();
+
+/**
+ * @brief Block the running task until the given virtual time
+ *
+ * @param wakeTime time to wake up, in microseconds
+ */
+void sleepUntil(uint64_t wakeTime);
+
+/**
+ * @brief Block the running task until another task wakes it, or until a deadline
+ *
+ * @param deadline time to give up, in microseconds. UINT64_MAX waits forever
+ * @return true the task was woken by wake()
+ * @return false the deadline passed
+ */
+bool wait(uint64_t deadline);
+
+/**
+ * @brief Wake a task that is blocked in wait()
+ *
+ * If the woken task has a higher priority than the running task, the running task is preempted.
+ *
+ * @param task the task to wake. Nothing happens if it is not waiting
+ */
+void wake(Task* task);
+
+/**
+ * @brief Block the running task until another task finishes or is deleted
+ *
+ * @param task the task to wait for
+ */
+void join(Task* task);
+
+/**
+ * @brief Give up the rest of the running task's time slice
+ */
+void yield();
+
+/**
+ * @brief Delete a task. If the task is the running task, this does not return
+ *
+ * @param task the task to delete
+ */
+void kill(Task* task);
+
+/**
+ * @brief Suspend a task until it is resumed
+ *
+ * @param task the task to suspend
+ */
+void suspend(Task* task);
+
+/**
+ * @brief Resume a suspended task
+ *
+ * @param task the task to resume
+ */
+void resume(Task* task);
+
+/**
+ * @brief Get the name of a task
+ */
+const std::string& getName(Task* task);
+
+/**
+ * @brief Get the priority of a task
+ */
+uint32_t getPriority(Task* task);
+
+/**
+ * @brief Set the priority of a task
+ */
+void setPriority(Task* task, uint32_t priority);
+
+/**
+ * @brief Raise the priority of a task while it holds a mutex that a higher priority task is waiting on
+ *
+ * @param task the task holding the mutex
+ * @param priority priority of the waiting task. Has no effect if it is not higher than the task's priority
+ */
+void inheritPriority(Task* task, uint32_t priority);
+
+/**
+ * @brief Drop a task back to the priority it was given, once it no longer holds a contended mutex
+ */
+void restorePriority(Task* task);
+
+/**
+ * @brief Whether a task has finished or been deleted
+ */
+bool isDead(Task* task);
+
+/**
+ * @brief Whether a task is suspended
+ */
+bool isSuspended(Task* task);
+
+/**
+ * @brief Get the number of tasks that have not been deleted
+ */
+uint32_t taskCount();
+
+/**
+ * @brief Find a task by its name
+ *
+ * @return Task* the first live task with the given name, or nullptr
+ */
+Task* findTask(const std::string& name);
+
+/**
+ * @brief Register a function that is called every time virtual time crosses a 1ms tick
+ *
+ * The physics plant and device models use this to step forward. Tick hooks run in registration order, with no
+ * task running.
+ *
+ * @param hook function that takes the tick time in milliseconds
+ */
+void onTick(std::function<void(uint32_t)> hook);
+
+/**
+ * @brief Register a function that is called every time the scheduler switches to a task
+ *
+ * @param hook function that takes the time in microseconds and the task that is about to run
+ */
+void onSwitch(std::function<void(uint64_t, Task*)> hook);
+
+/**
+ * @brief Run the simulation
+ *
+ * Runs tasks until virtual time reaches the given time, or until every task has finished.
+ *
+ * @param until time to stop, in microseconds
+ * @return true there are still tasks alive
+ * @return false every task has finished
+ */
+bool run(uint64_t until);
+
+/**
+ * @brief Get how much virtual CPU time a task has used
+ *
+ * @param task the task
+ * @return uint64_t microseconds of CPU time
+ */
+uint64_t getCpuTime(Task* task);
+
+/**
+ * @brief Get how many times the scheduler has switched to a task
+ */
+uint32_t getSwitchCount(Task* task);
+
+/**
+ * @brief Call a function for every task, including deleted ones
+ */
+void forEachTask(std::function<void(Task*)> function);
+} // namespace sim
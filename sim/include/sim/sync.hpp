@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sim {
+/**
+ * @brief A mutex managed by the simulator
+ *
+ * Every pros::Mutex created by the program is backed by one of these. Waiting tasks queue by priority, then in the
+ * order they started waiting, and the owner inherits the priority of the highest priority waiter, like a FreeRTOS
+ * mutex.
+ */
+struct Lock;
+
+/**
+ * @brief How much a mutex has been fought over
+ */
+struct LockStats {
+        // name of the lock, in creation order
+        std::string name;
+        // names of every task that has taken the lock
+        std::vector<std::string> users;
+        uint32_t takes = 0;
+        // takes that had to wait for another task to give the lock back
+        uint32_t contended = 0;
+        // takes that gave up before they got the lock
+        uint32_t timeouts = 0;
+        // time spent waiting for the lock, in microseconds
+        uint64_t waitTime = 0;
+        uint64_t maxWait = 0;
+};
+
+/**
+ * @brief Create a new lock
+ */
+Lock* createLock();
+
+/**
+ * @brief Delete a lock. Its statistics are kept
+ */
+void deleteLock(Lock* lock);
+
+/**
+ * @brief Take a lock, waiting for it if another task holds it
+ *
+ * Taking a lock the running task already holds succeeds immediately.
+ *
+ * @param lock the lock
+ * @param deadline time to give up, in microseconds. UINT64_MAX waits forever
+ * @return true the lock was taken
+ * @return false the deadline passed first
+ */
+bool takeLock(Lock* lock, uint64_t deadline);
+
+/**
+ * @brief Give a lock back, handing it to the first task waiting for it
+ *
+ * @return true the lock was given back
+ * @return false the running task does not hold the lock
+ */
+bool giveLock(Lock* lock);
+
+/**
+ * @brief Call a function with the statistics of every lock that has been created
+ */
+void forEachLock(std::function<void(const LockStats&)> function);
+} // namespace sim
@@ -0,0 +1,144 @@
+#include <cmath>
+#include <memory>
+#include "sim/devices.hpp"
+#include "sim/random.hpp"
+#include "sim/scheduler.hpp"
+
+namespace sim {
+namespace {
+struct Registry {
+        // one extra slot so the registries can be indexed by port number directly
+        Motor motors[22];
+        RotationSensor rotations[22];
+        InertialSensor imus[22];
+        DistanceSensor distances[22];
+        AdiPort adiPorts[9];
+        ControllerState controllers[2];
+        BatteryState batteryState;
+        CompetitionState competitionState;
+        std::string screen[8];
+        std::unique_ptr<DifferentialDrive> plant;
+};
+
+/**
+ * @brief Get every simulated device
+ *
+ * The registry is created on first use, since the robot code constructs its devices from static initializers that
+ * may run before this file's. It is intentionally leaked, like the scheduler state.
+ */
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+uint8_t checkPort(uint8_t port) { return port > 21 ? 0 : port; }
+
+void sampleRotation(RotationSensor& sensor, uint32_t time) {
+    if (!sensor.connected || !sensor.source || time - sensor.lastSample < sensor.dataRate) return;
+    const double dt = (time - sensor.lastSample) / 1000.0;
+    sensor.lastSample = time;
+    const double previous = sensor.raw;
+    sensor.raw = (sensor.reversed ? -sensor.source() : sensor.source()) + gaussian(sensor.noise);
+    sensor.velocity = std::lround((sensor.raw - previous) / dt);
+    sensor.position = std::lround(sensor.raw - sensor.zero);
+    sensor.angle = std::lround(std::fmod(std::fmod(sensor.raw, 36000) + 36000, 36000)) % 36000;
+}
+
+void stepImu(InertialSensor& sensor, uint32_t time, float dt) {
+    if (!sensor.connected) return;
+    const std::unique_ptr<DifferentialDrive>& plant = registry().plant;
+    const double heading = plant ? plant->getPose().theta * 180 / M_PI : 0;
+    const double delta = heading - sensor.lastHeading;
+    sensor.lastHeading = heading;
+    sensor.bias += gaussian(sensor.biasWalk * std::sqrt(dt));
+    if (sensor.calibrating) {
+        if (time >= sensor.calibrationEnd) {
+            sensor.calibrating = false;
+            // calibration measures the bias while the robot sits still, with some error of its own
+            sensor.calibratedBias = sensor.bias + gaussian(sensor.rateNoise / 10);
+            sensor.rotation = 0;
+        }
+        return;
+    }
+    const double rate = delta / dt * (1 + sensor.scaleError) + sensor.bias - sensor.calibratedBias;
+    sensor.rotation += (rate + gaussian(sensor.rateNoise)) * dt;
+    if (time - sensor.lastSample < sensor.dataRate) return;
+    sensor.lastSample = time;
+    sensor.rate = rate + gaussian(sensor.rateNoise);
+    if (plant) {
+        sensor.accelX = plant->lateralAcceleration * 0.0254 / 9.81 + gaussian(sensor.accelNoise);
+        sensor.accelY = plant->acceleration * 0.0254 / 9.81 + gaussian(sensor.accelNoise);
+    }
+}
+
+void sampleDistance(DistanceSensor& sensor, uint32_t time) {
+    if (!sensor.connected || !sensor.source || time - sensor.lastSample < sensor.dataRate) return;
+    sensor.lastSample = time;
+    DistanceReading reading = sensor.source();
+    if (reading.distance < 9999) {
+        reading.distance = std::lround(reading.distance * (1 + gaussian(sensor.noise)));
+        if (reading.distance < 0) reading.distance = 0;
+    }
+    sensor.reading = reading;
+}
+
+void tick(uint32_t time) {
+    constexpr float dt = 0.001;
+    Registry& devices = registry();
+    // the battery sags with the current drawn in the last tick
+    float current = 0;
+    for (auto& motor : devices.motors) current += motor.current / 1000;
+    devices.batteryState.current = current;
+    devices.batteryState.voltage = devices.batteryState.nominal - devices.batteryState.resistance * current;
+
+    for (auto& controller : devices.controllers)
+        if (controller.script) controller.script(controller, time);
+    for (auto& motor : devices.motors)
+        if (motor.connected) motor.updateVoltage(time, devices.batteryState.voltage);
+    if (devices.plant) devices.plant->step(dt);
+    for (uint8_t port = 1; port <= 21; port++) {
+        if (!devices.motors[port].connected || (devices.plant && devices.plant->usesPort(port))) continue;
+        devices.motors[port].stepFree(dt);
+    }
+    for (auto& sensor : devices.rotations) sampleRotation(sensor, time);
+    for (auto& sensor : devices.imus) stepImu(sensor, time, dt);
+    for (auto& sensor : devices.distances) sampleDistance(sensor, time);
+}
+} // namespace
+
+Motor& motor(uint8_t port) { return registry().motors[checkPort(port)]; }
+
+RotationSensor& rotation(uint8_t port) { return registry().rotations[checkPort(port)]; }
+
+InertialSensor& imu(uint8_t port) { return registry().imus[checkPort(port)]; }
+
+DistanceSensor& distance(uint8_t port) { return registry().distances[checkPort(port)]; }
+
+AdiPort& adi(uint8_t port) {
+    if (port >= 'a' && port <= 'h') port -= 'a' - 1;
+    if (port >= 'A' && port <= 'H') port -= 'A' - 1;
+    return registry().adiPorts[port > 8 ? 0 : port];
+}
+
+ControllerState& controller(uint8_t id) { return registry().controllers[id > 1 ? 0 : id]; }
+
+BatteryState& battery() { return registry().batteryState; }
+
+CompetitionState& competition() { return registry().competitionState; }
+
+std::string& screenLine(uint8_t line) { return registry().screen[line > 7 ? 7 : line]; }
+
+void setDrivetrain(const DrivetrainModel& model) {
+    registry().plant = std::make_unique<DifferentialDrive>(model);
+    for (int8_t port : model.leftPorts) motor(std::abs(port)).setCartridge(model.cartridge);
+    for (int8_t port : model.rightPorts) motor(std::abs(port)).setCartridge(model.cartridge);
+}
+
+DifferentialDrive& drivetrain() {
+    std::unique_ptr<DifferentialDrive>& plant = registry().plant;
+    if (!plant) plant = std::make_unique<DifferentialDrive>(DrivetrainModel());
+    return *plant;
+}
+
+void startDevices() { onTick(tick); }
+} // namespace sim
@@ -0,0 +1,32 @@
+#include <algorithm>
+#include "pros/rtos.h"
+#include "sim/match.hpp"
+#include "sim/scheduler.hpp"
+
+namespace sim {
+namespace {
+struct Period {
+        void (*function)();
+        uint64_t end = 0;
+};
+} // namespace
+
+PeriodResult runPeriod(void (*function)(), const char* name, double seconds) {
+    Period period {function};
+    const uint64_t start = micros();
+    Task* task = spawn(
+        [](void* parameters) {
+            Period* period = static_cast<Period*>(parameters);
+            period->function();
+            period->end = micros();
+        },
+        &period, TASK_PRIORITY_DEFAULT, name);
+    const uint64_t end = seconds < 0 ? UINT64_MAX : start + uint64_t(seconds * 1e6);
+    while (!isDead(task) && micros() < end) run(std::min(end, micros() + 10000));
+    PeriodResult result;
+    result.finished = isDead(task);
+    if (!result.finished) kill(task);
+    result.duration = (result.finished ? period.end : micros()) - start;
+    return result;
+}
+} // namespace sim
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cmath>
+#include "sim/motor.hpp"
+
+namespace sim {
+namespace {
+// stall current of the V5 motor, in milliamps. The motor firmware limits current to this
+constexpr float STALL_CURRENT = 2500;
+// gain of the motor's internal velocity controller
+constexpr float VELOCITY_KP = 5;
+// gain of the motor's internal position controller, in rpm per degree
+constexpr float POSITION_KP = 2;
+// friction of the motor gearbox, in N*m at the output shaft
+constexpr float GEARBOX_FRICTION = 0.1;
+} // namespace
+
+float Motor::stallTorque() const { return 2.1f * 100 / freeSpeed; }
+
+void Motor::setCartridge(float freeSpeed) { this->freeSpeed = freeSpeed; }
+
+void Motor::setCommandDelay(uint32_t ms) { commandDelay = ms; }
+
+void Motor::setLoad(float inertia, float damping) {
+    loadInertia = inertia;
+    loadDamping = damping;
+}
+
+void Motor::setZero(float newPosition) { offset = rawPosition - newPosition; }
+
+float Motor::getPosition() const { return rawPosition - offset; }
+
+void Motor::command(Mode mode, float target, float velocityLimit) {
+    connected = true;
+    // the latency is measured from the first command that has not reached the motor yet, so a loop that commands
+    // the motor faster than the latency still gets through
+    if (!hasPending) pendingTime = lastTime + commandDelay;
+    pending = {mode, target, velocityLimit};
+    hasPending = true;
+    if (mode == Mode::VELOCITY) targetVelocity = target;
+    if (mode == Mode::POSITION) targetPosition = target;
+}
+
+void Motor::updateVoltage(uint32_t time, float batteryVoltage) {
+    lastTime = time;
+    if (hasPending && time >= pendingTime) {
+        if (pending.mode == Mode::BRAKE && active.mode != Mode::BRAKE) holdPosition = rawPosition;
+        active = pending;
+        hasPending = false;
+    }
+    auto velocityControl = [this](float target) {
+        return 12 * (target + VELOCITY_KP * (target - velocity)) / freeSpeed;
+    };
+    float requested = 0;
+    coasting = false;
+    switch (active.mode) {
+        case Mode::VOLTAGE: requested = active.target / 1000; break;
+        case Mode::VELOCITY: requested = velocityControl(active.target); break;
+        case Mode::POSITION: {
+            const float limit = active.velocityLimit > 0 ? active.velocityLimit : freeSpeed;
+            const float error = active.target - getPosition();
+            requested = velocityControl(std::clamp(error * POSITION_KP, -limit, limit));
+            break;
+        }
+        case Mode::BRAKE:
+            if (brakeMode == Brake::HOLD) {
+                requested = velocityControl(std::clamp((holdPosition - rawPosition) * POSITION_KP, -freeSpeed, freeSpeed));
+            } else {
+                coasting = brakeMode == Brake::COAST;
+            }
+            break;
+    }
+    const float limit = std::min(12.0f, voltageLimit / 1000);
+    requested = std::clamp(requested, -limit, limit);
+    // the motor switches the battery, so the voltage it applies sags with the battery
+    voltage = requested / 12 * batteryVoltage;
+}
+
+float Motor::torqueAt(float speed) const {
+    if (coasting || !connected) return 0;
+    const float maxTorque = stallTorque() * std::min(currentLimit, STALL_CURRENT) / STALL_CURRENT;
+    const float output = stallTorque() * (voltage - 12 * speed / freeSpeed) / 12;
+    return std::clamp(output, -maxTorque, maxTorque);
+}
+
+void Motor::drive(float speed, float dt) {
+    velocity = speed;
+    rawPosition += speed * 6 * dt;
+    torque = torqueAt(speed);
+    current = std::fabs(torque) / stallTorque() * STALL_CURRENT;
+    // first order thermal model. A stalled motor heats up by roughly 1 degree every 2 seconds
+    temperature += (current * current / (STALL_CURRENT * STALL_CURRENT) * 0.5f - (temperature - 25) * 0.005f) * dt;
+}
+
+void Motor::stepFree(float dt) {
+    // convert the net torque to an acceleration in rpm per second
+    const float net = torqueAt(velocity) - loadDamping * velocity;
+    const float acceleration = net / loadInertia * 60 / (2 * M_PI);
+    float speed = velocity + acceleration * dt;
+    // gearbox friction opposes motion, but never reverses it
+    const float friction = GEARBOX_FRICTION / loadInertia * 60 / (2 * M_PI) * dt;
+    if (std::fabs(speed) <= friction) speed = 0;
+    else speed -= std::copysign(friction, speed);
+    drive(speed, dt);
+}
+} // namespace sim
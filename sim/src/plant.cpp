@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <cmath>
+#include "sim/plant.hpp"
+#include "sim/devices.hpp"
+
+namespace sim {
+namespace {
+constexpr double METERS_PER_INCH = 0.0254;
+constexpr double GRAVITY = 9.81;
+
+double sign(double x) { return (x > 0) - (x < 0); }
+
+// stall torque of one motor, in N*m at the cartridge output. Matches sim::Motor
+double stallTorque(const DrivetrainModel& model) { return 2.1 * 100 / model.cartridge; }
+
+// volts it takes to push one side of the drivetrain with a force of 1 N
+double voltsPerNewton(const DrivetrainModel& model) {
+    const double radius = model.wheelDiameter / 2 * METERS_PER_INCH;
+    return 12 * model.gearRatio * radius / (model.leftPorts.size() * stallTorque(model));
+}
+} // namespace
+
+// the motors give torque = stall torque * (voltage - 12 * speed / free speed) / 12, so each side needs
+// 12 * speed / free speed volts to keep up with the floor, plus voltsPerNewton for every N it pushes with
+DriveCharacterization expectedCharacterization(const DrivetrainModel& model) {
+    const double perNewton = voltsPerNewton(model);
+    const double radiansPerDegree = M_PI / 180;
+    DriveCharacterization characterization;
+    Feedforward& linear = characterization.linear;
+    linear.kV = 12 * 60 / (M_PI * model.wheelDiameter * model.gearRatio * model.cartridge);
+    linear.kA = perNewton * model.mass * METERS_PER_INCH / 2;
+    linear.kS = perNewton * model.rollingResistance;
+    // turning in place, each side pushes with half of the torque over half of the track width
+    Feedforward& angular = characterization.angular;
+    angular.kV = linear.kV * radiansPerDegree * model.trackWidth / 2;
+    angular.kA = perNewton * model.inertia * radiansPerDegree / (model.trackWidth * METERS_PER_INCH);
+    return characterization;
+}
+
+void applyCharacterization(DrivetrainModel& model, const DriveCharacterization& characterization) {
+    const double perNewton = voltsPerNewton(model);
+    model.mass = characterization.linear.kA * 2 / (perNewton * METERS_PER_INCH);
+    model.rollingResistance = characterization.linear.kS / perNewton;
+    model.inertia = characterization.angular.kA * model.trackWidth * METERS_PER_INCH / (perNewton * M_PI / 180);
+}
+
+DifferentialDrive::DifferentialDrive(const DrivetrainModel& model)
+    : model(model) {
+    left.ports = model.leftPorts;
+    right.ports = model.rightPorts;
+}
+
+bool DifferentialDrive::usesPort(uint8_t port) const {
+    for (int8_t p : model.leftPorts)
+        if (std::abs(p) == port) return true;
+    for (int8_t p : model.rightPorts)
+        if (std::abs(p) == port) return true;
+    return false;
+}
+
+float DifferentialDrive::stepSide(Side& side, double floorSpeed, float dt, bool& slipping) {
+    const double radius = model.wheelDiameter / 2 * METERS_PER_INCH;
+    // force one side can put into the floor before its wheels break traction
+    const double maxForce = model.traction * model.mass * GRAVITY / 2;
+    auto motorForce = [&](double wheelSpeed) {
+        const double motorRpm = wheelSpeed / (M_PI * model.wheelDiameter) * 60 / model.gearRatio;
+        double force = 0;
+        for (int8_t port : side.ports) {
+            const double direction = sign(port);
+            const float torque = motor(std::abs(port)).torqueAt(direction * motorRpm);
+            force += direction * torque / model.gearRatio / radius;
+        }
+        return force;
+    };
+    auto driveMotors = [&](double wheelSpeed) {
+        const double motorRpm = wheelSpeed / (M_PI * model.wheelDiameter) * 60 / model.gearRatio;
+        for (int8_t port : side.ports) motor(std::abs(port)).drive(sign(port) * motorRpm, dt);
+    };
+
+    if (!slipping) {
+        const double force = motorForce(floorSpeed);
+        if (std::fabs(force) <= maxForce) {
+            side.wheelSpeed = floorSpeed;
+            driveMotors(floorSpeed);
+            return force;
+        }
+        slipping = true;
+        side.wheelSpeed = floorSpeed;
+    }
+
+    // the wheels spin relative to the floor. Kinetic friction opposes the slip and is what moves the robot
+    const double force = motorForce(side.wheelSpeed);
+    const double slip = side.wheelSpeed - floorSpeed;
+    const double friction = slip != 0 ? maxForce * sign(slip) : std::clamp(force, -maxForce, maxForce);
+    const double previousSlip = slip;
+    side.wheelSpeed += (force - friction) / model.sideMass / METERS_PER_INCH * dt;
+    const double newSlip = side.wheelSpeed - floorSpeed;
+    // the wheels regain traction once the slip reverses or dies out and the motors can no longer overpower the floor
+    if ((sign(newSlip) != sign(previousSlip) || std::fabs(newSlip) < 0.05) && std::fabs(force) <= maxForce) {
+        slipping = false;
+        side.wheelSpeed = floorSpeed;
+    }
+    driveMotors(side.wheelSpeed);
+    return friction;
+}
+
+void DifferentialDrive::step(float dt) {
+    const double halfWidth = model.trackWidth / 2;
+    // speed of the floor under each side of the drivetrain
+    const double leftFloor = velocity + angularVelocity * halfWidth;
+    const double rightFloor = velocity - angularVelocity * halfWidth;
+    const double leftForce = stepSide(left, leftFloor, dt, leftSlipping);
+    const double rightForce = stepSide(right, rightFloor, dt, rightSlipping);
+
+    float forwardPush = 0;
+    float rightPush = 0;
+    if (pushTime > 0) {
+        forwardPush = pushForward;
+        rightPush = pushRight;
+        pushTime -= dt;
+    }
+
+    // rolling resistance fades in around 0 so the robot can come to rest
+    const double rolling = 2 * model.rollingResistance * std::tanh(velocity);
+    const double forwardForce = leftForce + rightForce + forwardPush - rolling;
+    acceleration = forwardForce / model.mass / METERS_PER_INCH;
+
+    // the wheels resist sliding sideways until the push is stronger than traction
+    const double maxLateral = model.traction * model.mass * GRAVITY;
+    const double holding = model.mass * lateralVelocity * METERS_PER_INCH / dt + rightPush;
+    const double lateralForce = rightPush - std::clamp(holding, -maxLateral, maxLateral);
+    lateralAcceleration = lateralForce / model.mass / METERS_PER_INCH;
+
+    const double torque = (leftForce - rightForce) * halfWidth * METERS_PER_INCH;
+    const double angularAcceleration = torque / model.inertia;
+
+    const double oldTheta = pose.theta;
+    velocity += acceleration * dt;
+    lateralVelocity += lateralAcceleration * dt;
+    angularVelocity += angularAcceleration * dt;
+
+    // integrate with the heading at the middle of the step
+    pose.theta += angularVelocity * dt;
+    const double theta = (oldTheta + pose.theta) / 2;
+    pose.x += (velocity * std::sin(theta) + lateralVelocity * std::cos(theta)) * dt;
+    pose.y += (velocity * std::cos(theta) - lateralVelocity * std::sin(theta)) * dt;
+
+    forwardTravel += velocity * dt;
+    lateralTravel += lateralVelocity * dt;
+    headingTravel += angularVelocity * dt;
+}
+
+PlantPose DifferentialDrive::getPose() const { return pose; }
+
+const DrivetrainModel& DifferentialDrive::getModel() const { return model; }
+
+void DifferentialDrive::setPose(PlantPose pose) { this->pose = pose; }
+
+double DifferentialDrive::trackingDistance(double offset, bool horizontal) const {
+    if (horizontal) return lateralTravel + headingTravel * offset;
+    return forwardTravel - headingTravel * offset;
+}
+
+void DifferentialDrive::push(float forward, float right, float duration) {
+    pushForward = forward;
+    pushRight = right;
+    pushTime = duration;
+}
+} // namespace sim
@@ -0,0 +1,161 @@
+#include <cerrno>
+#include <cmath>
+#include "pros/adi.h"
+#include "pros/adi.hpp"
+#include "pros/error.h"
+#include "sim/devices.hpp"
+#include "sim/scheduler.hpp"
+
+// host implementation of the PROS 3-wire API. Only the brain's own ports are simulated, not 3-wire expanders
+
+namespace {
+sim::AdiPort* getPort(uint8_t port) {
+    sim::charge();
+    if (port >= 'a' && port <= 'h') port -= 'a' - 1;
+    if (port >= 'A' && port <= 'H') port -= 'A' - 1;
+    if (port < 1 || port > 8) {
+        errno = ENXIO;
+        return nullptr;
+    }
+    return &sim::adi(port);
+}
+
+int32_t read(const sim::AdiPort& port) { return port.source ? port.source() : port.value; }
+} // namespace
+
+namespace pros::c {
+adi_port_config_e_t adi_port_get_config(uint8_t port) {
+    sim::AdiPort* p = getPort(port);
+    if (p == nullptr) return E_ADI_ERR;
+    return static_cast<adi_port_config_e_t>(p->config);
+}
+
+int32_t adi_port_get_value(uint8_t port) {
+    sim::AdiPort* p = getPort(port);
+    if (p == nullptr) return PROS_ERR;
+    return read(*p);
+}
+
+int32_t adi_port_set_config(uint8_t port, adi_port_config_e_t type) {
+    sim::AdiPort* p = getPort(port);
+    if (p == nullptr) return PROS_ERR;
+    p->config = type;
+    return 1;
+}
+
+int32_t adi_port_set_value(uint8_t port, int32_t value) {
+    sim::AdiPort* p = getPort(port);
+    if (p == nullptr) return PROS_ERR;
+    p->value = value;
+    return 1;
+}
+
+int32_t adi_digital_read(uint8_t port) {
+    sim::AdiPort* p = getPort(port);
+    if (p == nullptr) return PROS_ERR;
+    return read(*p) != 0;
+}
+
+int32_t adi_digital_get_new_press(uint8_t port) {
+    sim::AdiPort* p = getPort(port);
+    if (p == nullptr) return PROS_ERR;
+    const bool pressed = read(*p) != 0;
+    const bool newPress = pressed && !p->lastPressed;
+    p->lastPressed = pressed;
+    return newPress;
+}
+
+int32_t adi_digital_write(uint8_t port, bool value) { return adi_port_set_value(port, value); }
+
+adi_encoder_t adi_encoder_init(uint8_t port_top, uint8_t port_bottom, bool reverse) {
+    sim::AdiPort* p = getPort(port_top);
+    if (p == nullptr || getPort(port_bottom) == nullptr) return PROS_ERR;
+    p->config = E_ADI_LEGACY_ENCODER;
+    p->zero = read(*p);
+    // the handle stores the top port and the direction, like the kernel's does
+    return reverse ? -(port_top & 0x7F) : (port_top & 0x7F);
+}
+
+int32_t adi_encoder_get(adi_encoder_t enc) {
+    sim::AdiPort* p = getPort(std::abs(enc));
+    if (p == nullptr) return PROS_ERR;
+    const int32_t value = read(*p) - p->zero;
+    return enc < 0 ? -value : value;
+}
+
+int32_t adi_encoder_reset(adi_encoder_t enc) {
+    sim::AdiPort* p = getPort(std::abs(enc));
+    if (p == nullptr) return PROS_ERR;
+    p->zero = read(*p);
+    return 1;
+}
+
+int32_t adi_encoder_shutdown(adi_encoder_t enc) {
+    sim::AdiPort* p = getPort(std::abs(enc));
+    if (p == nullptr) return PROS_ERR;
+    p->config = E_ADI_TYPE_UNDEFINED;
+    return 1;
+}
+} // namespace pros::c
+
+namespace pros::adi {
+Port::Port(std::uint8_t adi_port, adi_port_config_e_t type)
+    : _smart_port(INTERNAL_ADI_PORT),
+      _adi_port(adi_port) {
+    c::adi_port_set_config(_adi_port, type);
+}
+
+Port::Port(ext_adi_port_pair_t port_pair, adi_port_config_e_t type)
+    : _smart_port(port_pair.first),
+      _adi_port(port_pair.second) {
+    c::adi_port_set_config(_adi_port, type);
+}
+
+std::int32_t Port::get_config() const { return c::adi_port_get_config(_adi_port); }
+
+std::int32_t Port::get_value() const { return c::adi_port_get_value(_adi_port); }
+
+std::int32_t Port::set_config(adi_port_config_e_t type) const { return c::adi_port_set_config(_adi_port, type); }
+
+std::int32_t Port::set_value(std::int32_t value) const { return c::adi_port_set_value(_adi_port, value); }
+
+ext_adi_port_tuple_t Port::get_port() const { return {_smart_port, _adi_port, PROS_ERR_BYTE}; }
+
+DigitalOut::DigitalOut(std::uint8_t adi_port, bool init_state)
+    : Port(adi_port, E_ADI_DIGITAL_OUT) {
+    set_value(init_state);
+}
+
+DigitalOut::DigitalOut(ext_adi_port_pair_t port_pair, bool init_state)
+    : Port(port_pair, E_ADI_DIGITAL_OUT) {
+    set_value(init_state);
+}
+
+DigitalIn::DigitalIn(std::uint8_t adi_port)
+    : Port(adi_port, E_ADI_DIGITAL_IN) {}
+
+DigitalIn::DigitalIn(ext_adi_port_pair_t port_pair)
+    : Port(port_pair, E_ADI_DIGITAL_IN) {}
+
+std::int32_t DigitalIn::get_new_press() const { return c::adi_digital_get_new_press(_adi_port); }
+
+Encoder::Encoder(std::uint8_t adi_port_top, std::uint8_t adi_port_bottom, bool reversed)
+    : Port(adi_port_top),
+      _port_pair(adi_port_top, adi_port_bottom) {
+    const c::adi_encoder_t encoder = c::adi_encoder_init(adi_port_top, adi_port_bottom, reversed);
+    // remember the direction in the smart port field, which is unused for encoders on the brain
+    _smart_port = encoder < 0 ? 0 : INTERNAL_ADI_PORT;
+}
+
+std::int32_t Encoder::reset() const { return c::adi_encoder_reset(_adi_port); }
+
+std::int32_t Encoder::get_value() const {
+    const std::int32_t value = c::adi_encoder_get(_adi_port);
+    if (value == PROS_ERR) return PROS_ERR;
+    return _smart_port == 0 ? -value : value;
+}
+
+ext_adi_port_tuple_t Encoder::get_port() const {
+    return {INTERNAL_ADI_PORT, _port_pair.first, _port_pair.second};
+}
+} // namespace pros::adi
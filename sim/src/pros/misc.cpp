@@ -0,0 +1,230 @@
+#include <cerrno>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include "pros/error.h"
+#include "pros/llemu.hpp"
+#include "pros/misc.hpp"
+#include "sim/devices.hpp"
+#include "sim/scheduler.hpp"
+
+// host implementation of the controller, battery, competition and LLEMU APIs
+
+namespace {
+bool lcdInitialized = false;
+
+sim::ControllerState* getController(pros::controller_id_e_t id) {
+    sim::charge();
+    if (id != pros::E_CONTROLLER_MASTER && id != pros::E_CONTROLLER_PARTNER) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return &sim::controller(id);
+}
+
+bool setLine(int16_t line, const char* text) {
+    if (!lcdInitialized) {
+        errno = ENXIO;
+        return false;
+    }
+    if (line < 0 || line > 7) {
+        errno = EINVAL;
+        return false;
+    }
+    sim::screenLine(line) = text;
+    return true;
+}
+} // namespace
+
+namespace pros::c {
+uint8_t competition_get_status(void) {
+    const sim::CompetitionState& state = sim::competition();
+    uint8_t status = 0;
+    if (state.disabled) status |= COMPETITION_DISABLED;
+    if (state.autonomous) status |= COMPETITION_AUTONOMOUS;
+    if (state.connected) status |= COMPETITION_CONNECTED;
+    if (state.field) status |= COMPETITION_SYSTEM;
+    return status;
+}
+
+uint8_t competition_is_disabled(void) { return sim::competition().disabled; }
+
+uint8_t competition_is_connected(void) { return sim::competition().connected; }
+
+uint8_t competition_is_autonomous(void) { return sim::competition().autonomous; }
+
+uint8_t competition_is_field(void) { return sim::competition().field; }
+
+uint8_t competition_is_switch(void) { return sim::competition().connected && !sim::competition().field; }
+
+int32_t controller_is_connected(controller_id_e_t id) { return getController(id) == nullptr ? PROS_ERR : 1; }
+
+int32_t controller_get_analog(controller_id_e_t id, controller_analog_e_t channel) {
+    sim::ControllerState* controller = getController(id);
+    if (controller == nullptr) return PROS_ERR;
+    if (channel < E_CONTROLLER_ANALOG_LEFT_X || channel > E_CONTROLLER_ANALOG_RIGHT_Y) {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    return controller->analog[channel];
+}
+
+int32_t controller_get_battery_capacity(controller_id_e_t id) { return getController(id) == nullptr ? PROS_ERR : 100; }
+
+int32_t controller_get_battery_level(controller_id_e_t id) { return getController(id) == nullptr ? PROS_ERR : 100; }
+
+int32_t controller_get_digital(controller_id_e_t id, controller_digital_e_t button) {
+    sim::ControllerState* controller = getController(id);
+    if (controller == nullptr) return PROS_ERR;
+    if (button < E_CONTROLLER_DIGITAL_L1 || button > E_CONTROLLER_DIGITAL_A) {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    return controller->digital[button];
+}
+
+int32_t controller_get_digital_new_press(controller_id_e_t id, controller_digital_e_t button) {
+    const int32_t pressed = controller_get_digital(id, button);
+    if (pressed == PROS_ERR) return PROS_ERR;
+    bool& last = sim::controller(id).lastPressed[button];
+    const bool newPress = pressed && !last;
+    last = pressed;
+    return newPress;
+}
+
+int32_t controller_print(controller_id_e_t id, uint8_t line, uint8_t col, const char* fmt, ...) {
+    return getController(id) == nullptr ? PROS_ERR : 1;
+}
+
+int32_t controller_set_text(controller_id_e_t id, uint8_t line, uint8_t col, const char* str) {
+    return getController(id) == nullptr ? PROS_ERR : 1;
+}
+
+int32_t controller_clear_line(controller_id_e_t id, uint8_t line) {
+    return getController(id) == nullptr ? PROS_ERR : 1;
+}
+
+int32_t controller_clear(controller_id_e_t id) { return getController(id) == nullptr ? PROS_ERR : 1; }
+
+int32_t controller_rumble(controller_id_e_t id, const char* rumble_pattern) {
+    return getController(id) == nullptr ? PROS_ERR : 1;
+}
+
+int32_t battery_get_voltage(void) {
+    sim::charge();
+    return std::lround(sim::battery().voltage * 1000);
+}
+
+int32_t battery_get_current(void) {
+    sim::charge();
+    return std::lround(sim::battery().current * 1000);
+}
+
+double battery_get_temperature(void) { return sim::battery().temperature; }
+
+double battery_get_capacity(void) { return sim::battery().capacity; }
+
+int32_t usd_is_installed(void) { return 0; }
+
+bool lcd_is_initialized(void) { return lcdInitialized; }
+
+bool lcd_initialize(void) {
+    lcdInitialized = true;
+    return true;
+}
+
+bool lcd_shutdown(void) {
+    lcdInitialized = false;
+    return true;
+}
+
+bool lcd_print(int16_t line, const char* fmt, ...) {
+    char buffer[64];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    va_end(args);
+    return setLine(line, buffer);
+}
+
+bool lcd_set_text(int16_t line, const char* text) { return setLine(line, text); }
+
+bool lcd_clear_line(int16_t line) { return setLine(line, ""); }
+
+bool lcd_clear(void) {
+    for (int16_t line = 0; line < 8; line++)
+        if (!setLine(line, "")) return false;
+    return true;
+}
+} // namespace pros::c
+
+namespace pros::v5 {
+Controller::Controller(controller_id_e_t id)
+    : _id(id) {}
+
+std::int32_t Controller::is_connected(void) { return c::controller_is_connected(_id); }
+
+std::int32_t Controller::get_analog(controller_analog_e_t channel) { return c::controller_get_analog(_id, channel); }
+
+std::int32_t Controller::get_battery_capacity(void) { return c::controller_get_battery_capacity(_id); }
+
+std::int32_t Controller::get_battery_level(void) { return c::controller_get_battery_level(_id); }
+
+std::int32_t Controller::get_digital(controller_digital_e_t button) { return c::controller_get_digital(_id, button); }
+
+std::int32_t Controller::get_digital_new_press(controller_digital_e_t button) {
+    return c::controller_get_digital_new_press(_id, button);
+}
+
+std::int32_t Controller::set_text(std::uint8_t line, std::uint8_t col, const char* str) {
+    return c::controller_set_text(_id, line, col, str);
+}
+
+std::int32_t Controller::set_text(std::uint8_t line, std::uint8_t col, const std::string& str) {
+    return c::controller_set_text(_id, line, col, str.c_str());
+}
+
+std::int32_t Controller::clear_line(std::uint8_t line) { return c::controller_clear_line(_id, line); }
+
+std::int32_t Controller::rumble(const char* rumble_pattern) { return c::controller_rumble(_id, rumble_pattern); }
+
+std::int32_t Controller::clear(void) { return c::controller_clear(_id); }
+} // namespace pros::v5
+
+namespace pros::battery {
+double get_capacity(void) { return c::battery_get_capacity(); }
+
+int32_t get_current(void) { return c::battery_get_current(); }
+
+double get_temperature(void) { return c::battery_get_temperature(); }
+
+int32_t get_voltage(void) { return c::battery_get_voltage(); }
+} // namespace pros::battery
+
+namespace pros::competition {
+std::uint8_t get_status(void) { return c::competition_get_status(); }
+
+std::uint8_t is_autonomous(void) { return c::competition_is_autonomous(); }
+
+std::uint8_t is_connected(void) { return c::competition_is_connected(); }
+
+std::uint8_t is_disabled(void) { return c::competition_is_disabled(); }
+
+std::uint8_t is_field_control(void) { return c::competition_is_field(); }
+
+std::uint8_t is_competition_switch(void) { return c::competition_is_switch(); }
+} // namespace pros::competition
+
+namespace pros::lcd {
+bool set_text(std::int16_t line, std::string text) { return c::lcd_set_text(line, text.c_str()); }
+
+bool clear_line(std::int16_t line) { return c::lcd_clear_line(line); }
+
+bool initialize(void) { return c::lcd_initialize(); }
+
+std::uint8_t read_buttons(void) { return 0; }
+
+void register_btn1_cb(lcd_btn_cb_fn_t cb) {}
+
+bool is_initialized(void) { return c::lcd_is_initialized(); }
+} // namespace pros::lcd
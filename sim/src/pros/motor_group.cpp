@@ -0,0 +1,406 @@
+#include <cerrno>
+#include <cmath>
+#include "pros/error.h"
+#include "pros/motor_group.hpp"
+#include "pros/motors.hpp"
+
+// host implementation of pros::MotorGroup. Every call is forwarded to the simulated motors through pros::Motor
+
+namespace pros::v5 {
+namespace {
+template <typename T, typename F> std::vector<T> collect(const std::vector<std::int8_t>& ports, F&& function) {
+    std::vector<T> out;
+    for (std::int8_t port : ports) out.push_back(function(Motor(port)));
+    return out;
+}
+
+template <typename F> std::int32_t forEach(const std::vector<std::int8_t>& ports, F&& function) {
+    if (ports.empty()) {
+        errno = EDOM;
+        return PROS_ERR;
+    }
+    std::int32_t out = 1;
+    for (std::int8_t port : ports)
+        if (function(Motor(port)) == PROS_ERR) out = PROS_ERR;
+    return out;
+}
+} // namespace
+
+MotorGroup::MotorGroup(const std::initializer_list<std::int8_t> ports, const MotorGears gearset,
+                       const MotorUnits encoder_units)
+    : MotorGroup(std::vector<std::int8_t>(ports), gearset, encoder_units) {}
+
+MotorGroup::MotorGroup(const std::vector<std::int8_t>& ports, const MotorGears gearset, const MotorUnits encoder_units)
+    : _ports(ports) {
+    if (gearset != MotorGears::invalid) set_gearing_all(gearset);
+    if (encoder_units != MotorUnits::invalid) set_encoder_units_all(encoder_units);
+}
+
+MotorGroup::MotorGroup(AbstractMotor& motor_group)
+    : _ports(motor_group.get_port_all()) {}
+
+#define PROS_SIM_INDEX_CHECK(error)                                                                                    \
+    if (index >= _ports.size()) {                                                                                      \
+        errno = EOVERFLOW;                                                                                             \
+        return error;                                                                                                  \
+    }
+
+std::int32_t MotorGroup::move(std::int32_t voltage) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.move(voltage); });
+}
+
+std::int32_t MotorGroup::move_absolute(const double position, const std::int32_t velocity) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.move_absolute(position, velocity); });
+}
+
+std::int32_t MotorGroup::move_relative(const double position, const std::int32_t velocity) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.move_relative(position, velocity); });
+}
+
+std::int32_t MotorGroup::move_velocity(const std::int32_t velocity) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.move_velocity(velocity); });
+}
+
+std::int32_t MotorGroup::move_voltage(const std::int32_t voltage) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.move_voltage(voltage); });
+}
+
+std::int32_t MotorGroup::brake(void) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.brake(); });
+}
+
+std::int32_t MotorGroup::modify_profiled_velocity(const std::int32_t velocity) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.modify_profiled_velocity(velocity); });
+}
+
+double MotorGroup::get_target_position(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR_F)
+    return Motor(_ports[index]).get_target_position();
+}
+
+std::int32_t MotorGroup::get_target_velocity(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).get_target_velocity();
+}
+
+double MotorGroup::get_actual_velocity(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR_F)
+    return Motor(_ports[index]).get_actual_velocity();
+}
+
+std::int32_t MotorGroup::get_current_draw(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).get_current_draw();
+}
+
+std::int32_t MotorGroup::get_direction(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).get_direction();
+}
+
+double MotorGroup::get_efficiency(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR_F)
+    return Motor(_ports[index]).get_efficiency();
+}
+
+std::uint32_t MotorGroup::get_faults(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).get_faults();
+}
+
+std::uint32_t MotorGroup::get_flags(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).get_flags();
+}
+
+double MotorGroup::get_position(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR_F)
+    return Motor(_ports[index]).get_position();
+}
+
+double MotorGroup::get_power(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR_F)
+    return Motor(_ports[index]).get_power();
+}
+
+std::int32_t MotorGroup::get_raw_position(std::uint32_t* const timestamp, const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).get_raw_position(timestamp);
+}
+
+double MotorGroup::get_temperature(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR_F)
+    return Motor(_ports[index]).get_temperature();
+}
+
+double MotorGroup::get_torque(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR_F)
+    return Motor(_ports[index]).get_torque();
+}
+
+std::int32_t MotorGroup::get_voltage(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).get_voltage();
+}
+
+std::int32_t MotorGroup::is_over_current(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).is_over_current();
+}
+
+std::int32_t MotorGroup::is_over_temp(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).is_over_temp();
+}
+
+MotorBrake MotorGroup::get_brake_mode(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(MotorBrake::invalid)
+    return Motor(_ports[index]).get_brake_mode();
+}
+
+std::int32_t MotorGroup::get_current_limit(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).get_current_limit();
+}
+
+MotorUnits MotorGroup::get_encoder_units(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(MotorUnits::invalid)
+    return Motor(_ports[index]).get_encoder_units();
+}
+
+MotorGears MotorGroup::get_gearing(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(MotorGears::invalid)
+    return Motor(_ports[index]).get_gearing();
+}
+
+std::int32_t MotorGroup::get_voltage_limit(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).get_voltage_limit();
+}
+
+std::int32_t MotorGroup::is_reversed(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return _ports[index] < 0;
+}
+
+std::int32_t MotorGroup::set_brake_mode(const MotorBrake mode, const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).set_brake_mode(mode);
+}
+
+std::int32_t MotorGroup::set_brake_mode(const pros::motor_brake_mode_e_t mode, const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).set_brake_mode(mode);
+}
+
+std::int32_t MotorGroup::set_current_limit(const std::int32_t limit, const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).set_current_limit(limit);
+}
+
+std::int32_t MotorGroup::set_encoder_units(const MotorUnits units, const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).set_encoder_units(units);
+}
+
+std::int32_t MotorGroup::set_encoder_units(const pros::motor_encoder_units_e_t units, const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).set_encoder_units(units);
+}
+
+std::int32_t MotorGroup::set_gearing(std::vector<pros::motor_gearset_e_t> gearsets) const {
+    for (std::size_t i = 0; i < gearsets.size() && i < _ports.size(); i++) Motor(_ports[i]).set_gearing(gearsets[i]);
+    return 1;
+}
+
+std::int32_t MotorGroup::set_gearing(const pros::motor_gearset_e_t gearset, const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).set_gearing(gearset);
+}
+
+std::int32_t MotorGroup::set_gearing(std::vector<MotorGears> gearsets) const {
+    for (std::size_t i = 0; i < gearsets.size() && i < _ports.size(); i++) Motor(_ports[i]).set_gearing(gearsets[i]);
+    return 1;
+}
+
+std::int32_t MotorGroup::set_gearing(const MotorGears gearset, const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).set_gearing(gearset);
+}
+
+std::int32_t MotorGroup::set_reversed(const bool reverse, const std::uint8_t index) {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    _ports[index] = reverse ? -std::abs(_ports[index]) : std::abs(_ports[index]);
+    return 1;
+}
+
+std::int32_t MotorGroup::set_voltage_limit(const std::int32_t limit, const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).set_voltage_limit(limit);
+}
+
+std::int32_t MotorGroup::set_zero_position(const double position, const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).set_zero_position(position);
+}
+
+std::int32_t MotorGroup::tare_position(const std::uint8_t index) const {
+    PROS_SIM_INDEX_CHECK(PROS_ERR)
+    return Motor(_ports[index]).tare_position();
+}
+
+#undef PROS_SIM_INDEX_CHECK
+
+std::int8_t MotorGroup::size(void) const { return _ports.size(); }
+
+std::int8_t MotorGroup::get_port(const std::uint8_t index) const {
+    if (index >= _ports.size()) {
+        errno = EOVERFLOW;
+        return PROS_ERR_BYTE;
+    }
+    return _ports[index];
+}
+
+void MotorGroup::operator+=(AbstractMotor& other) { append(other); }
+
+void MotorGroup::append(AbstractMotor& other) {
+    for (std::int8_t port : other.get_port_all()) _ports.push_back(port);
+}
+
+void MotorGroup::erase_port(std::int8_t port) { std::erase(_ports, port); }
+
+std::vector<double> MotorGroup::get_target_position_all(void) const {
+    return collect<double>(_ports, [](const Motor& motor) { return motor.get_target_position(); });
+}
+
+std::vector<std::int32_t> MotorGroup::get_target_velocity_all(void) const {
+    return collect<std::int32_t>(_ports, [](const Motor& motor) { return motor.get_target_velocity(); });
+}
+
+std::vector<double> MotorGroup::get_actual_velocity_all(void) const {
+    return collect<double>(_ports, [](const Motor& motor) { return motor.get_actual_velocity(); });
+}
+
+std::vector<std::int32_t> MotorGroup::get_current_draw_all(void) const {
+    return collect<std::int32_t>(_ports, [](const Motor& motor) { return motor.get_current_draw(); });
+}
+
+std::vector<std::int32_t> MotorGroup::get_direction_all(void) const {
+    return collect<std::int32_t>(_ports, [](const Motor& motor) { return motor.get_direction(); });
+}
+
+std::vector<double> MotorGroup::get_efficiency_all(void) const {
+    return collect<double>(_ports, [](const Motor& motor) { return motor.get_efficiency(); });
+}
+
+std::vector<std::uint32_t> MotorGroup::get_faults_all(void) const {
+    return collect<std::uint32_t>(_ports, [](const Motor& motor) { return motor.get_faults(); });
+}
+
+std::vector<std::uint32_t> MotorGroup::get_flags_all(void) const {
+    return collect<std::uint32_t>(_ports, [](const Motor& motor) { return motor.get_flags(); });
+}
+
+std::vector<double> MotorGroup::get_position_all(void) const {
+    return collect<double>(_ports, [](const Motor& motor) { return motor.get_position(); });
+}
+
+std::vector<double> MotorGroup::get_power_all(void) const {
+    return collect<double>(_ports, [](const Motor& motor) { return motor.get_power(); });
+}
+
+std::vector<std::int32_t> MotorGroup::get_raw_position_all(std::uint32_t* const timestamp) const {
+    return collect<std::int32_t>(_ports, [&](const Motor& motor) { return motor.get_raw_position(timestamp); });
+}
+
+std::vector<double> MotorGroup::get_temperature_all(void) const {
+    return collect<double>(_ports, [](const Motor& motor) { return motor.get_temperature(); });
+}
+
+std::vector<double> MotorGroup::get_torque_all(void) const {
+    return collect<double>(_ports, [](const Motor& motor) { return motor.get_torque(); });
+}
+
+std::vector<std::int32_t> MotorGroup::get_voltage_all(void) const {
+    return collect<std::int32_t>(_ports, [](const Motor& motor) { return motor.get_voltage(); });
+}
+
+std::vector<std::int32_t> MotorGroup::is_over_current_all(void) const {
+    return collect<std::int32_t>(_ports, [](const Motor& motor) { return motor.is_over_current(); });
+}
+
+std::vector<std::int32_t> MotorGroup::is_over_temp_all(void) const {
+    return collect<std::int32_t>(_ports, [](const Motor& motor) { return motor.is_over_temp(); });
+}
+
+std::vector<MotorBrake> MotorGroup::get_brake_mode_all(void) const {
+    return collect<MotorBrake>(_ports, [](const Motor& motor) { return motor.get_brake_mode(); });
+}
+
+std::vector<std::int32_t> MotorGroup::get_current_limit_all(void) const {
+    return collect<std::int32_t>(_ports, [](const Motor& motor) { return motor.get_current_limit(); });
+}
+
+std::vector<MotorUnits> MotorGroup::get_encoder_units_all(void) const {
+    return collect<MotorUnits>(_ports, [](const Motor& motor) { return motor.get_encoder_units(); });
+}
+
+std::vector<MotorGears> MotorGroup::get_gearing_all(void) const {
+    return collect<MotorGears>(_ports, [](const Motor& motor) { return motor.get_gearing(); });
+}
+
+std::vector<std::int8_t> MotorGroup::get_port_all(void) const { return _ports; }
+
+std::vector<std::int32_t> MotorGroup::get_voltage_limit_all(void) const {
+    return collect<std::int32_t>(_ports, [](const Motor& motor) { return motor.get_voltage_limit(); });
+}
+
+std::vector<std::int32_t> MotorGroup::is_reversed_all(void) const {
+    return collect<std::int32_t>(_ports, [](const Motor& motor) { return motor.is_reversed(); });
+}
+
+std::int32_t MotorGroup::set_brake_mode_all(const MotorBrake mode) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.set_brake_mode(mode); });
+}
+
+std::int32_t MotorGroup::set_brake_mode_all(const pros::motor_brake_mode_e_t mode) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.set_brake_mode(mode); });
+}
+
+std::int32_t MotorGroup::set_current_limit_all(const std::int32_t limit) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.set_current_limit(limit); });
+}
+
+std::int32_t MotorGroup::set_encoder_units_all(const MotorUnits units) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.set_encoder_units(units); });
+}
+
+std::int32_t MotorGroup::set_encoder_units_all(const pros::motor_encoder_units_e_t units) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.set_encoder_units(units); });
+}
+
+std::int32_t MotorGroup::set_gearing_all(const MotorGears gearset) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.set_gearing(gearset); });
+}
+
+std::int32_t MotorGroup::set_gearing_all(const pros::motor_gearset_e_t gearset) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.set_gearing(gearset); });
+}
+
+std::int32_t MotorGroup::set_reversed_all(const bool reverse) {
+    for (std::int8_t& port : _ports) port = reverse ? -std::abs(port) : std::abs(port);
+    return 1;
+}
+
+std::int32_t MotorGroup::set_voltage_limit_all(const std::int32_t limit) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.set_voltage_limit(limit); });
+}
+
+std::int32_t MotorGroup::set_zero_position_all(const double position) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.set_zero_position(position); });
+}
+
+std::int32_t MotorGroup::tare_position_all(void) const {
+    return forEach(_ports, [&](const Motor& motor) { return motor.tare_position(); });
+}
+} // namespace pros::v5
@@ -0,0 +1,509 @@
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include "pros/error.h"
+#include "pros/motors.hpp"
+#include "sim/devices.hpp"
+#include "sim/scheduler.hpp"
+
+// host implementation of the PROS motor API. Negative ports reverse the motor, just like on the brain
+
+namespace {
+sim::Motor* getMotor(int8_t port) {
+    sim::charge();
+    const uint8_t p = std::abs(port);
+    if (p < 1 || p > 21) {
+        errno = ENXIO;
+        return nullptr;
+    }
+    return &sim::motor(p);
+}
+
+float direction(int8_t port) { return port < 0 ? -1 : 1; }
+
+int32_t maxVelocity(const sim::Motor& motor) { return motor.freeSpeed; }
+
+// encoder ticks per revolution of the output shaft for each cartridge
+double ticksPerRevolution(const sim::Motor& motor) {
+    if (motor.freeSpeed == 100) return 1800;
+    if (motor.freeSpeed == 200) return 900;
+    return 300;
+}
+
+// convert from degrees to the motor's encoder units
+double toUnits(const sim::Motor& motor, double degrees) {
+    switch (motor.encoderUnits) {
+        case 1: return degrees / 360;
+        case 2: return degrees / 360 * ticksPerRevolution(motor);
+        default: return degrees;
+    }
+}
+
+double fromUnits(const sim::Motor& motor, double value) {
+    switch (motor.encoderUnits) {
+        case 1: return value * 360;
+        case 2: return value * 360 / ticksPerRevolution(motor);
+        default: return value;
+    }
+}
+} // namespace
+
+namespace pros::c {
+int32_t motor_move(int8_t port, int32_t voltage) {
+    return motor_move_voltage(port, std::clamp(voltage, -127, 127) * 12000 / 127);
+}
+
+int32_t motor_brake(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    motor->command(sim::Motor::Mode::BRAKE, 0);
+    return 1;
+}
+
+int32_t motor_move_absolute(int8_t port, double position, const int32_t velocity) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    const double target = direction(port) * fromUnits(*motor, position);
+    motor->command(sim::Motor::Mode::POSITION, target, std::min(std::abs(velocity), maxVelocity(*motor)));
+    return 1;
+}
+
+int32_t motor_move_relative(int8_t port, double position, const int32_t velocity) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    const double target = motor->targetPosition + direction(port) * fromUnits(*motor, position);
+    motor->command(sim::Motor::Mode::POSITION, target, std::min(std::abs(velocity), maxVelocity(*motor)));
+    return 1;
+}
+
+int32_t motor_move_velocity(int8_t port, const int32_t velocity) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    const int32_t limit = maxVelocity(*motor);
+    motor->command(sim::Motor::Mode::VELOCITY, direction(port) * std::clamp(velocity, -limit, limit));
+    return 1;
+}
+
+int32_t motor_move_voltage(int8_t port, const int32_t voltage) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    motor->command(sim::Motor::Mode::VOLTAGE, direction(port) * std::clamp(voltage, -12000, 12000));
+    return 1;
+}
+
+int32_t motor_modify_profiled_velocity(int8_t port, const int32_t velocity) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    motor->command(sim::Motor::Mode::POSITION, motor->targetPosition,
+                   std::min(std::abs(velocity), maxVelocity(*motor)));
+    return 1;
+}
+
+double motor_get_target_position(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR_F;
+    return toUnits(*motor, direction(port) * motor->targetPosition);
+}
+
+int32_t motor_get_target_velocity(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    return direction(port) * motor->targetVelocity;
+}
+
+double motor_get_actual_velocity(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR_F;
+    return direction(port) * motor->velocity;
+}
+
+int32_t motor_get_current_draw(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    return motor->current;
+}
+
+int32_t motor_get_direction(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    return direction(port) * motor->velocity < 0 ? -1 : 1;
+}
+
+double motor_get_efficiency(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR_F;
+    const double input = std::fabs(motor->voltage * motor->current / 1000);
+    if (input < 1e-6) return 0;
+    const double output = std::fabs(motor->torque * motor->velocity * 2 * M_PI / 60);
+    return std::min(100.0, output / input * 100);
+}
+
+int32_t motor_is_over_current(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    return motor->current >= motor->currentLimit;
+}
+
+int32_t motor_is_over_temp(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    return motor->temperature >= 55;
+}
+
+uint32_t motor_get_faults(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    uint32_t faults = 0;
+    if (motor->temperature >= 55) faults |= E_MOTOR_FAULT_MOTOR_OVER_TEMP;
+    if (motor->current >= motor->currentLimit) faults |= E_MOTOR_FAULT_OVER_CURRENT;
+    return faults;
+}
+
+uint32_t motor_get_flags(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    return std::fabs(motor->velocity) < 1 ? E_MOTOR_FLAGS_ZERO_VELOCITY : E_MOTOR_FLAGS_NONE;
+}
+
+int32_t motor_get_raw_position(int8_t port, uint32_t* const timestamp) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    if (timestamp != nullptr) *timestamp = sim::millis();
+    return std::lround(direction(port) * motor->getPosition() / 360 * ticksPerRevolution(*motor));
+}
+
+double motor_get_position(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR_F;
+    return toUnits(*motor, direction(port) * motor->getPosition());
+}
+
+double motor_get_power(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR_F;
+    return std::fabs(motor->voltage * motor->current / 1000);
+}
+
+double motor_get_temperature(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR_F;
+    return motor->temperature;
+}
+
+double motor_get_torque(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR_F;
+    return direction(port) * motor->torque;
+}
+
+int32_t motor_get_voltage(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    return std::lround(direction(port) * motor->voltage * 1000);
+}
+
+int32_t motor_set_zero_position(int8_t port, const double position) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    motor->setZero(direction(port) * fromUnits(*motor, position));
+    return 1;
+}
+
+int32_t motor_tare_position(int8_t port) { return motor_set_zero_position(port, 0); }
+
+int32_t motor_set_brake_mode(int8_t port, const motor_brake_mode_e_t mode) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    if (mode < E_MOTOR_BRAKE_COAST || mode > E_MOTOR_BRAKE_HOLD) {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    motor->brakeMode = static_cast<sim::Motor::Brake>(mode);
+    return 1;
+}
+
+int32_t motor_set_current_limit(int8_t port, const int32_t limit) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    motor->currentLimit = std::clamp(limit, 0, 2500);
+    return 1;
+}
+
+int32_t motor_set_encoder_units(int8_t port, const motor_encoder_units_e_t units) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    if (units < E_MOTOR_ENCODER_DEGREES || units > E_MOTOR_ENCODER_COUNTS) {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    motor->encoderUnits = units;
+    return 1;
+}
+
+int32_t motor_set_gearing(int8_t port, const motor_gearset_e_t gearset) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    switch (gearset) {
+        case E_MOTOR_GEARSET_36: motor->setCartridge(100); break;
+        case E_MOTOR_GEARSET_18: motor->setCartridge(200); break;
+        case E_MOTOR_GEARSET_06: motor->setCartridge(600); break;
+        default: errno = EINVAL; return PROS_ERR;
+    }
+    return 1;
+}
+
+int32_t motor_set_voltage_limit(int8_t port, const int32_t limit) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    motor->voltageLimit = std::clamp(limit, 0, 12000);
+    return 1;
+}
+
+motor_brake_mode_e_t motor_get_brake_mode(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return E_MOTOR_BRAKE_INVALID;
+    return static_cast<motor_brake_mode_e_t>(motor->brakeMode);
+}
+
+int32_t motor_get_current_limit(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    return motor->currentLimit;
+}
+
+motor_encoder_units_e_t motor_get_encoder_units(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return E_MOTOR_ENCODER_INVALID;
+    return static_cast<motor_encoder_units_e_t>(motor->encoderUnits);
+}
+
+motor_gearset_e_t motor_get_gearing(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return E_MOTOR_GEARSET_INVALID;
+    if (motor->freeSpeed == 100) return E_MOTOR_GEARSET_36;
+    if (motor->freeSpeed == 200) return E_MOTOR_GEARSET_18;
+    return E_MOTOR_GEARSET_06;
+}
+
+int32_t motor_get_voltage_limit(int8_t port) {
+    sim::Motor* motor = getMotor(port);
+    if (motor == nullptr) return PROS_ERR;
+    return motor->voltageLimit;
+}
+} // namespace pros::c
+
+namespace pros::v5 {
+Motor::Motor(const std::int8_t port, const MotorGears gearset, const MotorUnits encoder_units)
+    : Device(std::abs(port), DeviceType::motor),
+      _port(port) {
+    if (gearset != MotorGears::invalid) set_gearing(gearset);
+    if (encoder_units != MotorUnits::invalid) set_encoder_units(encoder_units);
+}
+
+std::int32_t Motor::move(std::int32_t voltage) const { return c::motor_move(_port, voltage); }
+
+std::int32_t Motor::move_absolute(const double position, const std::int32_t velocity) const {
+    return c::motor_move_absolute(_port, position, velocity);
+}
+
+std::int32_t Motor::move_relative(const double position, const std::int32_t velocity) const {
+    return c::motor_move_relative(_port, position, velocity);
+}
+
+std::int32_t Motor::move_velocity(const std::int32_t velocity) const { return c::motor_move_velocity(_port, velocity); }
+
+std::int32_t Motor::move_voltage(const std::int32_t voltage) const { return c::motor_move_voltage(_port, voltage); }
+
+std::int32_t Motor::brake(void) const { return c::motor_brake(_port); }
+
+std::int32_t Motor::modify_profiled_velocity(const std::int32_t velocity) const {
+    return c::motor_modify_profiled_velocity(_port, velocity);
+}
+
+double Motor::get_target_position(const std::uint8_t index) const { return c::motor_get_target_position(_port); }
+
+std::int32_t Motor::get_target_velocity(const std::uint8_t index) const {
+    return c::motor_get_target_velocity(_port);
+}
+
+double Motor::get_actual_velocity(const std::uint8_t index) const { return c::motor_get_actual_velocity(_port); }
+
+std::int32_t Motor::get_current_draw(const std::uint8_t index) const { return c::motor_get_current_draw(_port); }
+
+std::int32_t Motor::get_direction(const std::uint8_t index) const { return c::motor_get_direction(_port); }
+
+double Motor::get_efficiency(const std::uint8_t index) const { return c::motor_get_efficiency(_port); }
+
+std::uint32_t Motor::get_faults(const std::uint8_t index) const { return c::motor_get_faults(_port); }
+
+std::uint32_t Motor::get_flags(const std::uint8_t index) const { return c::motor_get_flags(_port); }
+
+double Motor::get_position(const std::uint8_t index) const { return c::motor_get_position(_port); }
+
+double Motor::get_power(const std::uint8_t index) const { return c::motor_get_power(_port); }
+
+std::int32_t Motor::get_raw_position(std::uint32_t* const timestamp, const std::uint8_t index) const {
+    return c::motor_get_raw_position(_port, timestamp);
+}
+
+double Motor::get_temperature(const std::uint8_t index) const { return c::motor_get_temperature(_port); }
+
+double Motor::get_torque(const std::uint8_t index) const { return c::motor_get_torque(_port); }
+
+std::int32_t Motor::get_voltage(const std::uint8_t index) const { return c::motor_get_voltage(_port); }
+
+std::int32_t Motor::is_over_current(const std::uint8_t index) const { return c::motor_is_over_current(_port); }
+
+std::int32_t Motor::is_over_temp(const std::uint8_t index) const { return c::motor_is_over_temp(_port); }
+
+MotorBrake Motor::get_brake_mode(const std::uint8_t index) const {
+    return static_cast<MotorBrake>(c::motor_get_brake_mode(_port));
+}
+
+std::int32_t Motor::get_current_limit(const std::uint8_t index) const { return c::motor_get_current_limit(_port); }
+
+MotorUnits Motor::get_encoder_units(const std::uint8_t index) const {
+    return static_cast<MotorUnits>(c::motor_get_encoder_units(_port));
+}
+
+MotorGears Motor::get_gearing(const std::uint8_t index) const {
+    return static_cast<MotorGears>(c::motor_get_gearing(_port));
+}
+
+std::int32_t Motor::get_voltage_limit(const std::uint8_t index) const { return c::motor_get_voltage_limit(_port); }
+
+std::int32_t Motor::is_reversed(const std::uint8_t index) const { return _port < 0; }
+
+std::int32_t Motor::set_brake_mode(const MotorBrake mode, const std::uint8_t index) const {
+    return c::motor_set_brake_mode(_port, static_cast<motor_brake_mode_e_t>(mode));
+}
+
+std::int32_t Motor::set_brake_mode(const pros::motor_brake_mode_e_t mode, const std::uint8_t index) const {
+    return c::motor_set_brake_mode(_port, mode);
+}
+
+std::int32_t Motor::set_current_limit(const std::int32_t limit, const std::uint8_t index) const {
+    return c::motor_set_current_limit(_port, limit);
+}
+
+std::int32_t Motor::set_encoder_units(const MotorUnits units, const std::uint8_t index) const {
+    return c::motor_set_encoder_units(_port, static_cast<motor_encoder_units_e_t>(units));
+}
+
+std::int32_t Motor::set_encoder_units(const pros::motor_encoder_units_e_t units, const std::uint8_t index) const {
+    return c::motor_set_encoder_units(_port, units);
+}
+
+std::int32_t Motor::set_gearing(const MotorGears gearset, const std::uint8_t index) const {
+    return c::motor_set_gearing(_port, static_cast<motor_gearset_e_t>(gearset));
+}
+
+std::int32_t Motor::set_gearing(const pros::motor_gearset_e_t gearset, const std::uint8_t index) const {
+    return c::motor_set_gearing(_port, gearset);
+}
+
+std::int32_t Motor::set_reversed(const bool reverse, const std::uint8_t index) {
+    _port = reverse ? -std::abs(_port) : std::abs(_port);
+    return 1;
+}
+
+std::int32_t Motor::set_voltage_limit(const std::int32_t limit, const std::uint8_t index) const {
+    return c::motor_set_voltage_limit(_port, limit);
+}
+
+std::int32_t Motor::set_zero_position(const double position, const std::uint8_t index) const {
+    return c::motor_set_zero_position(_port, position);
+}
+
+std::int32_t Motor::tare_position(const std::uint8_t index) const { return c::motor_tare_position(_port); }
+
+std::int8_t Motor::size(void) const { return 1; }
+
+std::vector<Motor> Motor::get_all_devices() {
+    std::vector<Motor> motors;
+    for (uint8_t port = 1; port <= 21; port++)
+        if (sim::motor(port).connected) motors.emplace_back(port);
+    return motors;
+}
+
+std::int8_t Motor::get_port(const std::uint8_t index) const { return _port; }
+
+std::vector<double> Motor::get_target_position_all(void) const { return {get_target_position()}; }
+
+std::vector<std::int32_t> Motor::get_target_velocity_all(void) const { return {get_target_velocity()}; }
+
+std::vector<double> Motor::get_actual_velocity_all(void) const { return {get_actual_velocity()}; }
+
+std::vector<std::int32_t> Motor::get_current_draw_all(void) const { return {get_current_draw()}; }
+
+std::vector<std::int32_t> Motor::get_direction_all(void) const { return {get_direction()}; }
+
+std::vector<double> Motor::get_efficiency_all(void) const { return {get_efficiency()}; }
+
+std::vector<std::uint32_t> Motor::get_faults_all(void) const { return {get_faults()}; }
+
+std::vector<std::uint32_t> Motor::get_flags_all(void) const { return {get_flags()}; }
+
+std::vector<double> Motor::get_position_all(void) const { return {get_position()}; }
+
+std::vector<double> Motor::get_power_all(void) const { return {get_power()}; }
+
+std::vector<std::int32_t> Motor::get_raw_position_all(std::uint32_t* const timestamp) const {
+    return {get_raw_position(timestamp)};
+}
+
+std::vector<double> Motor::get_temperature_all(void) const { return {get_temperature()}; }
+
+std::vector<double> Motor::get_torque_all(void) const { return {get_torque()}; }
+
+std::vector<std::int32_t> Motor::get_voltage_all(void) const { return {get_voltage()}; }
+
+std::vector<std::int32_t> Motor::is_over_current_all(void) const { return {is_over_current()}; }
+
+std::vector<std::int32_t> Motor::is_over_temp_all(void) const { return {is_over_temp()}; }
+
+std::vector<MotorBrake> Motor::get_brake_mode_all(void) const { return {get_brake_mode()}; }
+
+std::vector<std::int32_t> Motor::get_current_limit_all(void) const { return {get_current_limit()}; }
+
+std::vector<MotorUnits> Motor::get_encoder_units_all(void) const { return {get_encoder_units()}; }
+
+std::vector<MotorGears> Motor::get_gearing_all(void) const { return {get_gearing()}; }
+
+std::vector<std::int8_t> Motor::get_port_all(void) const { return {_port}; }
+
+std::vector<std::int32_t> Motor::get_voltage_limit_all(void) const { return {get_voltage_limit()}; }
+
+std::vector<std::int32_t> Motor::is_reversed_all(void) const { return {is_reversed()}; }
+
+std::int32_t Motor::set_brake_mode_all(const MotorBrake mode) const { return set_brake_mode(mode); }
+
+std::int32_t Motor::set_brake_mode_all(const pros::motor_brake_mode_e_t mode) const { return set_brake_mode(mode); }
+
+std::int32_t Motor::set_current_limit_all(const std::int32_t limit) const { return set_current_limit(limit); }
+
+std::int32_t Motor::set_encoder_units_all(const MotorUnits units) const { return set_encoder_units(units); }
+
+std::int32_t Motor::set_encoder_units_all(const pros::motor_encoder_units_e_t units) const {
+    return set_encoder_units(units);
+}
+
+std::int32_t Motor::set_gearing_all(const MotorGears gearset) const { return set_gearing(gearset); }
+
+std::int32_t Motor::set_gearing_all(const pros::motor_gearset_e_t gearset) const { return set_gearing(gearset); }
+
+std::int32_t Motor::set_reversed_all(const bool reverse) { return set_reversed(reverse); }
+
+std::int32_t Motor::set_voltage_limit_all(const std::int32_t limit) const { return set_voltage_limit(limit); }
+
+std::int32_t Motor::set_zero_position_all(const double position) const { return set_zero_position(position); }
+
+std::int32_t Motor::tare_position_all(void) const { return tare_position(); }
+
+namespace literals {
+const pros::Motor operator""_mtr(const unsigned long long int m) { return pros::Motor(m); }
+
+const pros::Motor operator""_rmtr(const unsigned long long int m) { return pros::Motor(-m); }
+} // namespace literals
+} // namespace pros::v5
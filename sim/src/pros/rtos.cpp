@@ -0,0 +1,211 @@
+#include <map>
+#include <set>
+#include "pros/rtos.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/sync.hpp"
+
+// host implementation of the PROS RTOS API on top of the simulator's scheduler
+
+namespace {
+// notification values of every task that has been notified
+std::map<sim::Task*, uint32_t> notifications;
+// tasks blocked in task_notify_take
+std::set<sim::Task*> notifyWaiters;
+
+sim::Task* toTask(pros::task_t task) {
+    return task == nullptr ? sim::current() : static_cast<sim::Task*>(task);
+}
+
+uint64_t deadlineFor(uint32_t timeout) {
+    return timeout == TIMEOUT_MAX ? UINT64_MAX : sim::micros() + uint64_t(timeout) * 1000;
+}
+} // namespace
+
+namespace pros::c {
+uint32_t millis(void) {
+    sim::charge();
+    return sim::millis();
+}
+
+uint64_t micros(void) {
+    sim::charge();
+    return sim::micros();
+}
+
+task_t task_create(task_fn_t function, void* const parameters, uint32_t prio, const uint16_t stack_depth,
+                   const char* const name) {
+    (void)stack_depth;
+    return sim::spawn(function, parameters, prio, name == nullptr ? "" : name);
+}
+
+void task_delete(task_t task) { sim::kill(toTask(task)); }
+
+void task_delay(const uint32_t milliseconds) {
+    sim::charge();
+    sim::sleepUntil(sim::micros() + uint64_t(milliseconds) * 1000);
+}
+
+void delay(const uint32_t milliseconds) { task_delay(milliseconds); }
+
+void task_delay_until(uint32_t* const prev_time, const uint32_t delta) {
+    sim::charge();
+    *prev_time += delta;
+    sim::sleepUntil(uint64_t(*prev_time) * 1000);
+}
+
+uint32_t task_get_priority(task_t task) { return sim::getPriority(toTask(task)); }
+
+void task_set_priority(task_t task, uint32_t prio) { sim::setPriority(toTask(task), prio); }
+
+task_state_e_t task_get_state(task_t task) {
+    sim::Task* t = toTask(task);
+    if (t == nullptr) return E_TASK_STATE_INVALID;
+    if (sim::isDead(t)) return E_TASK_STATE_DELETED;
+    if (sim::isSuspended(t)) return E_TASK_STATE_SUSPENDED;
+    if (t == sim::current()) return E_TASK_STATE_RUNNING;
+    return E_TASK_STATE_READY;
+}
+
+void task_suspend(task_t task) { sim::suspend(toTask(task)); }
+
+void task_resume(task_t task) { sim::resume(toTask(task)); }
+
+uint32_t task_get_count(void) { return sim::taskCount(); }
+
+char* task_get_name(task_t task) { return const_cast<char*>(sim::getName(toTask(task)).c_str()); }
+
+task_t task_get_by_name(const char* name) { return sim::findTask(name); }
+
+task_t task_get_current() { return sim::current(); }
+
+uint32_t task_notify(task_t task) { return task_notify_ext(task, 0, E_NOTIFY_ACTION_INCR, nullptr); }
+
+void task_join(task_t task) { sim::join(toTask(task)); }
+
+uint32_t task_notify_ext(task_t task, uint32_t value, notify_action_e_t action, uint32_t* prev_value) {
+    sim::charge();
+    sim::Task* t = toTask(task);
+    uint32_t& notification = notifications[t];
+    if (prev_value != nullptr) *prev_value = notification;
+    switch (action) {
+        case E_NOTIFY_ACTION_NONE: break;
+        case E_NOTIFY_ACTION_BITS: notification |= value; break;
+        case E_NOTIFY_ACTION_INCR: notification++; break;
+        case E_NOTIFY_ACTION_OWRITE: notification = value; break;
+        case E_NOTIFY_ACTION_NO_OWRITE:
+            if (notification != 0) return 0;
+            notification = value;
+            break;
+    }
+    if (notification != 0 && notifyWaiters.count(t)) sim::wake(t);
+    return 1;
+}
+
+uint32_t task_notify_take(bool clear_on_exit, uint32_t timeout) {
+    sim::charge();
+    const uint64_t deadline = deadlineFor(timeout);
+    sim::Task* task = sim::current();
+    uint32_t& notification = notifications[task];
+    if (notification == 0) {
+        notifyWaiters.insert(task);
+        sim::wait(deadline);
+        notifyWaiters.erase(task);
+        if (notification == 0) return 0;
+    }
+    const uint32_t value = notification;
+    notification = clear_on_exit ? 0 : notification - 1;
+    return value;
+}
+
+bool task_notify_clear(task_t task) {
+    uint32_t& notification = notifications[toTask(task)];
+    const bool pending = notification != 0;
+    notification = 0;
+    return pending;
+}
+
+mutex_t mutex_create(void) { return sim::createLock(); }
+
+bool mutex_take(mutex_t mutex, uint32_t timeout) {
+    sim::charge();
+    return sim::takeLock(static_cast<sim::Lock*>(mutex), deadlineFor(timeout));
+}
+
+bool mutex_give(mutex_t mutex) {
+    sim::charge();
+    return sim::giveLock(static_cast<sim::Lock*>(mutex));
+}
+
+void mutex_delete(mutex_t mutex) { sim::deleteLock(static_cast<sim::Lock*>(mutex)); }
+} // namespace pros::c
+
+namespace pros::rtos {
+Task::Task(task_fn_t function, void* parameters, std::uint32_t prio, std::uint16_t stack_depth, const char* name)
+    : task(c::task_create(function, parameters, prio, stack_depth, name)) {}
+
+Task::Task(task_fn_t function, void* parameters, const char* name)
+    : Task(function, parameters, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, name) {}
+
+Task::Task(task_t task)
+    : task(task) {}
+
+Task Task::current() { return Task(c::task_get_current()); }
+
+Task& Task::operator=(const task_t in) {
+    task = in;
+    return *this;
+}
+
+void Task::remove() { c::task_delete(task); }
+
+std::uint32_t Task::get_priority() { return c::task_get_priority(task); }
+
+void Task::set_priority(std::uint32_t prio) { c::task_set_priority(task, prio); }
+
+std::uint32_t Task::get_state() { return c::task_get_state(task); }
+
+void Task::suspend() { c::task_suspend(task); }
+
+void Task::resume() { c::task_resume(task); }
+
+const char* Task::get_name() { return c::task_get_name(task); }
+
+std::uint32_t Task::notify() { return c::task_notify(task); }
+
+void Task::join() { c::task_join(task); }
+
+std::uint32_t Task::notify_ext(std::uint32_t value, notify_action_e_t action, std::uint32_t* prev_value) {
+    return c::task_notify_ext(task, value, action, prev_value);
+}
+
+std::uint32_t Task::notify_take(bool clear_on_exit, std::uint32_t timeout) {
+    return c::task_notify_take(clear_on_exit, timeout);
+}
+
+bool Task::notify_clear() { return c::task_notify_clear(task); }
+
+void Task::delay(const std::uint32_t milliseconds) { c::task_delay(milliseconds); }
+
+void Task::delay_until(std::uint32_t* const prev_time, const std::uint32_t delta) {
+    c::task_delay_until(prev_time, delta);
+}
+
+std::uint32_t Task::get_count() { return c::task_get_count(); }
+
+Clock::time_point Clock::now() { return time_point {duration {c::millis()}}; }
+
+Mutex::Mutex()
+    : mutex(c::mutex_create(), c::mutex_delete) {}
+
+bool Mutex::take() { return c::mutex_take(mutex.get(), TIMEOUT_MAX); }
+
+bool Mutex::take(std::uint32_t timeout) { return c::mutex_take(mutex.get(), timeout); }
+
+bool Mutex::give() { return c::mutex_give(mutex.get()); }
+
+void Mutex::lock() { take(TIMEOUT_MAX); }
+
+void Mutex::unlock() { give(); }
+
+bool Mutex::try_lock() { return take(0); }
+} // namespace pros::rtos
@@ -0,0 +1,425 @@
+#include <cerrno>
+#include <cmath>
+#include "pros/device.h"
+#include "pros/device.hpp"
+#include "pros/distance.hpp"
+#include "pros/error.h"
+#include "pros/imu.hpp"
+#include "pros/rotation.hpp"
+#include "sim/devices.hpp"
+#include "sim/scheduler.hpp"
+
+// host implementation of the PROS smart sensor APIs
+
+namespace {
+template <typename T> T* getSensor(uint8_t port, T& (*lookup)(uint8_t)) {
+    sim::charge();
+    if (port < 1 || port > 21) {
+        errno = ENXIO;
+        return nullptr;
+    }
+    T* sensor = &lookup(port);
+    if (!sensor->connected) {
+        errno = ENODEV;
+        return nullptr;
+    }
+    return sensor;
+}
+
+sim::RotationSensor* getRotation(uint8_t port) { return getSensor(port, sim::rotation); }
+
+sim::InertialSensor* getImu(uint8_t port) {
+    sim::InertialSensor* imu = getSensor(port, sim::imu);
+    if (imu != nullptr && imu->calibrating) {
+        errno = EAGAIN;
+        return nullptr;
+    }
+    return imu;
+}
+
+sim::DistanceSensor* getDistance(uint8_t port) { return getSensor(port, sim::distance); }
+
+double wrap(double angle, double min) { return angle - 360 * std::floor((angle - min) / 360); }
+} // namespace
+
+namespace pros::c {
+v5_device_e_t get_plugged_type(uint8_t port) {
+    if (port < 1 || port > 21) {
+        errno = ENXIO;
+        return E_DEVICE_UNDEFINED;
+    }
+    if (sim::motor(port).connected) return E_DEVICE_MOTOR;
+    if (sim::rotation(port).connected) return E_DEVICE_ROTATION;
+    if (sim::imu(port).connected) return E_DEVICE_IMU;
+    if (sim::distance(port).connected) return E_DEVICE_DISTANCE;
+    return E_DEVICE_NONE;
+}
+
+int32_t rotation_reset(uint8_t port) {
+    sim::RotationSensor* sensor = getRotation(port);
+    if (sensor == nullptr) return PROS_ERR;
+    sensor->zero = sensor->raw - sensor->angle;
+    sensor->position = sensor->angle;
+    return 1;
+}
+
+int32_t rotation_set_data_rate(uint8_t port, uint32_t rate) {
+    sim::RotationSensor* sensor = getRotation(port);
+    if (sensor == nullptr) return PROS_ERR;
+    sensor->dataRate = std::max<uint32_t>(rate / 5 * 5, 5);
+    return 1;
+}
+
+int32_t rotation_set_position(uint8_t port, uint32_t position) {
+    sim::RotationSensor* sensor = getRotation(port);
+    if (sensor == nullptr) return PROS_ERR;
+    sensor->zero = sensor->raw - int32_t(position);
+    sensor->position = position;
+    return 1;
+}
+
+int32_t rotation_reset_position(uint8_t port) { return rotation_set_position(port, 0); }
+
+int32_t rotation_get_position(uint8_t port) {
+    sim::RotationSensor* sensor = getRotation(port);
+    if (sensor == nullptr) return PROS_ERR;
+    return sensor->position;
+}
+
+int32_t rotation_get_velocity(uint8_t port) {
+    sim::RotationSensor* sensor = getRotation(port);
+    if (sensor == nullptr) return PROS_ERR;
+    return sensor->velocity;
+}
+
+int32_t rotation_get_angle(uint8_t port) {
+    sim::RotationSensor* sensor = getRotation(port);
+    if (sensor == nullptr) return PROS_ERR;
+    return sensor->angle;
+}
+
+int32_t rotation_set_reversed(uint8_t port, bool value) {
+    sim::RotationSensor* sensor = getRotation(port);
+    if (sensor == nullptr) return PROS_ERR;
+    if (sensor->reversed != value) {
+        // the sensor keeps reporting the same position, it just counts the other way from now on
+        sensor->raw = -sensor->raw;
+        sensor->zero = -sensor->zero;
+        sensor->reversed = value;
+    }
+    return 1;
+}
+
+int32_t rotation_reverse(uint8_t port) {
+    sim::RotationSensor* sensor = getRotation(port);
+    if (sensor == nullptr) return PROS_ERR;
+    return rotation_set_reversed(port, !sensor->reversed);
+}
+
+int32_t rotation_init_reverse(uint8_t port, bool reverse_flag) {
+    // called from constructors, which can run before the simulated sensor is plugged in
+    if (port < 1 || port > 21) {
+        errno = ENXIO;
+        return PROS_ERR;
+    }
+    sim::rotation(port).reversed = reverse_flag;
+    return 1;
+}
+
+int32_t rotation_get_reversed(uint8_t port) {
+    sim::RotationSensor* sensor = getRotation(port);
+    if (sensor == nullptr) return PROS_ERR;
+    return sensor->reversed;
+}
+
+int32_t imu_reset(uint8_t port) {
+    sim::InertialSensor* imu = getSensor(port, sim::imu);
+    if (imu == nullptr) return PROS_ERR;
+    imu->calibrating = true;
+    imu->calibrationEnd = sim::millis() + 2000;
+    return 1;
+}
+
+int32_t imu_reset_blocking(uint8_t port) {
+    if (imu_reset(port) == PROS_ERR) return PROS_ERR;
+    while (sim::imu(port).calibrating) delay(10);
+    return 1;
+}
+
+int32_t imu_set_data_rate(uint8_t port, uint32_t rate) {
+    sim::InertialSensor* imu = getImu(port);
+    if (imu == nullptr) return PROS_ERR;
+    imu->dataRate = std::max<uint32_t>(rate / 5 * 5, 5);
+    return 1;
+}
+
+double imu_get_rotation(uint8_t port) {
+    sim::InertialSensor* imu = getImu(port);
+    if (imu == nullptr) return PROS_ERR_F;
+    return imu->rotation + imu->rotationOffset;
+}
+
+double imu_get_heading(uint8_t port) {
+    sim::InertialSensor* imu = getImu(port);
+    if (imu == nullptr) return PROS_ERR_F;
+    return wrap(imu->rotation + imu->rotationOffset, 0);
+}
+
+quaternion_s_t imu_get_quaternion(uint8_t port) {
+    sim::InertialSensor* imu = getImu(port);
+    if (imu == nullptr) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    // the robot only yaws, so the quaternion is a rotation about z. Positive heading is clockwise
+    const double half = -(imu->rotation + imu->rotationOffset) * M_PI / 360;
+    return {0, 0, std::sin(half), std::cos(half)};
+}
+
+euler_s_t imu_get_euler(uint8_t port) {
+    sim::InertialSensor* imu = getImu(port);
+    if (imu == nullptr) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return {0, 0, wrap(imu->rotation + imu->rotationOffset, -180)};
+}
+
+imu_gyro_s_t imu_get_gyro_rate(uint8_t port) {
+    sim::InertialSensor* imu = getImu(port);
+    if (imu == nullptr) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return {0, 0, imu->rate};
+}
+
+imu_accel_s_t imu_get_accel(uint8_t port) {
+    sim::InertialSensor* imu = getImu(port);
+    if (imu == nullptr) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return {imu->accelX, imu->accelY, 1};
+}
+
+imu_status_e_t imu_get_status(uint8_t port) {
+    sim::InertialSensor* imu = getSensor(port, sim::imu);
+    if (imu == nullptr) return E_IMU_STATUS_ERROR;
+    return imu->calibrating ? E_IMU_STATUS_CALIBRATING : E_IMU_STATUS_READY;
+}
+
+double imu_get_pitch(uint8_t port) { return getImu(port) == nullptr ? PROS_ERR_F : 0; }
+
+double imu_get_roll(uint8_t port) { return getImu(port) == nullptr ? PROS_ERR_F : 0; }
+
+double imu_get_yaw(uint8_t port) { return imu_get_euler(port).yaw; }
+
+int32_t imu_set_rotation(uint8_t port, double target) {
+    sim::InertialSensor* imu = getImu(port);
+    if (imu == nullptr) return PROS_ERR;
+    imu->rotationOffset = target - imu->rotation;
+    return 1;
+}
+
+int32_t imu_set_heading(uint8_t port, double target) {
+    sim::InertialSensor* imu = getImu(port);
+    if (imu == nullptr) return PROS_ERR;
+    // only the heading changes, the rotation keeps counting full turns
+    imu->rotationOffset += wrap(target, 0) - wrap(imu->rotation + imu->rotationOffset, 0);
+    return 1;
+}
+
+int32_t imu_set_yaw(uint8_t port, double target) { return imu_set_heading(port, target); }
+
+int32_t imu_set_pitch(uint8_t port, double target) { return getImu(port) == nullptr ? PROS_ERR : 1; }
+
+int32_t imu_set_roll(uint8_t port, double target) { return getImu(port) == nullptr ? PROS_ERR : 1; }
+
+int32_t imu_set_euler(uint8_t port, euler_s_t target) { return imu_set_yaw(port, target.yaw); }
+
+int32_t imu_tare_heading(uint8_t port) { return imu_set_heading(port, 0); }
+
+int32_t imu_tare_rotation(uint8_t port) { return imu_set_rotation(port, 0); }
+
+int32_t imu_tare_pitch(uint8_t port) { return imu_set_pitch(port, 0); }
+
+int32_t imu_tare_roll(uint8_t port) { return imu_set_roll(port, 0); }
+
+int32_t imu_tare_yaw(uint8_t port) { return imu_set_yaw(port, 0); }
+
+int32_t imu_tare_euler(uint8_t port) { return imu_set_euler(port, {0, 0, 0}); }
+
+int32_t imu_tare(uint8_t port) {
+    if (imu_tare_euler(port) == PROS_ERR) return PROS_ERR;
+    return imu_tare_rotation(port);
+}
+
+imu_orientation_e_t imu_get_physical_orientation(uint8_t port) {
+    if (getSensor(port, sim::imu) == nullptr) return E_IMU_ORIENTATION_ERROR;
+    return E_IMU_Z_UP;
+}
+
+int32_t distance_get(uint8_t port) {
+    sim::DistanceSensor* sensor = getDistance(port);
+    if (sensor == nullptr) return PROS_ERR;
+    return sensor->reading.distance;
+}
+
+int32_t distance_get_confidence(uint8_t port) {
+    sim::DistanceSensor* sensor = getDistance(port);
+    if (sensor == nullptr) return PROS_ERR;
+    return sensor->reading.confidence;
+}
+
+int32_t distance_get_object_size(uint8_t port) {
+    sim::DistanceSensor* sensor = getDistance(port);
+    if (sensor == nullptr) return PROS_ERR;
+    return sensor->reading.objectSize;
+}
+
+double distance_get_object_velocity(uint8_t port) {
+    sim::DistanceSensor* sensor = getDistance(port);
+    if (sensor == nullptr) return PROS_ERR_F;
+    return 0;
+}
+} // namespace pros::c
+
+namespace pros::v5 {
+Device::Device(const std::uint8_t port)
+    : _port(port) {}
+
+std::uint8_t Device::get_port(void) const { return _port; }
+
+bool Device::is_installed() { return get_plugged_type() == _deviceType; }
+
+DeviceType Device::get_plugged_type() const { return get_plugged_type(_port); }
+
+DeviceType Device::get_plugged_type(std::uint8_t port) { return static_cast<DeviceType>(c::get_plugged_type(port)); }
+
+std::vector<Device> Device::get_all_devices(DeviceType device_type) {
+    std::vector<Device> devices;
+    for (std::uint8_t port = 1; port <= 21; port++) {
+        const DeviceType type = get_plugged_type(port);
+        if (type == DeviceType::none) continue;
+        if (device_type == DeviceType::undefined || type == device_type) devices.emplace_back(port);
+    }
+    return devices;
+}
+
+Rotation::Rotation(const std::int8_t port)
+    : Device(std::abs(port), DeviceType::rotation) {
+    if (port < 0) c::rotation_init_reverse(_port, true);
+}
+
+std::int32_t Rotation::reset() { return c::rotation_reset(_port); }
+
+std::int32_t Rotation::set_data_rate(std::uint32_t rate) const { return c::rotation_set_data_rate(_port, rate); }
+
+std::int32_t Rotation::set_position(std::uint32_t position) const { return c::rotation_set_position(_port, position); }
+
+std::int32_t Rotation::reset_position(void) const { return c::rotation_reset_position(_port); }
+
+std::vector<Rotation> Rotation::get_all_devices() {
+    std::vector<Rotation> devices;
+    for (std::uint8_t port = 1; port <= 21; port++)
+        if (sim::rotation(port).connected) devices.emplace_back(port);
+    return devices;
+}
+
+std::int32_t Rotation::get_position() const { return c::rotation_get_position(_port); }
+
+std::int32_t Rotation::get_velocity() const { return c::rotation_get_velocity(_port); }
+
+std::int32_t Rotation::get_angle() const { return c::rotation_get_angle(_port); }
+
+std::int32_t Rotation::set_reversed(bool value) const { return c::rotation_set_reversed(_port, value); }
+
+std::int32_t Rotation::reverse() const { return c::rotation_reverse(_port); }
+
+std::int32_t Rotation::get_reversed() const { return c::rotation_get_reversed(_port); }
+
+Imu Imu::get_imu() {
+    for (std::uint8_t port = 1; port <= 21; port++)
+        if (sim::imu(port).connected) return Imu(port);
+    errno = ENODEV;
+    return Imu(PROS_ERR_BYTE);
+}
+
+std::int32_t Imu::reset(bool blocking) const {
+    return blocking ? c::imu_reset_blocking(_port) : c::imu_reset(_port);
+}
+
+std::int32_t Imu::set_data_rate(std::uint32_t rate) const { return c::imu_set_data_rate(_port, rate); }
+
+std::vector<Imu> Imu::get_all_devices() {
+    std::vector<Imu> devices;
+    for (std::uint8_t port = 1; port <= 21; port++)
+        if (sim::imu(port).connected) devices.emplace_back(port);
+    return devices;
+}
+
+double Imu::get_rotation() const { return c::imu_get_rotation(_port); }
+
+double Imu::get_heading() const { return c::imu_get_heading(_port); }
+
+pros::quaternion_s_t Imu::get_quaternion() const { return c::imu_get_quaternion(_port); }
+
+pros::euler_s_t Imu::get_euler() const { return c::imu_get_euler(_port); }
+
+double Imu::get_pitch() const { return c::imu_get_pitch(_port); }
+
+double Imu::get_roll() const { return c::imu_get_roll(_port); }
+
+double Imu::get_yaw() const { return c::imu_get_yaw(_port); }
+
+pros::imu_gyro_s_t Imu::get_gyro_rate() const { return c::imu_get_gyro_rate(_port); }
+
+std::int32_t Imu::tare_rotation() const { return c::imu_tare_rotation(_port); }
+
+std::int32_t Imu::tare_heading() const { return c::imu_tare_heading(_port); }
+
+std::int32_t Imu::tare_pitch() const { return c::imu_tare_pitch(_port); }
+
+std::int32_t Imu::tare_yaw() const { return c::imu_tare_yaw(_port); }
+
+std::int32_t Imu::tare_roll() const { return c::imu_tare_roll(_port); }
+
+std::int32_t Imu::tare() const { return c::imu_tare(_port); }
+
+std::int32_t Imu::tare_euler() const { return c::imu_tare_euler(_port); }
+
+std::int32_t Imu::set_heading(const double target) const { return c::imu_set_heading(_port, target); }
+
+std::int32_t Imu::set_rotation(const double target) const { return c::imu_set_rotation(_port, target); }
+
+std::int32_t Imu::set_yaw(const double target) const { return c::imu_set_yaw(_port, target); }
+
+std::int32_t Imu::set_pitch(const double target) const { return c::imu_set_pitch(_port, target); }
+
+std::int32_t Imu::set_roll(const double target) const { return c::imu_set_roll(_port, target); }
+
+std::int32_t Imu::set_euler(const pros::euler_s_t target) const { return c::imu_set_euler(_port, target); }
+
+pros::imu_accel_s_t Imu::get_accel() const { return c::imu_get_accel(_port); }
+
+pros::ImuStatus Imu::get_status() const {
+    switch (c::imu_get_status(_port)) {
+        case E_IMU_STATUS_READY: return ImuStatus::ready;
+        case E_IMU_STATUS_CALIBRATING: return ImuStatus::calibrating;
+        default: return ImuStatus::error;
+    }
+}
+
+bool Imu::is_calibrating() const { return c::imu_get_status(_port) == E_IMU_STATUS_CALIBRATING; }
+
+imu_orientation_e_t Imu::get_physical_orientation() const { return c::imu_get_physical_orientation(_port); }
+
+Distance::Distance(const std::uint8_t port)
+    : Device(port, DeviceType::distance) {}
+
+std::int32_t Distance::get() { return c::distance_get(_port); }
+
+std::int32_t Distance::get_distance() { return c::distance_get(_port); }
+
+std::vector<Distance> Distance::get_all_devices() {
+    std::vector<Distance> devices;
+    for (std::uint8_t port = 1; port <= 21; port++)
+        if (sim::distance(port).connected) devices.emplace_back(port);
+    return devices;
+}
+
+std::int32_t Distance::get_confidence() { return c::distance_get_confidence(_port); }
+
+std::int32_t Distance::get_object_size() { return c::distance_get_object_size(_port); }
+
+double Distance::get_object_velocity() { return c::distance_get_object_velocity(_port); }
+} // namespace pros::v5
@@ -0,0 +1,21 @@
+#include "sim/random.hpp"
+
+namespace sim {
+namespace {
+std::mt19937_64 generator(0);
+} // namespace
+
+void seed(uint64_t seed) { generator.seed(seed); }
+
+std::mt19937_64& rng() { return generator; }
+
+double gaussian(double stddev) {
+    if (stddev <= 0) return 0;
+    return std::normal_distribution<double>(0, stddev)(generator);
+}
+
+double uniform(double min, double max) {
+    if (max <= min) return min;
+    return std::uniform_real_distribution<double>(min, max)(generator);
+}
+} // namespace sim
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <cmath>
+#include "sim/devices.hpp"
+#include "sim/random.hpp"
+#include "sim/robot.hpp"
+#include "sim/scheduler.hpp"
+
+namespace sim {
+namespace {
+// ports, matching src/main.cpp and src/Config.cpp
+constexpr uint8_t IMU_PORT = 14;
+constexpr uint8_t VERTICAL_PORT = 8;
+constexpr uint8_t HORIZONTAL_PORT = 16;
+constexpr uint8_t ARM_PORT = 2;
+constexpr uint8_t ARM_ROTATION_PORT = 4;
+constexpr uint8_t INTAKE_PORT = 20;
+constexpr uint8_t LOADER_PORT = 12;
+constexpr uint8_t LOADER2_PORT = 13;
+constexpr uint8_t LIMIT_PORT = 'G';
+
+// tracking wheel geometry, matching the lemlib::TrackingWheel definitions
+constexpr double TRACKING_DIAMETER = 2.75;
+constexpr double VERTICAL_OFFSET = 0.8;
+constexpr double HORIZONTAL_OFFSET = 1.125;
+
+// arm degrees per motor degree, and the hard stops of the arm
+constexpr double ARM_RATIO = 1.0 / 3;
+constexpr double ARM_MIN = 0;
+constexpr double ARM_MAX = 200;
+
+// intake degrees between two rings, and the window in which a ring sits in front of the loader sensors
+constexpr double RING_SPACING = 1500;
+constexpr double RING_START = 700;
+constexpr double RING_END = 900;
+
+double trackingCentidegrees(double inches) { return inches / (M_PI * TRACKING_DIAMETER) * 36000; }
+
+DistanceReading loaderReading(double offset) {
+    // the arm motor is reversed in the robot code, but the intake is not
+    const double travel = std::fmod(std::fmod(motor(INTAKE_PORT).rawPosition + offset, RING_SPACING) + RING_SPACING,
+                                    RING_SPACING);
+    if (travel >= RING_START && travel <= RING_END) return {30, 63, 200};
+    return {250, 40, 0};
+}
+
+void armHardStops(uint32_t) {
+    Motor& arm = motor(ARM_PORT);
+    // Motor(-2) raises the arm with negative raw commands
+    const double angle = -arm.rawPosition * ARM_RATIO;
+    if (angle < ARM_MIN || angle > ARM_MAX) {
+        arm.rawPosition = -std::clamp(angle, ARM_MIN, ARM_MAX) / ARM_RATIO;
+        arm.velocity = 0;
+    }
+}
+} // namespace
+
+double armAngle() { return std::clamp(-motor(ARM_PORT).rawPosition * ARM_RATIO, ARM_MIN, ARM_MAX); }
+
+void setupRobot(const RobotOptions& options) {
+    seed(options.seed);
+    battery().nominal = options.batteryVoltage;
+    battery().voltage = options.batteryVoltage;
+
+    DrivetrainModel model;
+    model.leftPorts = {-9, 10, -19};
+    model.rightPorts = {6, -7, 17};
+    model.cartridge = 600;
+    model.trackWidth = 10.4;
+    model.wheelDiameter = 2.75;
+    model.gearRatio = 480.0 / 600.0;
+    model.traction = options.traction;
+    if (options.characterization) applyCharacterization(model, *options.characterization);
+    setDrivetrain(model);
+    drivetrain().setPose(options.startPose);
+    for (int8_t port : model.leftPorts) motor(std::abs(port)).connected = true;
+    for (int8_t port : model.rightPorts) motor(std::abs(port)).connected = true;
+
+    RotationSensor& vertical = rotation(VERTICAL_PORT);
+    vertical.connected = true;
+    vertical.noise *= options.noise;
+    vertical.source = [] { return trackingCentidegrees(drivetrain().trackingDistance(VERTICAL_OFFSET, false)); };
+    RotationSensor& horizontal = rotation(HORIZONTAL_PORT);
+    horizontal.connected = true;
+    horizontal.noise *= options.noise;
+    horizontal.source = [] { return trackingCentidegrees(drivetrain().trackingDistance(HORIZONTAL_OFFSET, true)); };
+
+    InertialSensor& inertial = imu(IMU_PORT);
+    inertial.connected = true;
+    inertial.rateNoise *= options.noise;
+    inertial.biasWalk *= options.noise;
+    inertial.scaleError *= options.noise;
+    inertial.accelNoise *= options.noise;
+    inertial.bias = gaussian(0.05 * options.noise);
+
+    Motor& arm = motor(ARM_PORT);
+    arm.connected = true;
+    arm.setLoad(0.01, 0.003);
+    RotationSensor& armRotation = rotation(ARM_ROTATION_PORT);
+    armRotation.connected = true;
+    armRotation.noise *= options.noise;
+    armRotation.source = [] { return armAngle() * 100; };
+    adi(LIMIT_PORT).source = [] { return int32_t(armAngle() < 2); };
+
+    Motor& intake = motor(INTAKE_PORT);
+    intake.connected = true;
+    intake.setLoad(0.005, 0.0002);
+    DistanceSensor& loader = distance(LOADER_PORT);
+    loader.connected = true;
+    loader.noise *= options.noise;
+    loader.source = [] { return loaderReading(0); };
+    DistanceSensor& loader2 = distance(LOADER2_PORT);
+    loader2.connected = true;
+    loader2.noise *= options.noise;
+    loader2.source = [] { return loaderReading(-40); };
+
+    onTick(armHardStops);
+    startDevices();
+}
+} // namespace sim
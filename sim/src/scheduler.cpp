@@ -0,0 +1,340 @@
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "sim/scheduler.hpp"
+
+namespace sim {
+enum class TaskState { READY, BLOCKED, SUSPENDED, DEAD };
+
+struct Task {
+        std::string name;
+        // the priority the task was given, and the priority it runs at while it holds a mutex a higher priority task
+        // is waiting on
+        uint32_t basePriority;
+        uint32_t priority;
+        void (*function)(void*);
+        void* parameters;
+        TaskState state = TaskState::READY;
+        uint64_t wakeTime = 0;
+        // the order in which tasks were last scheduled, used for round robin between tasks of the same priority
+        uint64_t lastRun = 0;
+        uint64_t cpuTime = 0;
+        uint32_t switches = 0;
+        // whether the task is blocked in wait(), and whether wake() ended the wait
+        bool waiting = false;
+        bool woken = false;
+        std::vector<Task*> joiners;
+        std::condition_variable cv;
+};
+
+namespace {
+constexpr uint64_t NEVER = UINT64_MAX;
+
+struct State {
+        std::mutex lock;
+        std::condition_variable schedulerCv;
+        std::vector<std::unique_ptr<Task>> tasks;
+        std::vector<std::function<void(uint32_t)>> tickHooks;
+        std::vector<std::function<void(uint64_t, Task*)>> switchHooks;
+};
+
+/**
+ * @brief Get the scheduler state
+ *
+ * The state is created on first use, since the robot code can create tasks and mutexes from static initializers. It
+ * is intentionally leaked, because task threads are still parked on it when the program exits.
+ */
+State& state() {
+    static State* instance = new State;
+    return *instance;
+}
+
+// the task that is allowed to run. nullptr means the scheduler itself is running
+Task* active = nullptr;
+thread_local Task* self = nullptr;
+uint64_t now = 0;
+uint64_t scheduleCount = 0;
+uint32_t callCost = 5;
+uint64_t scheduleSeed = 0;
+std::mt19937_64 scheduleRng;
+
+/**
+ * @brief Move virtual time forward, running the tick hooks for every tick that is crossed
+ *
+ * @param time the new time, in microseconds
+ */
+void advanceTo(uint64_t time) {
+    while (now < time) {
+        const uint64_t nextTick = (now / 1000 + 1) * 1000;
+        if (nextTick > time) {
+            now = time;
+            break;
+        }
+        now = nextTick;
+        for (auto& hook : state().tickHooks) hook(now / 1000);
+    }
+}
+
+/**
+ * @brief Hand control back to the scheduler and wait until this task is picked again
+ */
+void switchOut(std::unique_lock<std::mutex>& guard, Task* task) {
+    active = nullptr;
+    state().schedulerCv.notify_one();
+    task->cv.wait(guard, [task] { return active == task; });
+}
+
+/**
+ * @brief Make a blocked task ready
+ *
+ * @param woken whether the task was woken by wake(), rather than timing out
+ */
+void unblock(Task* task, bool woken) {
+    task->state = TaskState::READY;
+    task->woken = woken;
+    task->waiting = false;
+}
+
+void markDead(Task* task) {
+    task->state = TaskState::DEAD;
+    for (Task* joiner : task->joiners)
+        if (joiner->state == TaskState::BLOCKED && joiner->waiting) unblock(joiner, true);
+    task->joiners.clear();
+}
+
+/**
+ * @brief Pick the next task to run
+ *
+ * The highest priority ready task runs first. Tasks with the same priority take turns, unless a schedule seed is
+ * set, in which case the seeded generator picks between them.
+ */
+Task* pickNext() {
+    std::vector<Task*> candidates;
+    for (auto& task : state().tasks) {
+        if (task->state == TaskState::BLOCKED && task->wakeTime <= now) unblock(task.get(), false);
+        if (task->state != TaskState::READY) continue;
+        if (!candidates.empty() && task->priority < candidates.front()->priority) continue;
+        if (!candidates.empty() && task->priority > candidates.front()->priority) candidates.clear();
+        candidates.push_back(task.get());
+    }
+    if (candidates.empty()) return nullptr;
+    if (scheduleSeed != 0) return candidates[scheduleRng() % candidates.size()];
+    Task* next = candidates.front();
+    for (Task* task : candidates)
+        if (task->lastRun < next->lastRun) next = task;
+    return next;
+}
+
+void taskEntry(Task* task) {
+    self = task;
+    {
+        std::unique_lock<std::mutex> guard(state().lock);
+        task->cv.wait(guard, [task] { return active == task; });
+    }
+    task->function(task->parameters);
+    std::unique_lock<std::mutex> guard(state().lock);
+    markDead(task);
+    active = nullptr;
+    state().schedulerCv.notify_one();
+}
+} // namespace
+
+uint64_t micros() { return now; }
+
+uint32_t millis() { return now / 1000; }
+
+void charge(uint32_t us) {
+    Task* task = self;
+    if (task == nullptr) return;
+    std::unique_lock<std::mutex> guard(state().lock);
+    const uint64_t before = now;
+    task->cpuTime += us;
+    advanceTo(now + us);
+    // the tick interrupt preempts the running task
+    if (before / 1000 != now / 1000) switchOut(guard, task);
+}
+
+void charge() { charge(callCost); }
+
+void setCallCost(uint32_t us) { callCost = us; }
+
+void setScheduleSeed(uint64_t seed) {
+    std::unique_lock<std::mutex> guard(state().lock);
+    scheduleSeed = seed;
+    scheduleRng.seed(seed);
+}
+
+Task* spawn(void (*function)(void*), void* parameters, uint32_t priority, const std::string& name) {
+    std::unique_lock<std::mutex> guard(state().lock);
+    state().tasks.push_back(std::make_unique<Task>());
+    Task* task = state().tasks.back().get();
+    task->name = name;
+    task->basePriority = priority;
+    task->priority = priority;
+    task->function = function;
+    task->parameters = parameters;
+    task->lastRun = scheduleCount;
+    std::thread(taskEntry, task).detach();
+    return task;
+}
+
+Task* current() { return self; }
+
+void sleepUntil(uint64_t wakeTime) {
+    Task* task = self;
+    std::unique_lock<std::mutex> guard(state().lock);
+    // outside of a task there is nothing to switch to, so time just moves forward
+    if (task == nullptr) {
+        advanceTo(wakeTime);
+        return;
+    }
+    task->state = TaskState::BLOCKED;
+    task->wakeTime = wakeTime;
+    switchOut(guard, task);
+}
+
+bool wait(uint64_t deadline) {
+    Task* task = self;
+    if (task == nullptr) return false;
+    std::unique_lock<std::mutex> guard(state().lock);
+    if (now >= deadline) return false;
+    task->state = TaskState::BLOCKED;
+    task->wakeTime = deadline;
+    task->waiting = true;
+    task->woken = false;
+    switchOut(guard, task);
+    return task->woken;
+}
+
+void wake(Task* task) {
+    std::unique_lock<std::mutex> guard(state().lock);
+    if (task->state != TaskState::BLOCKED || !task->waiting) return;
+    unblock(task, true);
+    // waking a higher priority task preempts the running task, like it does under FreeRTOS
+    if (self != nullptr && task->priority > self->priority) switchOut(guard, self);
+}
+
+void join(Task* task) {
+    Task* joiner = self;
+    std::unique_lock<std::mutex> guard(state().lock);
+    if (task->state == TaskState::DEAD) return;
+    if (joiner == nullptr) return;
+    task->joiners.push_back(joiner);
+    joiner->state = TaskState::BLOCKED;
+    joiner->wakeTime = NEVER;
+    joiner->waiting = true;
+    switchOut(guard, joiner);
+}
+
+void yield() {
+    Task* task = self;
+    if (task == nullptr) return;
+    std::unique_lock<std::mutex> guard(state().lock);
+    switchOut(guard, task);
+}
+
+void kill(Task* task) {
+    std::unique_lock<std::mutex> guard(state().lock);
+    markDead(task);
+    if (task != self) return;
+    active = nullptr;
+    state().schedulerCv.notify_one();
+    // park this thread forever. It will never be scheduled again
+    task->cv.wait(guard, [] { return false; });
+}
+
+void suspend(Task* task) {
+    std::unique_lock<std::mutex> guard(state().lock);
+    if (task->state == TaskState::DEAD) return;
+    task->state = TaskState::SUSPENDED;
+    if (task == self) switchOut(guard, task);
+}
+
+void resume(Task* task) {
+    std::unique_lock<std::mutex> guard(state().lock);
+    if (task->state == TaskState::SUSPENDED) task->state = TaskState::READY;
+}
+
+const std::string& getName(Task* task) { return task->name; }
+
+uint32_t getPriority(Task* task) { return task->priority; }
+
+void setPriority(Task* task, uint32_t priority) {
+    std::unique_lock<std::mutex> guard(state().lock);
+    // an inherited priority is kept until the task gives the mutex back
+    if (task->priority == task->basePriority || priority > task->priority) task->priority = priority;
+    task->basePriority = priority;
+}
+
+void inheritPriority(Task* task, uint32_t priority) {
+    std::unique_lock<std::mutex> guard(state().lock);
+    if (priority > task->priority) task->priority = priority;
+}
+
+void restorePriority(Task* task) {
+    std::unique_lock<std::mutex> guard(state().lock);
+    task->priority = task->basePriority;
+}
+
+bool isDead(Task* task) { return task->state == TaskState::DEAD; }
+
+bool isSuspended(Task* task) { return task->state == TaskState::SUSPENDED; }
+
+uint32_t taskCount() {
+    uint32_t count = 0;
+    for (auto& task : state().tasks)
+        if (task->state != TaskState::DEAD) count++;
+    return count;
+}
+
+Task* findTask(const std::string& name) {
+    for (auto& task : state().tasks)
+        if (task->state != TaskState::DEAD && task->name == name) return task.get();
+    return nullptr;
+}
+
+void onTick(std::function<void(uint32_t)> hook) { state().tickHooks.push_back(std::move(hook)); }
+
+void onSwitch(std::function<void(uint64_t, Task*)> hook) { state().switchHooks.push_back(std::move(hook)); }
+
+bool run(uint64_t until) {
+    std::unique_lock<std::mutex> guard(state().lock);
+    while (true) {
+        Task* next = pickNext();
+        if (next == nullptr) {
+            // nothing can run right now, so skip ahead to the next time a task wakes up
+            uint64_t wake = NEVER;
+            bool alive = false;
+            for (auto& task : state().tasks) {
+                if (task->state != TaskState::DEAD) alive = true;
+                if (task->state == TaskState::BLOCKED && task->wakeTime < wake) wake = task->wakeTime;
+            }
+            if (!alive) return false;
+            if (wake >= until) {
+                advanceTo(until);
+                return true;
+            }
+            advanceTo(wake);
+            continue;
+        }
+        if (now >= until) return true;
+        next->lastRun = ++scheduleCount;
+        next->switches++;
+        for (auto& hook : state().switchHooks) hook(now, next);
+        active = next;
+        next->cv.notify_one();
+        state().schedulerCv.wait(guard, [] { return active == nullptr; });
+    }
+}
+
+uint64_t getCpuTime(Task* task) { return task->cpuTime; }
+
+uint32_t getSwitchCount(Task* task) { return task->switches; }
+
+void forEachTask(std::function<void(Task*)> function) {
+    for (auto& task : state().tasks) function(task.get());
+}
+} // namespace sim
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <memory>
+#include "sim/scheduler.hpp"
+#include "sim/sync.hpp"
+
+namespace sim {
+struct Lock {
+        Task* owner = nullptr;
+        // tasks waiting for the lock, highest priority first
+        std::vector<Task*> waiters;
+        LockStats* stats;
+};
+
+namespace {
+/**
+ * @brief Get the statistics of every lock
+ *
+ * Statistics outlive their locks, so a lock that is created and deleted in a loop still shows up in the report. The
+ * list is created on first use, since the robot code creates mutexes from static initializers.
+ */
+std::vector<std::unique_ptr<LockStats>>& statistics() {
+    static auto* instance = new std::vector<std::unique_ptr<LockStats>>;
+    return *instance;
+}
+
+void addUser(LockStats& stats, Task* task) {
+    const std::string& name = task == nullptr ? "(no task)" : getName(task);
+    if (std::find(stats.users.begin(), stats.users.end(), name) == stats.users.end()) stats.users.push_back(name);
+}
+
+void enqueue(Lock* lock, Task* task) {
+    // waiters of the same priority are served in the order they arrived
+    auto position = std::find_if(lock->waiters.begin(), lock->waiters.end(),
+                                 [task](Task* waiter) { return getPriority(waiter) < getPriority(task); });
+    lock->waiters.insert(position, task);
+}
+} // namespace
+
+Lock* createLock() {
+    auto& all = statistics();
+    all.push_back(std::make_unique<LockStats>());
+    all.back()->name = "mutex " + std::to_string(all.size());
+    Lock* lock = new Lock;
+    lock->stats = all.back().get();
+    return lock;
+}
+
+void deleteLock(Lock* lock) { delete lock; }
+
+bool takeLock(Lock* lock, uint64_t deadline) {
+    Task* task = current();
+    LockStats& stats = *lock->stats;
+    if (lock->owner == nullptr || lock->owner == task) {
+        lock->owner = task;
+        stats.takes++;
+        addUser(stats, task);
+        return true;
+    }
+    // outside of a task there is nobody to switch to, so the lock can never be given back
+    if (task == nullptr) return false;
+    stats.contended++;
+    const uint64_t start = micros();
+    enqueue(lock, task);
+    inheritPriority(lock->owner, getPriority(task));
+    // giveLock hands the lock over before it wakes the waiter, so being woken means the lock is ours
+    // the lock may also have been handed over after the deadline passed, but before this task ran again
+    const bool taken = wait(deadline) || lock->owner == task;
+    const uint64_t waited = micros() - start;
+    stats.waitTime += waited;
+    stats.maxWait = std::max(stats.maxWait, waited);
+    if (!taken) {
+        lock->waiters.erase(std::find(lock->waiters.begin(), lock->waiters.end(), task));
+        stats.timeouts++;
+        return false;
+    }
+    stats.takes++;
+    addUser(stats, task);
+    return true;
+}
+
+bool giveLock(Lock* lock) {
+    Task* task = current();
+    if (lock->owner != task) return false;
+    if (task != nullptr) restorePriority(task);
+    if (lock->waiters.empty()) {
+        lock->owner = nullptr;
+        return true;
+    }
+    Task* next = lock->waiters.front();
+    lock->waiters.erase(lock->waiters.begin());
+    lock->owner = next;
+    if (!lock->waiters.empty()) inheritPriority(next, getPriority(lock->waiters.front()));
+    wake(next);
+    return true;
+}
+
+void forEachLock(std::function<void(const LockStats&)> function) {
+    for (auto& stats : statistics()) function(*stats);
+}
+} // namespace sim
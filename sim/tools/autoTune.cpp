@@ -0,0 +1,89 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "autoTuner.hpp"
+#include "autons.hpp"
+#include "sim/match.hpp"
+#include "sim/robot.hpp"
+
+// runs the relay feedback tests of AutoTuner against the simulated robot, and prints the settings they suggest
+
+namespace {
+struct Options {
+        AutoTuner::Experiment lateral;
+        AutoTuner::Experiment angular;
+        sim::RobotOptions robot;
+};
+
+Options options;
+AutoTuner::Result lateralResult;
+AutoTuner::Result angularResult;
+
+void usage() {
+    std::fprintf(stderr, "usage: auto-tune [--rule classic|pd|some-overshoot|no-overshoot] [--lateral-power n]\n"
+                         "                 [--angular-power n] [--cycles n] [--seed n] [--battery volts]\n"
+                         "                 [--noise scale] [--traction mu]\n");
+    std::exit(2);
+}
+
+AutoTuner::Rule parseRule(const std::string& rule) {
+    if (rule == "classic") return AutoTuner::Rule::CLASSIC;
+    if (rule == "pd") return AutoTuner::Rule::PD;
+    if (rule == "some-overshoot") return AutoTuner::Rule::SOME_OVERSHOOT;
+    if (rule == "no-overshoot") return AutoTuner::Rule::NO_OVERSHOOT;
+    usage();
+    return AutoTuner::Rule::PD;
+}
+
+void parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) usage();
+            return argv[++i];
+        };
+        if (!std::strcmp(argv[i], "--rule")) options.lateral.rule = options.angular.rule = parseRule(next());
+        else if (!std::strcmp(argv[i], "--lateral-power")) options.lateral.relayPower = std::atoi(next());
+        else if (!std::strcmp(argv[i], "--angular-power")) options.angular.relayPower = std::atoi(next());
+        else if (!std::strcmp(argv[i], "--cycles")) options.lateral.cycles = options.angular.cycles = std::atoi(next());
+        else if (!std::strcmp(argv[i], "--seed")) options.robot.seed = std::strtoull(next(), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--battery")) options.robot.batteryVoltage = std::atof(next());
+        else if (!std::strcmp(argv[i], "--noise")) options.robot.noise = std::atof(next());
+        else if (!std::strcmp(argv[i], "--traction")) options.robot.traction = std::atof(next());
+        else usage();
+    }
+}
+
+void runTests() {
+    chassis.calibrate();
+    AutoTuner tuner(chassis);
+    lateralResult = tuner.tune(AutoTuner::Controller::LATERAL, linearController, options.lateral);
+    angularResult = tuner.tune(AutoTuner::Controller::ANGULAR, angularController, options.angular);
+}
+
+void print(const char* name, const char* unit, const AutoTuner::Result& result) {
+    if (!result.ok) {
+        std::printf("%s: %s\n", name, result.error);
+        return;
+    }
+    const lemlib::ControllerSettings& settings = result.settings;
+    std::printf("%s: ultimate gain %.3f, period %.0fms, amplitude %.3f%s, noise %.3f%s, breakaway power %.0f\n", name,
+                result.ultimateGain, result.ultimatePeriod, result.amplitude, unit, result.noise, unit,
+                result.breakawayPower);
+    std::printf("  lemlib::ControllerSettings(%.4g, %.4g, %.4g, %g, %.3g, %g, %.3g, %g, %g)\n", settings.kP,
+                settings.kI, settings.kD, settings.windupRange, settings.smallError, settings.smallErrorTimeout,
+                settings.largeError, settings.largeErrorTimeout, settings.slew);
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    parseArgs(argc, argv);
+    sim::setupRobot(options.robot);
+    sim::runPeriod(runTests, "auto tune", -1);
+    print("lateral", "in", lateralResult);
+    print("angular", "deg", angularResult);
+    if (lateralResult.ok && angularResult.ok)
+        std::printf("try them with: gain-sweep --gains %.4g,%.4g,%.4g,%.4g\n", lateralResult.settings.kP,
+                    lateralResult.settings.kD, angularResult.settings.kP, angularResult.settings.kD);
+    return lateralResult.ok && angularResult.ok ? 0 : 1;
+}
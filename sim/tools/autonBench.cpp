@@ -0,0 +1,462 @@
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "main.h"
+#include "autons.hpp"
+#include "lemlib/chassis/odom.hpp"
+#include "motionTasks.hpp"
+#include "sim/devices.hpp"
+#include "sim/match.hpp"
+#include "sim/robot.hpp"
+#include "sim/scheduler.hpp"
+
+// runs every autonomous routine against the simulated robot, and scores each motion it makes
+
+namespace {
+enum class MotionType {
+    MOVE_TO_POSE,
+    MOVE_TO_POINT,
+    TURN_TO_HEADING,
+    MOVE_TO_POSE_PROFILED,
+    MOVE_TO_POINT_PROFILED,
+    TURN_TO_HEADING_PROFILED
+};
+
+const char* motionName(MotionType type) {
+    switch (type) {
+        case MotionType::MOVE_TO_POSE: return "moveToPose";
+        case MotionType::MOVE_TO_POINT: return "moveToPoint";
+        case MotionType::TURN_TO_HEADING: return "turnToHeading";
+        case MotionType::MOVE_TO_POSE_PROFILED: return "moveToPoseProfiled";
+        case MotionType::MOVE_TO_POINT_PROFILED: return "moveToPointProfiled";
+        case MotionType::TURN_TO_HEADING_PROFILED: return "turnToHeadingProfiled";
+    }
+    return "";
+}
+
+// motions to a point have no heading to score, and turns no position
+bool hasHeading(MotionType type) {
+    return type != MotionType::MOVE_TO_POINT && type != MotionType::MOVE_TO_POINT_PROFILED;
+}
+
+bool hasPosition(MotionType type) {
+    return type != MotionType::TURN_TO_HEADING && type != MotionType::TURN_TO_HEADING_PROFILED;
+}
+
+struct Sample {
+        uint64_t time;
+        sim::PlantPose pose;
+};
+
+struct Motion {
+        MotionType type;
+        float x = 0;
+        float y = 0;
+        float theta = 0;
+        int timeout = 0;
+        bool started = false;
+        bool ended = false;
+        // motions that were cancelled before they started
+        bool skipped = false;
+        uint64_t start = 0;
+        uint64_t end = 0;
+        // the true pose of the robot every 10ms while the motion runs
+        std::vector<Sample> samples;
+        lemlib::Pose odom {0, 0, 0};
+};
+
+struct Options {
+        std::string routine;
+        const char* out = "auton-bench.json";
+        // how long a routine has, and how long it may run before it is stopped anyway, in seconds. 0 for the budget of
+        // each routine, and twice that
+        double budget = 0;
+        double limit = 0;
+        uint64_t scheduleSeed = 0;
+        sim::RobotOptions robot;
+};
+
+// a motion counts as settled once the robot stays this close to where it ends up
+constexpr double SETTLE_DISTANCE = 0.5;
+constexpr double SETTLE_ANGLE = 1;
+
+std::vector<Motion> motions;
+// tasks that are inside an async motion call. The motion itself runs in a task LemLib creates for it
+std::set<sim::Task*> asyncCallers;
+// index of the motion that is running, or -1. Motions are queued while one runs, so this can't be a pointer
+int running = -1;
+// when autonomous started, in microseconds
+uint64_t routineStart = 0;
+
+double degrees(double radians) { return radians * 180 / M_PI; }
+
+double headingError(double a, double b) { return std::fabs(std::remainder(a - b, 360)); }
+
+void recordPose(uint32_t time) {
+    if (running < 0 || time % 10 != 0) return;
+    motions[running].samples.push_back({sim::micros(), sim::drivetrain().getPose()});
+}
+
+size_t issue(MotionType type, float x, float y, float theta, int timeout, bool async) {
+    Motion motion;
+    motion.type = type;
+    motion.x = x;
+    motion.y = y;
+    motion.theta = theta;
+    motion.timeout = timeout;
+    motions.push_back(motion);
+    if (async) asyncCallers.insert(sim::current());
+    return motions.size() - 1;
+}
+
+void issued(size_t index) {
+    asyncCallers.erase(sim::current());
+    // an async motion has started by the time the call returns, so a motion that has not was cancelled
+    if (!motions[index].started) motions[index].skipped = true;
+}
+
+void startMotion(lemlib::Chassis* chassis) {
+    // the caller of an async motion takes the motion mutex too, before it hands the motion to a new task
+    if (asyncCallers.count(sim::current()) || !chassis->isInMotion()) return;
+    for (size_t i = 0; i < motions.size(); i++) {
+        Motion& motion = motions[i];
+        if (motion.started || motion.skipped) continue;
+        motion.started = true;
+        motion.start = sim::micros();
+        motion.samples.push_back({motion.start, sim::drivetrain().getPose()});
+        running = i;
+        return;
+    }
+}
+
+void endMotion() {
+    if (asyncCallers.count(sim::current()) || running < 0) return;
+    Motion& motion = motions[running];
+    motion.ended = true;
+    motion.end = sim::micros();
+    motion.samples.push_back({motion.end, sim::drivetrain().getPose()});
+    motion.odom = lemlib::getPose();
+    running = -1;
+}
+
+struct Score {
+        double duration;
+        // time until the robot stopped moving, measured against where it ends up
+        double settle;
+        bool timedOut;
+        // time spent waiting for the timeout after the robot had already stopped
+        double timeoutLoss;
+};
+
+Score score(const Motion& motion) {
+    const sim::PlantPose pose = motion.samples.back().pose;
+    uint64_t settled = motion.start;
+    for (const Sample& sample : motion.samples) {
+        const double distance = std::hypot(sample.pose.x - pose.x, sample.pose.y - pose.y);
+        const double angle = headingError(degrees(sample.pose.theta), degrees(pose.theta));
+        if (distance > SETTLE_DISTANCE || angle > SETTLE_ANGLE) settled = sample.time;
+    }
+    Score result;
+    result.duration = (motion.end - motion.start) / 1000.0;
+    result.settle = (settled - motion.start) / 1000.0;
+    // LemLib checks the timeout once per 10ms iteration
+    result.timedOut = result.duration >= motion.timeout - 10;
+    result.timeoutLoss = result.timedOut ? result.duration - result.settle : 0;
+    return result;
+}
+} // namespace
+
+// the benchmark is linked with --wrap for each of these, so every call the routines make goes through here first
+extern "C" {
+void __real__ZN6lemlib7Chassis10moveToPoseEfffiNS_16MoveToPoseParamsEb(lemlib::Chassis*, float, float, float, int,
+                                                                        lemlib::MoveToPoseParams, bool);
+void __real__ZN6lemlib7Chassis11moveToPointEffiNS_17MoveToPointParamsEb(lemlib::Chassis*, float, float, int,
+                                                                         lemlib::MoveToPointParams, bool);
+void __real__ZN6lemlib7Chassis13turnToHeadingEfiNS_19TurnToHeadingParamsEb(lemlib::Chassis*, float, int,
+                                                                            lemlib::TurnToHeadingParams, bool);
+#ifndef MOTION_HOOKS
+void __real__ZN6lemlib7Chassis18requestMotionStartEv(lemlib::Chassis*);
+void __real__ZN6lemlib7Chassis9endMotionEv(lemlib::Chassis*);
+#endif
+void __real__ZN15ProfiledChassis18moveToPoseProfiledEfffiN6lemlib16MoveToPoseParamsEb(ProfiledChassis*, float, float,
+                                                                                     float, int,
+                                                                                     lemlib::MoveToPoseParams, bool);
+void __real__ZN15ProfiledChassis19moveToPointProfiledEffiN6lemlib17MoveToPointParamsEb(ProfiledChassis*, float, float,
+                                                                                      int, lemlib::MoveToPointParams,
+                                                                                      bool);
+void __real__ZN15ProfiledChassis21turnToHeadingProfiledEfiN6lemlib19TurnToHeadingParamsEb(ProfiledChassis*, float, int,
+                                                                                         lemlib::TurnToHeadingParams,
+                                                                                         bool);
+
+void __wrap__ZN6lemlib7Chassis10moveToPoseEfffiNS_16MoveToPoseParamsEb(lemlib::Chassis* chassis, float x, float y,
+                                                                        float theta, int timeout,
+                                                                        lemlib::MoveToPoseParams params, bool async) {
+    const size_t index = issue(MotionType::MOVE_TO_POSE, x, y, theta, timeout, async);
+    __real__ZN6lemlib7Chassis10moveToPoseEfffiNS_16MoveToPoseParamsEb(chassis, x, y, theta, timeout, params, async);
+    issued(index);
+}
+
+void __wrap__ZN6lemlib7Chassis11moveToPointEffiNS_17MoveToPointParamsEb(lemlib::Chassis* chassis, float x, float y,
+                                                                         int timeout, lemlib::MoveToPointParams params,
+                                                                         bool async) {
+    const size_t index = issue(MotionType::MOVE_TO_POINT, x, y, 0, timeout, async);
+    __real__ZN6lemlib7Chassis11moveToPointEffiNS_17MoveToPointParamsEb(chassis, x, y, timeout, params, async);
+    issued(index);
+}
+
+void __wrap__ZN6lemlib7Chassis13turnToHeadingEfiNS_19TurnToHeadingParamsEb(lemlib::Chassis* chassis, float theta,
+                                                                            int timeout,
+                                                                            lemlib::TurnToHeadingParams params,
+                                                                            bool async) {
+    const size_t index = issue(MotionType::TURN_TO_HEADING, 0, 0, theta, timeout, async);
+    __real__ZN6lemlib7Chassis13turnToHeadingEfiNS_19TurnToHeadingParamsEb(chassis, theta, timeout, params, async);
+    issued(index);
+}
+
+// without a model, the profiled motions run LemLib's, which are scored as themselves
+void __wrap__ZN15ProfiledChassis18moveToPoseProfiledEfffiN6lemlib16MoveToPoseParamsEb(ProfiledChassis* chassis, float x,
+                                                                                     float y, float theta, int timeout,
+                                                                                     lemlib::MoveToPoseParams params,
+                                                                                     bool async) {
+    if (chassis->profileConstraints().maxVelocity <= 0) {
+        __real__ZN15ProfiledChassis18moveToPoseProfiledEfffiN6lemlib16MoveToPoseParamsEb(chassis, x, y, theta, timeout,
+                                                                                        params, async);
+        return;
+    }
+    const size_t index = issue(MotionType::MOVE_TO_POSE_PROFILED, x, y, theta, timeout, async);
+    __real__ZN15ProfiledChassis18moveToPoseProfiledEfffiN6lemlib16MoveToPoseParamsEb(chassis, x, y, theta, timeout,
+                                                                                    params, async);
+    issued(index);
+}
+
+void __wrap__ZN15ProfiledChassis19moveToPointProfiledEffiN6lemlib17MoveToPointParamsEb(ProfiledChassis* chassis,
+                                                                                      float x, float y, int timeout,
+                                                                                      lemlib::MoveToPointParams params,
+                                                                                      bool async) {
+    if (chassis->profileConstraints().maxVelocity <= 0) {
+        __real__ZN15ProfiledChassis19moveToPointProfiledEffiN6lemlib17MoveToPointParamsEb(chassis, x, y, timeout,
+                                                                                         params, async);
+        return;
+    }
+    const size_t index = issue(MotionType::MOVE_TO_POINT_PROFILED, x, y, 0, timeout, async);
+    __real__ZN15ProfiledChassis19moveToPointProfiledEffiN6lemlib17MoveToPointParamsEb(chassis, x, y, timeout, params,
+                                                                                     async);
+    issued(index);
+}
+
+void __wrap__ZN15ProfiledChassis21turnToHeadingProfiledEfiN6lemlib19TurnToHeadingParamsEb(
+    ProfiledChassis* chassis, float theta, int timeout, lemlib::TurnToHeadingParams params, bool async) {
+    if (chassis->profileConstraints(true).maxVelocity <= 0) {
+        __real__ZN15ProfiledChassis21turnToHeadingProfiledEfiN6lemlib19TurnToHeadingParamsEb(chassis, theta, timeout,
+                                                                                            params, async);
+        return;
+    }
+    const size_t index = issue(MotionType::TURN_TO_HEADING_PROFILED, 0, 0, theta, timeout, async);
+    __real__ZN15ProfiledChassis21turnToHeadingProfiledEfiN6lemlib19TurnToHeadingParamsEb(chassis, theta, timeout,
+                                                                                        params, async);
+    issued(index);
+}
+
+// the project hooks these itself with MOTION_HOOKS, and passes them on through setMotionListener()
+#ifndef MOTION_HOOKS
+void __wrap__ZN6lemlib7Chassis18requestMotionStartEv(lemlib::Chassis* chassis) {
+    __real__ZN6lemlib7Chassis18requestMotionStartEv(chassis);
+    startMotion(chassis);
+}
+
+void __wrap__ZN6lemlib7Chassis9endMotionEv(lemlib::Chassis* chassis) {
+    endMotion();
+    __real__ZN6lemlib7Chassis9endMotionEv(chassis);
+}
+#endif
+}
+
+namespace {
+void usage() {
+    std::fprintf(stderr, "usage: auton-bench [--routine name] [--out file.json] [--budget seconds] [--limit seconds]\n"
+                         "                   [--seed n] [--battery volts] [--noise scale] [--traction mu]\n"
+                         "                   [--schedule-seed n]\n");
+    std::exit(2);
+}
+
+Options parseArgs(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) usage();
+            return argv[++i];
+        };
+        if (!std::strcmp(argv[i], "--routine")) options.routine = next();
+        else if (!std::strcmp(argv[i], "--out")) options.out = next();
+        else if (!std::strcmp(argv[i], "--budget")) options.budget = std::atof(next());
+        else if (!std::strcmp(argv[i], "--limit")) options.limit = std::atof(next());
+        else if (!std::strcmp(argv[i], "--seed")) options.robot.seed = std::strtoull(next(), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--battery")) options.robot.batteryVoltage = std::atof(next());
+        else if (!std::strcmp(argv[i], "--noise")) options.robot.noise = std::atof(next());
+        else if (!std::strcmp(argv[i], "--traction")) options.robot.traction = std::atof(next());
+        else if (!std::strcmp(argv[i], "--schedule-seed")) options.scheduleSeed = std::strtoull(next(), nullptr, 10);
+        else usage();
+    }
+    return options;
+}
+
+void append(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+void append(std::string& out, const char* format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    out += buffer;
+}
+
+/**
+ * @brief Score a finished motion as a JSON object
+ */
+std::string scoreMotion(const Motion& motion) {
+    const sim::PlantPose pose = motion.samples.back().pose;
+    const Score result = score(motion);
+    std::string out;
+    append(out, "{\"motion\": \"%s\", \"target\": [%.2f, %.2f, %.2f], \"timeout_ms\": %d, \"start_ms\": %.1f, ",
+           motionName(motion.type), motion.x, motion.y, motion.theta, motion.timeout,
+           (motion.start - routineStart) / 1000.0);
+    append(out, "\"duration_ms\": %.1f, \"settle_ms\": %.1f, \"timed_out\": %s, \"timeout_loss_ms\": %.1f, ",
+           result.duration, result.settle, result.timedOut ? "true" : "false", result.timeoutLoss);
+    append(out, "\"end_pose\": [%.2f, %.2f, %.2f], \"odom_pose\": [%.2f, %.2f, %.2f], ", pose.x, pose.y,
+           degrees(pose.theta), motion.odom.x, motion.odom.y, motion.odom.theta);
+    if (!hasPosition(motion.type)) append(out, "\"position_error\": null, ");
+    else append(out, "\"position_error\": %.3f, ", std::hypot(motion.x - pose.x, motion.y - pose.y));
+    if (!hasHeading(motion.type)) append(out, "\"heading_error\": null}");
+    else append(out, "\"heading_error\": %.3f}", headingError(degrees(pose.theta), motion.theta));
+    return out;
+}
+
+/**
+ * @brief Run one routine on a fresh robot, and score it as a JSON object
+ */
+std::string runRoutine(int index, const Options& options) {
+    sim::setupRobot(options.robot);
+    sim::setScheduleSeed(options.scheduleSeed);
+    sim::onTick(recordPose);
+    sim::CompetitionState& competition = sim::competition();
+    competition.connected = true;
+    competition.disabled = true;
+    sim::runPeriod(initialize, "initialize", -1);
+    sim::runPeriod(competition_initialize, "competition_initialize", -1);
+    competition.disabled = false;
+    competition.autonomous = true;
+    selectedAuton = index;
+    const double budget = options.budget > 0 ? options.budget : autonRoutines[index].budget;
+    routineStart = sim::micros();
+    const sim::PeriodResult result =
+        sim::runPeriod(autonomous, "autonomous", options.limit > 0 ? options.limit : 2 * budget);
+    // a motion still running when the routine was stopped ends with it
+    if (running >= 0) endMotion();
+
+    const double duration = result.duration / 1000.0;
+    const bool overBudget = !result.finished || duration > budget * 1000;
+    double timeoutLoss = 0;
+    int timeouts = 0;
+    // how far the robot ended up from the last position and the last heading the routine asked for
+    double finalPositionError = 0;
+    double finalHeadingError = 0;
+    std::string scored;
+    for (const Motion& motion : motions) {
+        if (!motion.started) continue;
+        if (!scored.empty()) scored += ",\n      ";
+        scored += scoreMotion(motion);
+        const Score result = score(motion);
+        timeoutLoss += result.timeoutLoss;
+        timeouts += result.timedOut;
+        const sim::PlantPose pose = motion.samples.back().pose;
+        if (hasPosition(motion.type))
+            finalPositionError = std::hypot(motion.x - pose.x, motion.y - pose.y);
+        if (hasHeading(motion.type))
+            finalHeadingError = headingError(degrees(pose.theta), motion.theta);
+    }
+    std::printf("%-12s %8.0fms%s  %d timeouts, %.0fms lost to timeouts\n", autonRoutines[index].name, duration,
+                overBudget ? " (over budget)" : "", timeouts, timeoutLoss);
+    std::fflush(stdout);
+    std::string out;
+    append(out, "{\"routine\": \"%s\", \"finished\": %s, \"duration_ms\": %.1f, \"budget_ms\": %.0f, ",
+           autonRoutines[index].name, result.finished ? "true" : "false", duration, budget * 1000);
+    append(out, "\"over_budget\": %s, ", overBudget ? "true" : "false");
+    append(out, "\"timeouts\": %d, \"timeout_loss_ms\": %.1f, \"final_position_error\": %.3f, ", timeouts, timeoutLoss,
+           finalPositionError);
+    append(out, "\"final_heading_error\": %.3f, \"motions\": [\n      ", finalHeadingError);
+    return out + scored + "]}";
+}
+
+/**
+ * @brief Run a routine in a child process, so every routine starts from a fresh simulator
+ *
+ * The simulator's state is global, and its task threads can't be torn down, but none exist until a routine runs.
+ */
+std::string runIsolated(int index, const Options& options) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::perror("pipe");
+        std::exit(1);
+    }
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        const std::string result = runRoutine(index, options);
+        if (write(fds[1], result.data(), result.size()) != ssize_t(result.size())) std::_Exit(1);
+        close(fds[1]);
+        // task threads are still parked in the scheduler, so skip static destructors
+        std::_Exit(0);
+    }
+    close(fds[1]);
+    std::string result;
+    char buffer[4096];
+    ssize_t count;
+    while ((count = read(fds[0], buffer, sizeof(buffer))) > 0) result.append(buffer, count);
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || result.empty()) {
+        std::fprintf(stderr, "%s: simulation failed\n", autonRoutines[index].name);
+        return "";
+    }
+    return result;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const Options options = parseArgs(argc, argv);
+#ifdef MOTION_HOOKS
+    setMotionListener(startMotion, [](lemlib::Chassis*) { endMotion(); });
+#endif
+    std::vector<std::string> results;
+    for (int i = 0; i < autonRoutineCount; i++) {
+        if (!options.routine.empty() && options.routine != autonRoutines[i].name) continue;
+        const std::string result = runIsolated(i, options);
+        if (!result.empty()) results.push_back(result);
+    }
+    if (results.empty()) {
+        std::fprintf(stderr, "no routine named \"%s\"\n", options.routine.c_str());
+        return 1;
+    }
+
+    FILE* file = std::fopen(options.out, "w");
+    if (file == nullptr) {
+        std::perror(options.out);
+        return 1;
+    }
+    std::fprintf(file, "{\"seed\": %llu, \"routines\": [\n", (unsigned long long)options.robot.seed);
+    for (size_t i = 0; i < results.size(); i++)
+        std::fprintf(file, "  %s%s\n", results[i].c_str(), i + 1 < results.size() ? "," : "");
+    std::fprintf(file, "]}\n");
+    std::fclose(file);
+    std::printf("wrote %s\n", options.out);
+    return 0;
+}
@@ -0,0 +1,315 @@
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// compares the results of auton-bench and math-bench with a committed baseline, and fails when any of them got worse
+// by more than the baseline's tolerances. `make bench` runs all three
+//
+// A result regresses when it is more than baseline * (1 + relative) + absolute. Routine times and pose errors come
+// from the simulator, so they only change when the code does. ns/call depends on the host, so keep the baseline from
+// the machine that runs the check. Without a baseline, the check fails, unless --allow-missing-baseline is given
+
+namespace {
+struct Options {
+        const char* baseline = nullptr;
+        const char* auton = nullptr;
+        const char* math = nullptr;
+        // write the results as the new baseline instead of checking them
+        bool update = false;
+        // pass when there is no baseline, rather than fail
+        bool allowMissingBaseline = false;
+};
+
+/**
+ * @brief Just enough JSON for the files the benchmarks write
+ */
+struct Json {
+        enum class Type { NONE, NUMBER, STRING, BOOLEAN, ARRAY, OBJECT };
+        Type type = Type::NONE;
+        double number = 0;
+        bool boolean = false;
+        std::string string;
+        std::vector<Json> array;
+        std::vector<std::pair<std::string, Json>> object;
+
+        const Json& operator[](const char* key) const {
+            static const Json none;
+            for (const auto& [name, value] : object) {
+                if (name == key) return value;
+            }
+            return none;
+        }
+};
+
+struct Parser {
+        const char* at;
+        bool failed = false;
+
+        void skipSpace() {
+            while (std::isspace(static_cast<unsigned char>(*at))) at++;
+        }
+
+        bool consume(char c) {
+            skipSpace();
+            if (*at != c) return false;
+            at++;
+            return true;
+        }
+
+        std::string parseString() {
+            std::string out;
+            while (*at != '\0' && *at != '"') {
+                if (*at == '\\' && at[1] != '\0') at++;
+                out += *at++;
+            }
+            if (*at == '"') at++;
+            else failed = true;
+            return out;
+        }
+
+        Json parse() {
+            Json value;
+            skipSpace();
+            if (consume('{')) {
+                value.type = Json::Type::OBJECT;
+                if (consume('}')) return value;
+                do {
+                    if (!consume('"')) break;
+                    std::string key = parseString();
+                    if (!consume(':')) break;
+                    value.object.emplace_back(std::move(key), parse());
+                } while (consume(','));
+                if (!consume('}')) failed = true;
+            } else if (consume('[')) {
+                value.type = Json::Type::ARRAY;
+                if (consume(']')) return value;
+                do value.array.push_back(parse());
+                while (consume(','));
+                if (!consume(']')) failed = true;
+            } else if (consume('"')) {
+                value.type = Json::Type::STRING;
+                value.string = parseString();
+            } else if (!std::strncmp(at, "true", 4) || !std::strncmp(at, "false", 5)) {
+                value.type = Json::Type::BOOLEAN;
+                value.boolean = *at == 't';
+                at += value.boolean ? 4 : 5;
+            } else if (!std::strncmp(at, "null", 4)) {
+                at += 4;
+            } else {
+                char* end;
+                value.number = std::strtod(at, &end);
+                if (end == at) failed = true;
+                value.type = Json::Type::NUMBER;
+                at = end;
+            }
+            return value;
+        }
+};
+
+/**
+ * @brief How much worse a result may get before it counts as a regression
+ */
+struct Tolerance {
+        double relative;
+        double absolute;
+};
+
+// used for anything the baseline doesn't give a tolerance for
+const std::map<std::string, Tolerance> defaultTolerances = {
+    {"duration_ms", {0.02, 20}},
+    {"final_position_error", {0, 0.5}},
+    {"final_heading_error", {0, 2}},
+    {"ns_per_call", {0.25, 1}},
+};
+
+const char* const routineMetrics[] = {"duration_ms", "final_position_error", "final_heading_error"};
+
+void usage() {
+    std::fprintf(stderr, "usage: bench-check --baseline file.json [--auton auton-bench.json] [--math math-bench.json]\n"
+                         "                   [--update] [--allow-missing-baseline]\n");
+    std::exit(2);
+}
+
+Options parseArgs(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) usage();
+            return argv[++i];
+        };
+        if (!std::strcmp(argv[i], "--baseline")) options.baseline = next();
+        else if (!std::strcmp(argv[i], "--auton")) options.auton = next();
+        else if (!std::strcmp(argv[i], "--math")) options.math = next();
+        else if (!std::strcmp(argv[i], "--update")) options.update = true;
+        else if (!std::strcmp(argv[i], "--allow-missing-baseline")) options.allowMissingBaseline = true;
+        else usage();
+    }
+    if (options.baseline == nullptr || (options.auton == nullptr && options.math == nullptr)) usage();
+    return options;
+}
+
+bool readJson(const char* path, Json& out) {
+    FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) return false;
+    std::string text;
+    char buffer[4096];
+    size_t count;
+    while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0) text.append(buffer, count);
+    std::fclose(file);
+    Parser parser {text.c_str()};
+    out = parser.parse();
+    if (parser.failed) {
+        std::fprintf(stderr, "%s is not valid JSON\n", path);
+        std::exit(2);
+    }
+    return true;
+}
+
+Json requireJson(const char* path) {
+    Json json;
+    if (!readJson(path, json)) {
+        std::perror(path);
+        std::exit(2);
+    }
+    return json;
+}
+
+std::map<std::string, Tolerance> readTolerances(const Json& baseline) {
+    std::map<std::string, Tolerance> tolerances = defaultTolerances;
+    for (const auto& [metric, tolerance] : baseline["tolerances"].object)
+        tolerances[metric] = {tolerance["relative"].number, tolerance["absolute"].number};
+    return tolerances;
+}
+
+/**
+ * @brief Find an entry of an array of objects by the value of one of its fields
+ */
+const Json* find(const Json& array, const char* key, const std::string& name) {
+    for (const Json& entry : array.array) {
+        if (entry[key].string == name) return &entry;
+    }
+    return nullptr;
+}
+
+class Checker {
+    public:
+        Checker(std::map<std::string, Tolerance> tolerances)
+            : tolerances(std::move(tolerances)) {}
+
+        void check(const std::string& name, const std::string& metric, double baseline, double current) {
+            const Tolerance& tolerance = tolerances.at(metric);
+            const double limit = baseline * (1 + tolerance.relative) + tolerance.absolute;
+            const char* verdict = "ok";
+            if (current > limit) {
+                verdict = "REGRESSED";
+                regressions++;
+            } else if (current < baseline - tolerance.absolute - baseline * tolerance.relative) verdict = "improved";
+            std::printf("%-34s %-22s %12.3f %12.3f %12.3f  %s\n", name.c_str(), metric.c_str(), baseline, current,
+                        limit, verdict);
+        }
+
+        void fail(const std::string& name, const char* why) {
+            std::printf("%-34s %s\n", name.c_str(), why);
+            regressions++;
+        }
+
+        int regressions = 0;
+    private:
+        std::map<std::string, Tolerance> tolerances;
+};
+
+void writeBaseline(const char* path, const std::map<std::string, Tolerance>& tolerances, const Json* auton,
+                   const Json* math, const Json& previous) {
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        std::perror(path);
+        std::exit(2);
+    }
+    std::fprintf(file, "{\"tolerances\": {");
+    bool first = true;
+    for (const auto& [metric, tolerance] : tolerances) {
+        std::fprintf(file, "%s\n  \"%s\": {\"relative\": %g, \"absolute\": %g}", first ? "" : ",", metric.c_str(),
+                     tolerance.relative, tolerance.absolute);
+        first = false;
+    }
+    // results that weren't rerun are kept from the old baseline
+    const Json& routines = auton != nullptr ? (*auton)["routines"] : previous["routines"];
+    std::fprintf(file, "},\n\"routines\": [");
+    first = true;
+    for (const Json& routine : routines.array) {
+        std::fprintf(file, "%s\n  {\"routine\": \"%s\"", first ? "" : ",", routine["routine"].string.c_str());
+        for (const char* metric : routineMetrics) std::fprintf(file, ", \"%s\": %.3f", metric, routine[metric].number);
+        std::fprintf(file, "}");
+        first = false;
+    }
+    const Json& benchmarks = math != nullptr ? (*math)["benchmarks"] : previous["benchmarks"];
+    std::fprintf(file, "],\n\"benchmarks\": [");
+    first = true;
+    for (const Json& benchmark : benchmarks.array) {
+        std::fprintf(file, "%s\n  {\"name\": \"%s\", \"ns_per_call\": %.3f}", first ? "" : ",",
+                     benchmark["name"].string.c_str(), benchmark["ns_per_call"].number);
+        first = false;
+    }
+    std::fprintf(file, "]}\n");
+    std::fclose(file);
+    std::printf("wrote %s\n", path);
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const Options options = parseArgs(argc, argv);
+    Json baseline;
+    const bool hasBaseline = readJson(options.baseline, baseline);
+    if (!hasBaseline && !options.update) {
+        // a missing baseline fails the check, so a deleted or mistyped one can't pass unnoticed
+        std::printf("%s: no baseline at %s, so nothing was checked. Generate one with `make bench-baseline\n"
+                    "LEMLIB_SRC=<LemLib sources>` on the machine that runs the check, and commit it\n",
+                    options.allowMissingBaseline ? "SKIPPED" : "FAILED", options.baseline);
+        return options.allowMissingBaseline ? 0 : 2;
+    }
+    const std::map<std::string, Tolerance> tolerances = readTolerances(baseline);
+    Json auton;
+    Json math;
+    if (options.auton != nullptr) auton = requireJson(options.auton);
+    if (options.math != nullptr) math = requireJson(options.math);
+    if (options.update) {
+        writeBaseline(options.baseline, tolerances, options.auton != nullptr ? &auton : nullptr,
+                      options.math != nullptr ? &math : nullptr, baseline);
+        return 0;
+    }
+
+    Checker checker(tolerances);
+    std::printf("%-34s %-22s %12s %12s %12s\n", "", "metric", "baseline", "current", "limit");
+    if (options.auton != nullptr) {
+        for (const Json& expected : baseline["routines"].array) {
+            const std::string name = expected["routine"].string;
+            const Json* routine = find(auton["routines"], "routine", name);
+            if (routine == nullptr) {
+                checker.fail(name, "wasn't run");
+                continue;
+            }
+            if (!(*routine)["finished"].boolean) checker.fail(name, "didn't finish");
+            for (const char* metric : routineMetrics)
+                checker.check(name, metric, expected[metric].number, (*routine)[metric].number);
+        }
+    }
+    if (options.math != nullptr) {
+        for (const Json& expected : baseline["benchmarks"].array) {
+            const std::string name = expected["name"].string;
+            const Json* benchmark = find(math["benchmarks"], "name", name);
+            if (benchmark == nullptr) checker.fail(name, "wasn't run");
+            else checker.check(name, "ns_per_call", expected["ns_per_call"].number, (*benchmark)["ns_per_call"].number);
+        }
+    }
+    if (checker.regressions > 0) {
+        std::printf("\n%d regressions against %s\n", checker.regressions, options.baseline);
+        return 1;
+    }
+    std::printf("\nno regressions against %s\n", options.baseline);
+    return 0;
+}
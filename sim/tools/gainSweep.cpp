@@ -0,0 +1,396 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "autons.hpp"
+#include "sim/devices.hpp"
+#include "sim/match.hpp"
+#include "sim/robot.hpp"
+#include "sim/scheduler.hpp"
+
+// runs the same randomised moveToPose and turnToHeading trials with several sets of controller gains, and reports how
+// quickly and cleanly each set settles. Every trial runs in its own process, as many at once as the host has cores
+
+namespace {
+enum class MotionType { POSE, TURN };
+
+struct Gains {
+        float lateralKP;
+        float lateralKD;
+        float angularKP;
+        float angularKD;
+};
+
+struct Options {
+        std::vector<Gains> gains;
+        // trials for each set of gains and each kind of motion
+        int trials = 500;
+        bool poses = true;
+        bool turns = true;
+        uint64_t seed = 0;
+        int jobs = std::max(1u, std::thread::hardware_concurrency());
+        const char* csv = nullptr;
+};
+
+// the ranges trials are drawn from
+constexpr float BATTERY_MIN = 11.6;
+constexpr float BATTERY_MAX = 12.8;
+// traction below 1 lets the wheels slip
+constexpr float TRACTION_MIN = 0.6;
+constexpr float TRACTION_MAX = 1.0;
+constexpr float NOISE_MIN = 0.5;
+constexpr float NOISE_MAX = 2.0;
+// moveToPose targets, in inches and degrees from where the robot starts
+constexpr float DISTANCE_MIN = 12;
+constexpr float DISTANCE_MAX = 48;
+constexpr float BEARING_MAX = 60;
+constexpr float HEADING_CHANGE_MAX = 45;
+// turnToHeading targets, in degrees either way
+constexpr float TURN_MIN = 30;
+constexpr float TURN_MAX = 180;
+
+constexpr int POSE_TIMEOUT = 4000;
+constexpr int TURN_TIMEOUT = 2000;
+// a moveToPose has settled once the robot stays this close to the target, and a turn once it stays this close to
+// the target heading. These match the small error ranges in main.cpp
+constexpr double SETTLE_DISTANCE = 1;
+constexpr double SETTLE_ANGLE = 1;
+
+/**
+ * @brief One randomised robot and target
+ *
+ * The same trial index draws the same robot and target for every set of gains, so the sets are compared on equal
+ * terms.
+ */
+struct Trial {
+        MotionType type;
+        uint64_t seed;
+        float battery;
+        float traction;
+        float noise;
+        // target, in LemLib's convention
+        float x;
+        float y;
+        float theta;
+        Gains gains;
+};
+
+struct TrialResult {
+        bool ran;
+        bool settled;
+        bool timedOut;
+        // time until the robot stayed within the settle range, in milliseconds. The whole motion if it never did
+        float settle;
+        float duration;
+        // how far the robot went past the target, in inches for a moveToPose and degrees for a turn
+        float overshoot;
+        // distance and heading from the target when the motion ended
+        float positionError;
+        float headingError;
+};
+
+struct Sample {
+        uint64_t time;
+        sim::PlantPose pose;
+};
+
+// the trial running in this process
+Trial trial;
+std::vector<Sample> samples;
+bool sampling = false;
+uint64_t motionStart = 0;
+uint64_t motionEnd = 0;
+
+double degrees(double radians) { return radians * 180 / M_PI; }
+
+double radians(double degrees) { return degrees * M_PI / 180; }
+
+double headingError(double a, double b) { return std::remainder(a - b, 360); }
+
+void usage() {
+    std::fprintf(stderr, "usage: gain-sweep [--gains lateralKP,lateralKD,angularKP,angularKD]... [--trials n]\n"
+                         "                  [--motion pose|turn|both] [--seed n] [--jobs n] [--csv file.csv]\n");
+    std::exit(2);
+}
+
+Options parseArgs(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) usage();
+            return argv[++i];
+        };
+        if (!std::strcmp(argv[i], "--gains")) {
+            Gains gains;
+            if (std::sscanf(next(), "%f,%f,%f,%f", &gains.lateralKP, &gains.lateralKD, &gains.angularKP,
+                            &gains.angularKD) != 4)
+                usage();
+            options.gains.push_back(gains);
+        } else if (!std::strcmp(argv[i], "--trials")) options.trials = std::max(1, std::atoi(next()));
+        else if (!std::strcmp(argv[i], "--motion")) {
+            const std::string motion = next();
+            if (motion != "pose" && motion != "turn" && motion != "both") usage();
+            options.poses = motion != "turn";
+            options.turns = motion != "pose";
+        } else if (!std::strcmp(argv[i], "--seed")) options.seed = std::strtoull(next(), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--jobs")) options.jobs = std::max(1, std::atoi(next()));
+        else if (!std::strcmp(argv[i], "--csv")) options.csv = next();
+        else usage();
+    }
+    // the gains the robot is tuned with
+    if (options.gains.empty())
+        options.gains.push_back(
+            {linearController.kP, linearController.kD, angularController.kP, angularController.kD});
+    return options;
+}
+
+Trial drawTrial(MotionType type, uint64_t seed, const Gains& gains) {
+    std::mt19937_64 rng(seed);
+    auto uniform = [&](float min, float max) { return std::uniform_real_distribution<float>(min, max)(rng); };
+    auto sign = [&]() { return std::bernoulli_distribution()(rng) ? 1.0f : -1.0f; };
+    Trial drawn;
+    drawn.type = type;
+    drawn.seed = seed;
+    drawn.battery = uniform(BATTERY_MIN, BATTERY_MAX);
+    drawn.traction = uniform(TRACTION_MIN, TRACTION_MAX);
+    drawn.noise = uniform(NOISE_MIN, NOISE_MAX);
+    drawn.gains = gains;
+    if (type == MotionType::POSE) {
+        const float distance = uniform(DISTANCE_MIN, DISTANCE_MAX);
+        const float bearing = uniform(-BEARING_MAX, BEARING_MAX);
+        drawn.x = distance * std::sin(radians(bearing));
+        drawn.y = distance * std::cos(radians(bearing));
+        drawn.theta = bearing + uniform(-HEADING_CHANGE_MAX, HEADING_CHANGE_MAX);
+    } else {
+        drawn.x = 0;
+        drawn.y = 0;
+        drawn.theta = sign() * uniform(TURN_MIN, TURN_MAX);
+    }
+    return drawn;
+}
+
+void samplePose(uint32_t time) {
+    if (!sampling || time % 10 != 0) return;
+    samples.push_back({sim::micros(), sim::drivetrain().getPose()});
+}
+
+lemlib::ControllerSettings withGains(lemlib::ControllerSettings settings, float kP, float kD) {
+    settings.kP = kP;
+    settings.kD = kD;
+    return settings;
+}
+
+void runMotion() {
+    // the chassis is built inside the trial, with the gains being tried and the robot's other settings
+    // it is never deleted, since the odometry task keeps using it until the process exits
+    lemlib::Chassis* trialChassis = new lemlib::Chassis(
+        drivetrain, withGains(linearController, trial.gains.lateralKP, trial.gains.lateralKD),
+        withGains(angularController, trial.gains.angularKP, trial.gains.angularKD), sensors);
+    trialChassis->calibrate();
+    trialChassis->setPose(0, 0, 0);
+    sampling = true;
+    motionStart = sim::micros();
+    if (trial.type == MotionType::POSE) trialChassis->moveToPose(trial.x, trial.y, trial.theta, POSE_TIMEOUT, {}, false);
+    else trialChassis->turnToHeading(trial.theta, TURN_TIMEOUT, {}, false);
+    motionEnd = sim::micros();
+    sampling = false;
+}
+
+double targetError(const sim::PlantPose& pose) {
+    if (trial.type == MotionType::POSE) return std::hypot(pose.x - trial.x, pose.y - trial.y);
+    return std::fabs(headingError(degrees(pose.theta), trial.theta));
+}
+
+TrialResult score() {
+    TrialResult result = {};
+    result.ran = !samples.empty();
+    if (!result.ran) return result;
+    result.duration = (motionEnd - motionStart) / 1000.0;
+    result.timedOut = result.duration >= (trial.type == MotionType::POSE ? POSE_TIMEOUT : TURN_TIMEOUT) - 10;
+    const double tolerance = trial.type == MotionType::POSE ? SETTLE_DISTANCE : SETTLE_ANGLE;
+    uint64_t lastOutside = motionStart;
+    for (const Sample& sample : samples) {
+        if (targetError(sample.pose) > tolerance) lastOutside = sample.time;
+    }
+    const sim::PlantPose& end = samples.back().pose;
+    result.settled = targetError(end) <= tolerance;
+    result.settle = result.settled ? (lastOutside - motionStart) / 1000.0 : result.duration;
+    result.positionError = std::hypot(end.x - trial.x, end.y - trial.y);
+    result.headingError = std::fabs(headingError(degrees(end.theta), trial.theta));
+    // overshoot is measured along the way the robot had to go: the line to the target, or the direction of the turn
+    double overshoot = 0;
+    const double distance = std::hypot(trial.x, trial.y);
+    for (const Sample& sample : samples) {
+        if (trial.type == MotionType::POSE) {
+            overshoot = std::max(overshoot,
+                                 ((sample.pose.x - trial.x) * trial.x + (sample.pose.y - trial.y) * trial.y) / distance);
+        } else {
+            const double past = headingError(degrees(sample.pose.theta), trial.theta);
+            overshoot = std::max(overshoot, trial.theta > 0 ? past : -past);
+        }
+    }
+    result.overshoot = overshoot;
+    return result;
+}
+
+TrialResult runTrial() {
+    sim::RobotOptions robot;
+    robot.seed = trial.seed;
+    robot.batteryVoltage = trial.battery;
+    robot.traction = trial.traction;
+    robot.noise = trial.noise;
+    sim::setupRobot(robot);
+    sim::onTick(samplePose);
+    // calibration takes a few seconds on top of the motion
+    sim::runPeriod(runMotion, "trial", 15);
+    return score();
+}
+
+struct Running {
+        pid_t pid;
+        int fd;
+        size_t index;
+};
+
+/**
+ * @brief Start a trial in a child process
+ *
+ * The simulator's state is global, and its task threads can't be torn down, so every trial gets a fresh process.
+ */
+Running start(const Trial& next, size_t index) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::perror("pipe");
+        std::exit(1);
+    }
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        trial = next;
+        const TrialResult result = runTrial();
+        // the result is smaller than a pipe's buffer, so this never waits for the parent
+        if (write(fds[1], &result, sizeof(result)) != ssize_t(sizeof(result))) std::_Exit(1);
+        // task threads are still parked in the scheduler, so skip static destructors
+        std::_Exit(0);
+    }
+    close(fds[1]);
+    return {pid, fds[0], index};
+}
+
+std::vector<TrialResult> runAll(const std::vector<Trial>& trials, int jobs) {
+    std::vector<TrialResult> results(trials.size());
+    std::vector<Running> running;
+    size_t next = 0;
+    size_t done = 0;
+    while (next < trials.size() || !running.empty()) {
+        while (int(running.size()) < jobs && next < trials.size()) {
+            running.push_back(start(trials[next], next));
+            next++;
+        }
+        int status = 0;
+        const pid_t pid = waitpid(-1, &status, 0);
+        auto finished = std::find_if(running.begin(), running.end(), [pid](const Running& r) { return r.pid == pid; });
+        if (finished == running.end()) continue;
+        TrialResult& result = results[finished->index];
+        if (read(finished->fd, &result, sizeof(result)) != ssize_t(sizeof(result)) || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != 0)
+            result = {};
+        close(finished->fd);
+        running.erase(finished);
+        if (++done % 100 == 0 || done == trials.size()) std::fprintf(stderr, "\r%zu/%zu trials", done, trials.size());
+    }
+    std::fprintf(stderr, "\n");
+    return results;
+}
+
+double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) return NAN;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, size_t(fraction * values.size()))];
+}
+
+const char* motionName(MotionType type) { return type == MotionType::POSE ? "moveToPose" : "turnToHeading"; }
+
+void report(const std::vector<Trial>& trials, const std::vector<TrialResult>& results, const Options& options) {
+    std::printf("%-24s %-14s %6s %8s %8s %26s %26s %18s\n", "gains (lat kP/kD ang)", "motion", "trials", "settled",
+                "timeouts", "settle p50/p90/p99 (ms)", "overshoot p50/p90/max", "error p50/p90");
+    for (const Gains& gains : options.gains) {
+        for (MotionType type : {MotionType::POSE, MotionType::TURN}) {
+            std::vector<double> settle, overshoot, error;
+            int count = 0, settled = 0, timeouts = 0, failed = 0;
+            for (size_t i = 0; i < trials.size(); i++) {
+                if (trials[i].type != type || std::memcmp(&trials[i].gains, &gains, sizeof(Gains)) != 0) continue;
+                count++;
+                const TrialResult& result = results[i];
+                if (!result.ran) {
+                    failed++;
+                    continue;
+                }
+                settled += result.settled;
+                timeouts += result.timedOut;
+                settle.push_back(result.settle);
+                overshoot.push_back(result.overshoot);
+                error.push_back(type == MotionType::POSE ? result.positionError : result.headingError);
+            }
+            if (count == 0) continue;
+            char name[64];
+            std::snprintf(name, sizeof(name), "%g/%g %g/%g", gains.lateralKP, gains.lateralKD, gains.angularKP,
+                          gains.angularKD);
+            const char* unit = type == MotionType::POSE ? "in" : "deg";
+            char settleText[64], overshootText[64], errorText[64];
+            std::snprintf(settleText, sizeof(settleText), "%.0f/%.0f/%.0f", percentile(settle, 0.5),
+                          percentile(settle, 0.9), percentile(settle, 0.99));
+            std::snprintf(overshootText, sizeof(overshootText), "%.2f/%.2f/%.2f %s", percentile(overshoot, 0.5),
+                          percentile(overshoot, 0.9), percentile(overshoot, 1), unit);
+            std::snprintf(errorText, sizeof(errorText), "%.2f/%.2f %s", percentile(error, 0.5),
+                          percentile(error, 0.9), unit);
+            std::printf("%-24s %-14s %6d %7.1f%% %8d %26s %26s %18s\n", name, motionName(type), count,
+                        100.0 * settled / count, timeouts, settleText, overshootText, errorText);
+            if (failed > 0) std::printf("  %d trials failed to run\n", failed);
+        }
+    }
+}
+
+void writeCsv(const char* path, const std::vector<Trial>& trials, const std::vector<TrialResult>& results) {
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        std::fprintf(stderr, "could not open %s\n", path);
+        std::exit(1);
+    }
+    std::fprintf(file, "lateral_kp,lateral_kd,angular_kp,angular_kd,motion,seed,battery,traction,noise,target_x,"
+                       "target_y,target_theta,ran,settled,timed_out,settle_ms,duration_ms,overshoot,position_error,"
+                       "heading_error\n");
+    for (size_t i = 0; i < trials.size(); i++) {
+        const Trial& t = trials[i];
+        const TrialResult& r = results[i];
+        std::fprintf(file, "%g,%g,%g,%g,%s,%llu,%.3f,%.3f,%.3f,%.2f,%.2f,%.2f,%d,%d,%d,%.1f,%.1f,%.3f,%.3f,%.3f\n",
+                     t.gains.lateralKP, t.gains.lateralKD, t.gains.angularKP, t.gains.angularKD, motionName(t.type),
+                     (unsigned long long)t.seed, t.battery, t.traction, t.noise, t.x, t.y, t.theta, r.ran, r.settled,
+                     r.timedOut, r.settle, r.duration, r.overshoot, r.positionError, r.headingError);
+    }
+    std::fclose(file);
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const Options options = parseArgs(argc, argv);
+    std::vector<Trial> trials;
+    for (const Gains& gains : options.gains) {
+        for (int i = 0; i < options.trials; i++) {
+            if (options.poses) trials.push_back(drawTrial(MotionType::POSE, options.seed + 2 * i, gains));
+            if (options.turns) trials.push_back(drawTrial(MotionType::TURN, options.seed + 2 * i + 1, gains));
+        }
+    }
+    const std::vector<TrialResult> results = runAll(trials, options.jobs);
+    report(trials, results, options);
+    if (options.csv != nullptr) writeCsv(options.csv, trials, results);
+    return 0;
+}
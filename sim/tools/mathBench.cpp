@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "fastOdometry.hpp"
+#include "lemlib/api.hpp"
+#include "motionProfile.hpp"
+#include "poseHistory.hpp"
+
+// times the LemLib math the chassis control loops call every iteration, in nanoseconds per call on the host. First
+// checks that the project's own math is as accurate as it promises, and fails if it isn't
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// inputs are drawn from a table so the compiler can't fold the calls away. The size is a power of 2 so indexing is a
+// mask, and small enough to stay in L1 so the benchmark measures the math rather than memory
+constexpr size_t INPUTS = 1024;
+
+// clock of the Cortex-A9 in the V5 brain, in MHz
+constexpr double BRAIN_MHZ = 666.67;
+// cycles one iteration of the reference kernel takes on the Cortex-A9: a dependent VFP multiply (5 cycles) followed
+// by a dependent add (4 cycles)
+constexpr double REFERENCE_A9_CYCLES = 9;
+
+// fastSinCos() is only promised to be accurate to FAST_SIN_COS_MAX_ERROR up to about this many radians
+constexpr float FAST_SIN_COS_RANGE = 10000;
+// MotionProfile sums its phases in floats, so it only lands this close to the distance and end velocity it was planned
+// for, in inches and inches per second
+constexpr float PROFILE_MAX_ERROR = 1e-3;
+constexpr float PROFILE_MAX_VELOCITY_ERROR = 1e-3;
+// getPoseSampleAt() interpolates in floats, so it only matches a robot moving at a steady rate this closely, in inches
+// and radians
+constexpr float POSE_HISTORY_MAX_ERROR = 1e-4;
+
+struct Options {
+        // only run benchmarks whose name contains this
+        const char* filter = nullptr;
+        // how long each timed repetition should take, in seconds
+        double minTime = 0.05;
+        int repetitions = 5;
+        bool a9 = false;
+        // where to write the results as JSON, for the bench-check regression gate
+        const char* out = nullptr;
+};
+
+struct Benchmark {
+        const char* name;
+        float (*run)(size_t i);
+};
+
+float a[INPUTS];
+float b[INPUTS];
+float c[INPUTS];
+std::vector<lemlib::Pose> poses;
+std::vector<lemlib::Pose> others;
+lemlib::ExpoDriveCurve expoCurve(3, 10, 1.019);
+// the chassis calls the curve through a DriveCurve pointer, so the benchmark does too
+lemlib::DriveCurve* driveCurve = &expoCurve;
+volatile float sink;
+
+void fillInputs() {
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> angle(0, 360);
+    std::uniform_real_distribution<float> coordinate(-72, 72);
+    std::uniform_real_distribution<float> joystick(-127, 127);
+    for (size_t i = 0; i < INPUTS; i++) {
+        a[i] = angle(rng);
+        b[i] = angle(rng);
+        c[i] = joystick(rng);
+        poses.emplace_back(coordinate(rng), coordinate(rng), lemlib::degToRad(angle(rng)));
+        others.emplace_back(coordinate(rng), coordinate(rng), lemlib::degToRad(angle(rng)));
+    }
+}
+
+float baseline(size_t i) { return a[i]; }
+
+// a dependent multiply-add chain, the reference the Cortex-A9 estimate is scaled from
+float reference(size_t i) {
+    static float x = 1;
+    x = x * 0.999f + a[i] * 1e-6f;
+    return x;
+}
+
+const Benchmark benchmarks[] = {
+    {"angleError (degrees)", [](size_t i) { return lemlib::angleError(a[i], b[i], false); }},
+    {"angleError (radians)",
+     [](size_t i) { return lemlib::angleError(lemlib::degToRad(a[i]), lemlib::degToRad(b[i]), true); }},
+    {"getCurvature", [](size_t i) { return lemlib::getCurvature(poses[i], others[i]); }},
+    {"Pose::rotate", [](size_t i) { return poses[i].rotate(b[i]).x; }},
+    {"Pose::distance", [](size_t i) { return poses[i].distance(others[i]); }},
+    {"Pose::angle", [](size_t i) { return poses[i].angle(others[i]); }},
+    {"slew", [](size_t i) { return lemlib::slew(c[i], c[(i + 1) % INPUTS], 5); }},
+    {"ExpoDriveCurve::curve", [](size_t i) { return driveCurve->curve(c[i]); }},
+    // the trig odometry does every update, the way lemlib::update() does it and the way FastOdometry does it
+    {"sin + cos", [](size_t i) { return std::sin(poses[i].theta) + std::cos(poses[i].theta); }},
+    {"fastSinCos", [](size_t i) {
+         const SinCos trig = fastSinCos(poses[i].theta);
+         return trig.sin + trig.cos;
+     }},
+};
+
+struct ProfileCase {
+        float distance;
+        ProfileConstraints constraints;
+        float startVelocity;
+        float endVelocity;
+};
+
+const ProfileCase profileCases[] = {
+    {48, {60, 120, 1200}, 0, 0},
+    // trapezoidal
+    {48, {60, 120, 0}, 0, 0},
+    {-36, {60, 120, 1200}, 0, 0},
+    // too short to reach the top speed
+    {6, {60, 120, 1200}, 0, 0},
+    {48, {60, 120, 1200}, 30, 20},
+    // already at the top speed
+    {24, {60, 120, 1200}, 60, 0},
+};
+
+double sinCosError() {
+    std::mt19937 rng(1);
+    // most angles odometry sees are within a turn or two, but it never wraps the heading
+    std::uniform_real_distribution<float> small(-4 * M_PI, 4 * M_PI);
+    std::uniform_real_distribution<float> large(-FAST_SIN_COS_RANGE, FAST_SIN_COS_RANGE);
+    double error = 0;
+    for (int i = 0; i < 1000000; i++) {
+        const float angle = i % 2 ? small(rng) : large(rng);
+        const SinCos trig = fastSinCos(angle);
+        error = std::max({error, std::fabs(trig.sin - std::sin(double(angle))),
+                          std::fabs(trig.cos - std::cos(double(angle)))});
+    }
+    return error;
+}
+
+double profilePositionError() {
+    float error = 0;
+    for (const ProfileCase& test : profileCases) {
+        const MotionProfile profile(test.distance, test.constraints, test.startVelocity, test.endVelocity);
+        error = std::max({error, std::fabs(profile.end() - test.distance),
+                          std::fabs(profile.sample(profile.duration()).position - test.distance)});
+    }
+    return error;
+}
+
+double profileVelocityError() {
+    float error = 0;
+    for (const ProfileCase& test : profileCases) {
+        const MotionProfile profile(test.distance, test.constraints, test.startVelocity, test.endVelocity);
+        const float sign = test.distance < 0 ? -1 : 1;
+        error = std::max({error, std::fabs(profile.sample(0).velocity - sign * test.startVelocity),
+                          std::fabs(profile.sample(profile.duration()).velocity - sign * test.endVelocity)});
+    }
+    return error;
+}
+
+double poseHistoryError() {
+    // a robot moving and turning at a steady rate, with its sensors read about every 5ms
+    auto at = [](double seconds) { return lemlib::Pose(10 + 24 * seconds, -5 - 12 * seconds, 0.5 + 2 * seconds); };
+    constexpr uint32_t START = 1000000;
+    clearPoseHistory();
+    uint32_t time = START;
+    for (int i = 0; i < 100; i++) {
+        recordPoseSample(time, at((time - START) / 1e6), {24, -12, 2});
+        time += 5000 + i % 3 * 300;
+    }
+    const uint32_t last = time - 5000 - 99 % 3 * 300;
+    float error = 0;
+    PoseSample sample;
+    if (getPoseSampleAt(START / 1000 - 1, sample)) return INFINITY;
+    // lookups are in milliseconds
+    for (uint32_t millis = START / 1000; millis * 1000 <= last; millis++) {
+        if (!getPoseSampleAt(millis, sample)) return INFINITY;
+        const lemlib::Pose expected = at((millis * 1000 - START) / 1e6);
+        error = std::max({error, std::fabs(sample.pose.x - expected.x), std::fabs(sample.pose.y - expected.y),
+                          std::fabs(sample.pose.theta - expected.theta)});
+    }
+    clearPoseHistory();
+    return error;
+}
+
+/**
+ * @brief Print how far a result is from what it should be
+ *
+ * @return true the error is within the tolerance
+ */
+bool check(const char* name, double error, double tolerance) {
+    const bool ok = error <= tolerance;
+    std::printf("%-28s %12.3g %12.3g  %s\n", name, error, tolerance, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+bool checkAccuracy() {
+    std::printf("%-28s %12s %12s\n", "accuracy", "error", "tolerance");
+    bool ok = check("fastSinCos", sinCosError(), FAST_SIN_COS_MAX_ERROR);
+    ok &= check("MotionProfile end position", profilePositionError(), PROFILE_MAX_ERROR);
+    ok &= check("MotionProfile end velocity", profileVelocityError(), PROFILE_MAX_VELOCITY_ERROR);
+    ok &= check("getPoseSampleAt", poseHistoryError(), POSE_HISTORY_MAX_ERROR);
+    std::printf("\n");
+    return ok;
+}
+
+void usage() {
+    std::fprintf(stderr, "usage: math-bench [--filter name] [--min-time seconds] [--repetitions n] [--a9]\n"
+                         "                  [--out file.json]\n");
+    std::exit(2);
+}
+
+Options parseArgs(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) usage();
+            return argv[++i];
+        };
+        if (!std::strcmp(argv[i], "--filter")) options.filter = next();
+        else if (!std::strcmp(argv[i], "--min-time")) options.minTime = std::atof(next());
+        else if (!std::strcmp(argv[i], "--repetitions")) options.repetitions = std::max(1, std::atoi(next()));
+        else if (!std::strcmp(argv[i], "--a9")) options.a9 = true;
+        else if (!std::strcmp(argv[i], "--out")) options.out = next();
+        else usage();
+    }
+    return options;
+}
+
+double timeBatch(float (*run)(size_t), uint64_t iterations) {
+    float total = 0;
+    const auto start = Clock::now();
+    for (uint64_t i = 0; i < iterations; i++) total += run(i & (INPUTS - 1));
+    const auto end = Clock::now();
+    sink = total;
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+/**
+ * @brief Time a function
+ *
+ * @return double the median of every repetition, in nanoseconds per call
+ */
+double measure(float (*run)(size_t), const Options& options) {
+    // find an iteration count that takes long enough to time accurately
+    uint64_t iterations = INPUTS;
+    while (timeBatch(run, iterations) < options.minTime * 1e9 && iterations < (uint64_t(1) << 40)) iterations *= 2;
+    std::vector<double> results;
+    for (int i = 0; i < options.repetitions; i++) results.push_back(timeBatch(run, iterations) / iterations);
+    std::sort(results.begin(), results.end());
+    return results[results.size() / 2];
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const Options options = parseArgs(argc, argv);
+    const bool accurate = checkAccuracy();
+    fillInputs();
+    // the cost of the loop and the call through a function pointer, which every benchmark pays
+    const double overhead = measure(baseline, options);
+    // host nanoseconds that correspond to one Cortex-A9 cycle, for the same work
+    const double nsPerCycle = options.a9 ? (measure(reference, options) - overhead) / REFERENCE_A9_CYCLES : 0;
+
+    if (options.a9) std::printf("%-24s %10s %12s %12s\n", "function", "ns/call", "A9 cycles", "A9 us/call");
+    else std::printf("%-24s %10s\n", "function", "ns/call");
+    std::string json;
+    for (const Benchmark& benchmark : benchmarks) {
+        if (options.filter != nullptr && std::strstr(benchmark.name, options.filter) == nullptr) continue;
+        const double ns = std::max(0.0, measure(benchmark.run, options) - overhead);
+        char entry[128];
+        std::snprintf(entry, sizeof(entry), "%s  {\"name\": \"%s\", \"ns_per_call\": %.3f}", json.empty() ? "" : ",\n",
+                      benchmark.name, ns);
+        json += entry;
+        if (!options.a9) {
+            std::printf("%-24s %10.2f\n", benchmark.name, ns);
+            continue;
+        }
+        const double cycles = ns / nsPerCycle;
+        std::printf("%-24s %10.2f %12.0f %12.3f\n", benchmark.name, ns, cycles, cycles / BRAIN_MHZ);
+    }
+    if (options.a9)
+        std::printf("\nA9 figures are estimates, scaled from a reference multiply-add chain timed on this host. They do "
+                    "not\nmodel the brain's caches or its software math library, so treat them as relative.\n");
+    if (options.out != nullptr) {
+        FILE* file = std::fopen(options.out, "w");
+        if (file == nullptr) {
+            std::perror(options.out);
+            return 1;
+        }
+        std::fprintf(file, "{\"benchmarks\": [\n%s\n]}\n", json.c_str());
+        std::fclose(file);
+    }
+    return accurate ? 0 : 3;
+}
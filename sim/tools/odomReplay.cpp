@@ -0,0 +1,258 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "fastOdometry.hpp"
+#include "lemlib/chassis/odom.hpp"
+#include "sensorLog.hpp"
+
+// feeds sensor logs recorded by src/sensorLog.cpp back through lemlib::update(), and checks the poses it calculates
+// against the ones the robot calculated from the same readings. With --fast, feeds them through FastOdometry instead,
+// to check it against LemLib
+
+namespace {
+struct Options {
+        std::vector<const char*> logs;
+        const char* csv = nullptr;
+        // replay every log this many times, to time lemlib::update() over more samples
+        int repeat = 1;
+        bool fast = false;
+};
+
+// FastOdometry rounds differently than LemLib, so it can't match bit for bit. It passes if it stays this close, in
+// inches and degrees
+constexpr double FAST_MAX_ERROR = 0.01;
+constexpr double FAST_MAX_HEADING_ERROR = 0.001;
+
+struct Record {
+        uint32_t sequence;
+        uint32_t time;
+        std::vector<float> wheels;
+        double imu = 0;
+        float leftMotors;
+        float rightMotors;
+        lemlib::Pose pose {0, 0, 0};
+};
+
+struct Log {
+        SensorLogHeader header;
+        std::vector<SensorLogWheel> wheels;
+        std::vector<Record> records;
+};
+
+struct Result {
+        // updates whose pose matched the recorded one bit for bit
+        uint32_t exact = 0;
+        uint32_t compared = 0;
+        // sequence numbers that were skipped because the robot dropped records
+        uint32_t gaps = 0;
+        int64_t firstMismatch = -1;
+        double maxError = 0;
+        double maxHeadingError = 0;
+        double updateTime = 0;
+        uint32_t updates = 0;
+};
+
+// the record being replayed, and the wheels it belongs to
+const Record* current = nullptr;
+std::vector<lemlib::TrackingWheel*> replayWheels;
+
+/**
+ * @brief An IMU that reads back the rotations in the log
+ */
+class ReplayImu : public pros::Imu {
+    public:
+        using pros::Imu::Imu;
+
+        double get_rotation() const override { return current->imu; }
+};
+
+void usage() {
+    std::fprintf(stderr, "usage: odom-replay [--csv file.csv] [--repeat n] [--fast] log...\n");
+    std::exit(2);
+}
+
+Options parseArgs(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) usage();
+            return argv[++i];
+        };
+        if (!std::strcmp(argv[i], "--csv")) options.csv = next();
+        else if (!std::strcmp(argv[i], "--repeat")) options.repeat = std::max(1, std::atoi(next()));
+        else if (!std::strcmp(argv[i], "--fast")) options.fast = true;
+        else if (argv[i][0] == '-') usage();
+        else options.logs.push_back(argv[i]);
+    }
+    if (options.logs.empty()) usage();
+    return options;
+}
+
+template <typename T> bool get(FILE* file, T& value) { return std::fread(&value, sizeof(T), 1, file) == 1; }
+
+bool readLog(const char* path, Log& log) {
+    FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        std::fprintf(stderr, "could not open %s\n", path);
+        return false;
+    }
+    if (!get(file, log.header) || std::memcmp(log.header.magic, SENSOR_LOG_MAGIC, 4) != 0 ||
+        log.header.version != SENSOR_LOG_VERSION) {
+        std::fprintf(stderr, "%s is not a version %d sensor log\n", path, SENSOR_LOG_VERSION);
+        std::fclose(file);
+        return false;
+    }
+    log.wheels.resize(log.header.wheelCount);
+    for (SensorLogWheel& wheel : log.wheels) get(file, wheel);
+    while (true) {
+        Record record;
+        record.wheels.resize(log.header.wheelCount);
+        bool complete = get(file, record.sequence) && get(file, record.time);
+        for (float& wheel : record.wheels) complete = complete && get(file, wheel);
+        if (log.header.hasImu) complete = complete && get(file, record.imu);
+        complete = complete && get(file, record.leftMotors) && get(file, record.rightMotors) &&
+                   get(file, record.pose.x) && get(file, record.pose.y) && get(file, record.pose.theta);
+        // a log cut off by the robot turning off ends with part of a record
+        if (!complete) break;
+        log.records.push_back(std::move(record));
+    }
+    std::fclose(file);
+    return true;
+}
+
+/**
+ * @brief Give odometry the same sensors the robot had
+ *
+ * The readings come from the log, so the devices behind the wheels only decide which kind of wheel each one is.
+ *
+ * @return lemlib::OdomSensors the sensors, with the vertical wheels LemLib made out of the drivetrain filled in
+ */
+lemlib::OdomSensors setupSensors(const Log& log) {
+    static std::vector<std::unique_ptr<lemlib::TrackingWheel>> wheels;
+    static std::vector<std::unique_ptr<pros::Rotation>> encoders;
+    static std::vector<std::unique_ptr<pros::MotorGroup>> motors;
+    static ReplayImu imu(1);
+    wheels.clear();
+    encoders.clear();
+    motors.clear();
+    replayWheels.clear();
+    lemlib::TrackingWheel* slots[4] = {};
+    for (const SensorLogWheel& description : log.wheels) {
+        const int8_t port = int8_t(replayWheels.size() + 2);
+        if (description.type == 1) {
+            motors.push_back(std::make_unique<pros::MotorGroup>(std::vector<int8_t> {port}));
+            wheels.push_back(std::make_unique<lemlib::TrackingWheel>(motors.back().get(), lemlib::Omniwheel::NEW_275,
+                                                                     description.offset, 450));
+        } else {
+            encoders.push_back(std::make_unique<pros::Rotation>(port));
+            wheels.push_back(std::make_unique<lemlib::TrackingWheel>(encoders.back().get(), lemlib::Omniwheel::NEW_275,
+                                                                     description.offset));
+        }
+        replayWheels.push_back(wheels.back().get());
+        if (description.slot < 4) slots[description.slot] = wheels.back().get();
+    }
+    lemlib::OdomSensors sensors(slots[SensorLogWheel::VERTICAL1], slots[SensorLogWheel::VERTICAL2],
+                                slots[SensorLogWheel::HORIZONTAL1], slots[SensorLogWheel::HORIZONTAL2],
+                                log.header.hasImu ? &imu : nullptr);
+    lemlib::setSensors(sensors, lemlib::Drivetrain(nullptr, nullptr, 0, 0, 0, 0));
+    return sensors;
+}
+
+bool samePose(const lemlib::Pose& a, const lemlib::Pose& b) {
+    return std::memcmp(&a.x, &b.x, sizeof(float)) == 0 && std::memcmp(&a.y, &b.y, sizeof(float)) == 0 &&
+           std::memcmp(&a.theta, &b.theta, sizeof(float)) == 0;
+}
+
+Result replay(const Log& log, FILE* csv, bool fast) {
+    Result result;
+    const lemlib::OdomSensors sensors = setupSensors(log);
+    std::unique_ptr<FastOdometry> odometry;
+    if (fast) odometry = std::make_unique<FastOdometry>(sensors, lemlib::Drivetrain(nullptr, nullptr, 0, 0, 0, 0));
+    for (size_t i = 0; i < log.records.size(); i++) {
+        const Record& record = log.records[i];
+        current = &record;
+        // odometry only keeps the last readings and the pose. The first update after a gap makes those match the
+        // robot's by setting the pose afterwards, which catches up on the readings too
+        const bool resync = i == 0 || record.sequence != log.records[i - 1].sequence + 1;
+        if (i > 0 && resync) result.gaps++;
+        if (fast && resync) {
+            odometry->setPose(record.pose);
+            continue;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        if (fast) odometry->update();
+        else lemlib::update();
+        result.updateTime += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        result.updates++;
+        if (resync) {
+            lemlib::setPose(record.pose, true);
+            continue;
+        }
+        const lemlib::Pose pose = fast ? odometry->getPose() : lemlib::getPose(true);
+        result.compared++;
+        if (samePose(pose, record.pose)) result.exact++;
+        else if (result.firstMismatch < 0) result.firstMismatch = int64_t(i);
+        result.maxError = std::max(result.maxError, double(pose.distance(record.pose)));
+        result.maxHeadingError = std::max(result.maxHeadingError,
+                                          std::fabs(double(lemlib::angleError(pose.theta, record.pose.theta, true))) *
+                                              180 / M_PI);
+        if (csv != nullptr)
+            std::fprintf(csv, "%u,%u,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n", record.sequence, record.time, pose.x, pose.y,
+                         pose.theta, record.pose.x, record.pose.y, record.pose.theta);
+    }
+    return result;
+}
+} // namespace
+
+// the replay tool is linked with --wrap for this, so every wheel reading odometry makes comes from the log
+extern "C" {
+float __wrap__ZN6lemlib13TrackingWheel19getDistanceTraveledEv(lemlib::TrackingWheel* wheel) {
+    for (size_t i = 0; i < replayWheels.size(); i++) {
+        if (replayWheels[i] == wheel) return current->wheels[i];
+    }
+    return 0;
+}
+}
+
+int main(int argc, char** argv) {
+    const Options options = parseArgs(argc, argv);
+    FILE* csv = nullptr;
+    if (options.csv != nullptr) {
+        csv = std::fopen(options.csv, "w");
+        if (csv == nullptr) {
+            std::fprintf(stderr, "could not open %s\n", options.csv);
+            return 1;
+        }
+        std::fprintf(csv, "sequence,time_us,x,y,theta,recorded_x,recorded_y,recorded_theta\n");
+    }
+
+    bool allMatch = true;
+    for (const char* path : options.logs) {
+        Log log;
+        if (!readLog(path, log)) return 1;
+        if (log.records.empty()) {
+            std::printf("%s: no records\n", path);
+            continue;
+        }
+        Result result;
+        for (int i = 0; i < options.repeat; i++) result = replay(log, i == 0 ? csv : nullptr, options.fast);
+        const double seconds = (log.records.back().time - log.records.front().time) / 1e6;
+        std::printf("%s: %zu updates over %.1fs, %u gaps\n", path, log.records.size(), seconds, result.gaps);
+        std::printf("  bit exact: %u of %u", result.exact, result.compared);
+        if (result.firstMismatch >= 0) std::printf(", first mismatch at update %lld", (long long)result.firstMismatch);
+        std::printf("\n  max error %.6fin, max heading error %.6fdeg\n", result.maxError, result.maxHeadingError);
+        std::printf("  %s took %.1f ns on this host\n", options.fast ? "FastOdometry::update()" : "lemlib::update()",
+                    result.updateTime / result.updates);
+        if (options.fast) {
+            if (result.maxError > FAST_MAX_ERROR || result.maxHeadingError > FAST_MAX_HEADING_ERROR) allMatch = false;
+        } else if (result.exact != result.compared) {
+            allMatch = false;
+        }
+    }
+    if (csv != nullptr) std::fclose(csv);
+    return allMatch ? 0 : 3;
+}
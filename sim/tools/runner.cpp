@@ -0,0 +1,202 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "main.h"
+#include "lemlib/chassis/odom.hpp"
+#include "loopTiming.hpp"
+#include "sim/devices.hpp"
+#include "sim/match.hpp"
+#include "sim/robot.hpp"
+#include "sim/scheduler.hpp"
+#include "sim/sync.hpp"
+
+// runs the robot program against the simulated robot, faster than real time
+
+namespace {
+enum class Mode { AUTON, DRIVER, MATCH };
+
+struct Options {
+        Mode mode = Mode::AUTON;
+        // how long each period lasts, in seconds
+        double autonTime = 15;
+        double driverTime = 105;
+        const char* trace = nullptr;
+        // seed for the order of tasks with the same priority, and where to log every context switch
+        uint64_t scheduleSeed = 0;
+        const char* scheduleTrace = nullptr;
+        sim::RobotOptions robot;
+};
+
+struct PathError {
+        double sumSquared = 0;
+        double max = 0;
+        double maxHeading = 0;
+        uint32_t samples = 0;
+};
+
+PathError pathError;
+FILE* traceFile = nullptr;
+FILE* scheduleFile = nullptr;
+
+void usage() {
+    std::fprintf(stderr, "usage: sim [--mode auton|driver|match] [--time seconds] [--seed n] [--battery volts]\n"
+                         "           [--noise scale] [--traction mu] [--trace file.csv] [--schedule-seed n]\n"
+                         "           [--schedule-trace file.csv]\n");
+    std::exit(2);
+}
+
+Options parseArgs(int argc, char** argv) {
+    Options options;
+    bool timeSet = false;
+    double time = 0;
+    for (int i = 1; i < argc; i++) {
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) usage();
+            return argv[++i];
+        };
+        if (!std::strcmp(argv[i], "--mode")) {
+            const std::string mode = next();
+            if (mode == "auton") options.mode = Mode::AUTON;
+            else if (mode == "driver") options.mode = Mode::DRIVER;
+            else if (mode == "match") options.mode = Mode::MATCH;
+            else usage();
+        } else if (!std::strcmp(argv[i], "--time")) {
+            time = std::atof(next());
+            timeSet = true;
+        } else if (!std::strcmp(argv[i], "--seed")) options.robot.seed = std::strtoull(next(), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--battery")) options.robot.batteryVoltage = std::atof(next());
+        else if (!std::strcmp(argv[i], "--noise")) options.robot.noise = std::atof(next());
+        else if (!std::strcmp(argv[i], "--traction")) options.robot.traction = std::atof(next());
+        else if (!std::strcmp(argv[i], "--trace")) options.trace = next();
+        else if (!std::strcmp(argv[i], "--schedule-seed")) options.scheduleSeed = std::strtoull(next(), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--schedule-trace")) options.scheduleTrace = next();
+        else usage();
+    }
+    if (timeSet) {
+        if (options.mode == Mode::DRIVER) options.driverTime = time;
+        else options.autonTime = time;
+    }
+    return options;
+}
+
+/**
+ * @brief Compare the true pose of the robot with the pose odometry thinks it has, every 10ms
+ */
+void samplePath(uint32_t time) {
+    if (time % 10 != 0) return;
+    const sim::PlantPose truth = sim::drivetrain().getPose();
+    const lemlib::Pose odom = lemlib::getPose();
+    const double truthHeading = truth.theta * 180 / M_PI;
+    const double error = std::hypot(truth.x - odom.x, truth.y - odom.y);
+    const double headingError = std::fabs(std::remainder(truthHeading - odom.theta, 360));
+    pathError.sumSquared += error * error;
+    pathError.max = std::max(pathError.max, error);
+    pathError.maxHeading = std::max(pathError.maxHeading, headingError);
+    pathError.samples++;
+    if (traceFile != nullptr)
+        std::fprintf(traceFile, "%u,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", time, truth.x, truth.y, truthHeading, odom.x,
+                     odom.y, odom.theta, sim::battery().voltage);
+}
+
+/**
+ * @brief A simple driver that drives forwards, turns and stops on a loop
+ */
+void scriptedDriver(sim::ControllerState& controller, uint32_t time) {
+    const uint32_t phase = time % 3000;
+    controller.analog[pros::E_CONTROLLER_ANALOG_LEFT_Y] = phase < 1500 ? 127 : 0;
+    controller.analog[pros::E_CONTROLLER_ANALOG_RIGHT_X] = phase >= 1500 && phase < 2500 ? 80 : 0;
+}
+
+/**
+ * @brief Log a context switch. Two runs with the same seeds produce the same log, so diffing logs finds where two
+ * schedules diverge
+ */
+void logSwitch(uint64_t time, sim::Task* task) {
+    std::fprintf(scheduleFile, "%llu,%s\n", (unsigned long long)time, sim::getName(task).c_str());
+}
+
+FILE* openLog(const char* path, const char* header) {
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        std::perror(path);
+        std::exit(1);
+    }
+    std::fprintf(file, "%s\n", header);
+    return file;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const Options options = parseArgs(argc, argv);
+    sim::setupRobot(options.robot);
+    sim::setScheduleSeed(options.scheduleSeed);
+    sim::onTick(samplePath);
+    if (options.trace != nullptr)
+        traceFile = openLog(options.trace, "time,x,y,theta,odom_x,odom_y,odom_theta,battery");
+    if (options.scheduleTrace != nullptr) {
+        scheduleFile = openLog(options.scheduleTrace, "time_us,task");
+        sim::onSwitch(logSwitch);
+    }
+
+    const auto wallStart = std::chrono::steady_clock::now();
+    sim::CompetitionState& competition = sim::competition();
+    competition.connected = true;
+    competition.disabled = true;
+    sim::runPeriod(initialize, "initialize", -1);
+    sim::runPeriod(competition_initialize, "competition_initialize", -1);
+    competition.disabled = false;
+    if (options.mode != Mode::DRIVER) {
+        competition.autonomous = true;
+        sim::runPeriod(autonomous, "autonomous", options.autonTime);
+        competition.autonomous = false;
+    }
+    if (options.mode != Mode::AUTON) {
+        sim::controller(0).script = scriptedDriver;
+        sim::runPeriod(opcontrol, "opcontrol", options.driverTime);
+    }
+    const double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    const double simTime = sim::micros() / 1e6;
+
+    const sim::PlantPose pose = sim::drivetrain().getPose();
+    const lemlib::Pose odom = lemlib::getPose();
+    std::printf("simulated %.3fs in %.3fs of wall time (%.1fx real time)\n", simTime, wallTime,
+                wallTime > 0 ? simTime / wallTime : 0);
+    std::printf("final pose: x %.2f y %.2f theta %.2f (odom: x %.2f y %.2f theta %.2f)\n", pose.x, pose.y,
+                pose.theta * 180 / M_PI, odom.x, odom.y, odom.theta);
+    if (pathError.samples > 0)
+        std::printf("path error: rms %.3fin max %.3fin, max heading error %.3fdeg\n",
+                    std::sqrt(pathError.sumSquared / pathError.samples), pathError.max, pathError.maxHeading);
+    std::printf("%-24s %12s %10s\n", "task", "cpu (us)", "switches");
+    sim::forEachTask([](sim::Task* task) {
+        std::printf("%-24s %12llu %10u\n", sim::getName(task).c_str(), (unsigned long long)sim::getCpuTime(task),
+                    sim::getSwitchCount(task));
+    });
+    std::printf("%-12s %8s %10s %8s %12s %10s  %s\n", "lock", "takes", "contended", "timeouts", "wait (us)",
+                "max (us)", "tasks");
+    sim::forEachLock([](const sim::LockStats& stats) {
+        std::string users;
+        for (const std::string& user : stats.users) users += (users.empty() ? "" : ", ") + user;
+        std::printf("%-12s %8u %10u %8u %12llu %10llu  %s\n", stats.name.c_str(), stats.takes, stats.contended,
+                    stats.timeouts, (unsigned long long)stats.waitTime, (unsigned long long)stats.maxWait,
+                    users.c_str());
+    });
+#ifdef LOOP_TIMING
+    std::printf("%-12s %10s %10s %10s %10s %10s %10s %8s\n", "loop", "iterations", "p50 (us)", "p99 (us)", "max (us)",
+                "work p99", "late p99", "missed");
+    auto printLoop = [](const char* name, const LoopStats& stats) {
+        std::printf("%-12s %10u %10u %10u %10u %10u %10u %8u\n", name, stats.iterations.load(),
+                    stats.period.percentile(0.5), stats.period.percentile(0.99), stats.maxPeriod.load(),
+                    stats.work.percentile(0.99), stats.jitter.percentile(0.99), stats.missedDeadlines.load());
+    };
+    printLoop("odometry", odometryTiming());
+    printLoop("motions", allMotionTiming());
+#endif
+    if (traceFile != nullptr) std::fclose(traceFile);
+    if (scheduleFile != nullptr) std::fclose(scheduleFile);
+    std::fflush(stdout);
+    // task threads are still parked in the scheduler, so skip static destructors
+    std::quick_exit(0);
+}
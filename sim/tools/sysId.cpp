@@ -0,0 +1,75 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "autons.hpp"
+#include "driveCharacterization.hpp"
+#include "sim/devices.hpp"
+#include "sim/match.hpp"
+#include "sim/robot.hpp"
+
+// drives the characterization patterns of characterizeDrivetrain() on the simulated robot, and compares the fitted
+// model with the gains the plant should have
+
+namespace {
+struct Options {
+        CharacterizationTest test;
+        sim::RobotOptions robot;
+};
+
+Options options;
+CharacterizationResult result;
+
+void usage() {
+    std::fprintf(stderr, "usage: sys-id [--ramp-rate volts/s] [--ramp-voltage volts] [--step-voltage volts]\n"
+                         "              [--seed n] [--battery volts] [--noise scale] [--traction mu]\n");
+    std::exit(2);
+}
+
+void parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) usage();
+            return argv[++i];
+        };
+        if (!std::strcmp(argv[i], "--ramp-rate")) options.test.rampRate = std::atof(next());
+        else if (!std::strcmp(argv[i], "--ramp-voltage")) options.test.rampVoltage = std::atof(next());
+        else if (!std::strcmp(argv[i], "--step-voltage")) options.test.stepVoltage = std::atof(next());
+        else if (!std::strcmp(argv[i], "--seed")) options.robot.seed = std::strtoull(next(), nullptr, 10);
+        else if (!std::strcmp(argv[i], "--battery")) options.robot.batteryVoltage = std::atof(next());
+        else if (!std::strcmp(argv[i], "--noise")) options.robot.noise = std::atof(next());
+        else if (!std::strcmp(argv[i], "--traction")) options.robot.traction = std::atof(next());
+        else usage();
+    }
+}
+
+void runTests() {
+    chassis.calibrate();
+    result = characterizeDrivetrain(chassis, drivetrain, options.test);
+}
+
+void print(const char* name, const char* unit, const CharacterizationFit& fit, const Feedforward& expected) {
+    const Feedforward& gains = fit.gains;
+    std::printf("%-8s %10s %12s %12s   r^2 %.4f over %d samples\n", name, "kS (V)", "kV (V/u/s)", "kA (V/u/s^2)",
+                fit.rSquared, fit.samples);
+    std::printf("  %-6s %10.4f %12.5f %12.5f\n", "fitted", gains.kS, gains.kV, gains.kA);
+    std::printf("  %-6s %10.4f %12.5f %12.5f   u = %s\n", "plant", expected.kS, expected.kV, expected.kA, unit);
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    parseArgs(argc, argv);
+    sim::setupRobot(options.robot);
+    sim::runPeriod(runTests, "characterization", -1);
+    if (!result.ok) {
+        std::printf("characterization failed: %s\n", result.error);
+        return 1;
+    }
+    const DriveCharacterization expected = sim::expectedCharacterization(sim::drivetrain().getModel());
+    print("linear", "inches", result.linear, expected.linear);
+    print("angular", "degrees", result.angular, expected.angular);
+    const DriveCharacterization& model = result.model;
+    std::printf("DriveCharacterization characterization {{%.4g, %.4g, %.4g}, {%.4g, %.4g, %.4g}};\n", model.linear.kS,
+                model.linear.kV, model.linear.kA, model.angular.kS, model.angular.kV, model.angular.kA);
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <cmath>
+#include "asyncCalibration.hpp"
+#include "lemlib/chassis/odom.hpp"
+#include "pros/device.h"
+
+namespace {
+// share of the progress bar each stage starts at
+constexpr float CHECK_START = 0;
+constexpr float IMU_START = 0.05;
+constexpr float ODOMETRY_START = 0.95;
+// how long an IMU calibration usually takes, in milliseconds, to estimate progress
+constexpr uint32_t IMU_CALIBRATION_TIME = 2000;
+
+/**
+ * @brief Calls the progress callback, and remembers the stage for the handle
+ */
+class Reporter {
+    public:
+        Reporter(std::atomic<CalibrationStage>& stage, const CalibrationSettings& settings)
+            : stage(stage),
+              settings(settings) {}
+
+        void report(CalibrationStage next, float fraction, const char* message) {
+            stage.store(next, std::memory_order_release);
+            lastReport = pros::millis();
+            if (settings.onProgress) settings.onProgress({next, fraction, message});
+        }
+
+        bool due() const { return pros::millis() - lastReport >= settings.progressInterval; }
+    private:
+        std::atomic<CalibrationStage>& stage;
+        const CalibrationSettings& settings;
+        uint32_t lastReport = 0;
+};
+
+int missingMotors(pros::MotorGroup* motors) {
+    if (motors == nullptr) return 0;
+    int missing = 0;
+    for (int i = 0; i < motors->size(); i++) {
+        if (pros::c::get_plugged_type(std::abs(motors->get_port(i))) != pros::c::E_DEVICE_MOTOR) missing++;
+    }
+    return missing;
+}
+
+/**
+ * @brief Whether the IMU finished calibrating and reads a heading, like Chassis::calibrate() checks
+ */
+bool imuReady(pros::Imu* imu) {
+    const double heading = imu->get_heading();
+    return imu->get_status() != pros::ImuStatus::error && std::isfinite(heading);
+}
+
+/**
+ * @brief Start odometry without the IMU, the same way Chassis::calibrate() does when the IMU fails
+ */
+void startOdometryWithoutImu(lemlib::OdomSensors sensors, const lemlib::Drivetrain& drivetrain) {
+    sensors.imu = nullptr;
+    if (sensors.vertical1 == nullptr)
+        sensors.vertical1 = new lemlib::TrackingWheel(drivetrain.leftMotors, drivetrain.wheelDiameter,
+                                                      -drivetrain.trackWidth / 2, drivetrain.rpm);
+    if (sensors.vertical2 == nullptr)
+        sensors.vertical2 = new lemlib::TrackingWheel(drivetrain.rightMotors, drivetrain.wheelDiameter,
+                                                      drivetrain.trackWidth / 2, drivetrain.rpm);
+    sensors.vertical1->reset();
+    sensors.vertical2->reset();
+    if (sensors.horizontal1 != nullptr) sensors.horizontal1->reset();
+    if (sensors.horizontal2 != nullptr) sensors.horizontal2->reset();
+    lemlib::setSensors(sensors, drivetrain);
+    lemlib::init();
+}
+} // namespace
+
+bool CalibrationHandle::done() const {
+    return state == nullptr || state->stage.load(std::memory_order_acquire) == CalibrationStage::DONE;
+}
+
+bool CalibrationHandle::wait(uint32_t timeout) const {
+    const uint32_t start = pros::millis();
+    while (!done()) {
+        if (pros::millis() - start >= timeout) return false;
+        pros::delay(5);
+    }
+    return true;
+}
+
+CalibrationStage CalibrationHandle::stage() const {
+    return state == nullptr ? CalibrationStage::DONE : state->stage.load(std::memory_order_acquire);
+}
+
+CalibrationResult CalibrationHandle::result() const {
+    if (state == nullptr) return {.error = "not started"};
+    if (!done()) return {.error = "not done"};
+    return state->result;
+}
+
+CalibrationHandle calibrateAsync(lemlib::Chassis& chassis, const lemlib::OdomSensors& sensors,
+                                 const lemlib::Drivetrain& drivetrain, const CalibrationSettings& settings) {
+    auto state = std::make_shared<CalibrationHandle::State>();
+    pros::Task task([state, &chassis, sensors, drivetrain, settings] {
+        const uint32_t start = pros::millis();
+        CalibrationResult result;
+        Reporter reporter(state->stage, settings);
+        pros::Imu* const imu = sensors.imu;
+
+        // start the IMU first, since it takes by far the longest, and check the rest while it calibrates
+        const bool imuFound = imu != nullptr && imu->is_installed();
+        if (imuFound) imu->reset(false);
+        reporter.report(CalibrationStage::CHECKING_SENSORS, CHECK_START, "checking");
+        result.missingMotors = missingMotors(drivetrain.leftMotors) + missingMotors(drivetrain.rightMotors);
+        for (lemlib::TrackingWheel* wheel :
+             {sensors.vertical1, sensors.vertical2, sensors.horizontal1, sensors.horizontal2}) {
+            if (wheel != nullptr) wheel->reset();
+        }
+
+        if (imuFound) {
+            for (int attempt = 1; attempt <= settings.imuAttempts && !result.imuCalibrated; attempt++) {
+                result.imuAttempts = attempt;
+                // the first attempt was started above
+                if (attempt > 1) imu->reset(false);
+                const uint32_t attemptStart = pros::millis();
+                reporter.report(CalibrationStage::CALIBRATING_IMU, IMU_START, attempt > 1 ? "IMU retry" : "IMU");
+                // give the IMU a moment to start calibrating
+                pros::delay(10);
+                while (imu->is_calibrating() && imu->get_status() != pros::ImuStatus::error &&
+                       pros::millis() - attemptStart < settings.imuTimeout) {
+                    if (reporter.due()) {
+                        const float share = std::fmin(float(pros::millis() - attemptStart) / IMU_CALIBRATION_TIME, 1);
+                        reporter.report(CalibrationStage::CALIBRATING_IMU,
+                                        IMU_START + share * (ODOMETRY_START - IMU_START), "IMU");
+                    }
+                    pros::delay(10);
+                }
+                result.imuCalibrated = !imu->is_calibrating() && imuReady(imu);
+            }
+        }
+
+        reporter.report(CalibrationStage::STARTING_ODOMETRY, ODOMETRY_START, "odometry");
+        if (result.imuCalibrated || imu == nullptr) {
+            chassis.calibrate(false);
+        } else {
+            startOdometryWithoutImu(sensors, drivetrain);
+        }
+
+        if (imu != nullptr && !imuFound) {
+            result.error = "IMU not plugged in";
+        } else if (imu != nullptr && !result.imuCalibrated) {
+            result.error = "IMU failed to calibrate";
+        } else if (result.missingMotors > 0) {
+            result.error = "drive motor missing";
+        }
+        result.ok = result.error == nullptr;
+        result.time = pros::millis() - start;
+        state->result = result;
+        reporter.report(CalibrationStage::DONE, 1, result.ok ? "ready" : result.error);
+        if (settings.onDone) settings.onDone(result);
+    });
+    return CalibrationHandle(state);
+}
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "autoTuner.hpp"
+#include "pros/rtos.hpp"
+
+namespace {
+// how often the test reads the pose and sets the relay, in milliseconds. The same as LemLib's motion loops, which the
+// suggested kI and kD are scaled to
+constexpr uint32_t LOOP_DELAY = 10;
+// how long to let the robot come to rest before and after measuring the noise, in milliseconds
+constexpr uint32_t REST_TIME = 300;
+constexpr uint32_t NOISE_TIME = 500;
+// how fast to raise the power while looking for the breakaway power, in milliseconds per step of 1
+constexpr uint32_t RAMP_STEP = 20;
+// oscillations to leave out at the start of the test
+constexpr int SKIPPED_CYCLES = 2;
+
+float mean(const std::vector<float>& values) {
+    float sum = 0;
+    for (float value : values) sum += value;
+    return sum / values.size();
+}
+
+/**
+ * @brief Ziegler-Nichols style gains, per second
+ */
+struct Gains {
+        float kP;
+        // integral and derivative times, in milliseconds. 0 leaves the term out
+        float integralTime;
+        float derivativeTime;
+};
+
+Gains ruleGains(AutoTuner::Rule rule, float ultimateGain, float ultimatePeriod) {
+    switch (rule) {
+        case AutoTuner::Rule::CLASSIC: return {0.6f * ultimateGain, ultimatePeriod / 2, ultimatePeriod / 8};
+        case AutoTuner::Rule::PD: return {0.8f * ultimateGain, 0, ultimatePeriod / 8};
+        case AutoTuner::Rule::SOME_OVERSHOOT: return {0.33f * ultimateGain, ultimatePeriod / 2, ultimatePeriod / 3};
+        case AutoTuner::Rule::NO_OVERSHOOT: return {0.2f * ultimateGain, ultimatePeriod / 2, ultimatePeriod / 3};
+    }
+    return {0, 0, 0};
+}
+} // namespace
+
+AutoTuner::AutoTuner(lemlib::Chassis& chassis)
+    : chassis(chassis) {}
+
+float AutoTuner::measure(Controller controller) const {
+    const lemlib::Pose pose = chassis.getPose();
+    if (controller == Controller::ANGULAR) return pose.theta - start.theta;
+    // distance along the heading the robot started at
+    const float heading = start.theta * M_PI / 180;
+    return (pose.x - start.x) * std::sin(heading) + (pose.y - start.y) * std::cos(heading);
+}
+
+void AutoTuner::drive(Controller controller, int power) {
+    if (controller == Controller::ANGULAR) chassis.tank(power, -power, true);
+    else chassis.tank(power, power, true);
+}
+
+AutoTuner::Result AutoTuner::tune(Controller controller, const lemlib::ControllerSettings& base,
+                                  const Experiment& experiment) {
+    Result result;
+    result.settings = base;
+    chassis.cancelAllMotions();
+    drive(controller, 0);
+    pros::delay(REST_TIME);
+    start = chassis.getPose();
+
+    // how much the measurement wanders while the robot stands still
+    float lowest = 0;
+    float highest = 0;
+    for (uint32_t time = 0; time < NOISE_TIME; time += LOOP_DELAY) {
+        const float position = measure(controller);
+        lowest = std::min(lowest, position);
+        highest = std::max(highest, position);
+        pros::delay(LOOP_DELAY);
+    }
+    result.noise = highest - lowest;
+    const float hysteresis = std::max(experiment.hysteresis, 2 * result.noise);
+
+    // the smallest power that moves the robot, towards the target so the test doesn't have as far to go
+    const int direction = experiment.target < 0 ? -1 : 1;
+    const float rest = measure(controller);
+    for (int power = 1; power <= experiment.relayPower && result.breakawayPower == 0; power++) {
+        drive(controller, direction * power);
+        pros::delay(RAMP_STEP);
+        if (std::fabs(measure(controller) - rest) > hysteresis) result.breakawayPower = power;
+    }
+    drive(controller, 0);
+    if (result.breakawayPower == 0) {
+        result.error = "the robot didn't move at the relay power";
+        return result;
+    }
+    pros::delay(REST_TIME);
+
+    // the relay test. Peaks are the furthest the robot gets past the target after each switch
+    std::vector<uint32_t> switches;
+    std::vector<float> highs;
+    std::vector<float> lows;
+    int output = experiment.target - measure(controller) < 0 ? -1 : 1;
+    float peak = measure(controller);
+    // the robot starts from rest, so the end of the first half cycle isn't a peak
+    bool firstSwitch = true;
+    const uint32_t startTime = pros::millis();
+    while (int(switches.size()) < SKIPPED_CYCLES + experiment.cycles + 1) {
+        if (pros::millis() - startTime > uint32_t(experiment.timeout)) {
+            drive(controller, 0);
+            result.error = "the robot didn't oscillate before the timeout";
+            return result;
+        }
+        const float position = measure(controller);
+        const float error = experiment.target - position;
+        if (output > 0 && error < -hysteresis) {
+            if (!firstSwitch) lows.push_back(peak);
+            firstSwitch = false;
+            switches.push_back(pros::millis());
+            output = -1;
+            peak = position;
+        } else if (output < 0 && error > hysteresis) {
+            if (!firstSwitch) highs.push_back(peak);
+            firstSwitch = false;
+            output = 1;
+            peak = position;
+        }
+        peak = output > 0 ? std::min(peak, position) : std::max(peak, position);
+        drive(controller, output * experiment.relayPower);
+        pros::delay(LOOP_DELAY);
+    }
+    drive(controller, 0);
+
+    highs.erase(highs.begin(), highs.begin() + std::min<size_t>(SKIPPED_CYCLES, highs.size()));
+    lows.erase(lows.begin(), lows.begin() + std::min<size_t>(SKIPPED_CYCLES, lows.size()));
+    if (highs.empty() || lows.empty()) {
+        result.error = "the robot didn't oscillate before the timeout";
+        return result;
+    }
+    result.measuredCycles = experiment.cycles;
+    result.ultimatePeriod = float(switches.back() - switches[SKIPPED_CYCLES]) / experiment.cycles;
+    result.amplitude = (mean(highs) - mean(lows)) / 2;
+    if (result.amplitude <= hysteresis) {
+        result.error = "the oscillation was smaller than the hysteresis";
+        return result;
+    }
+    // describing function of a relay with hysteresis
+    result.ultimateGain = 4 * experiment.relayPower /
+                          (M_PI * std::sqrt(result.amplitude * result.amplitude - hysteresis * hysteresis));
+
+    // LemLib adds the error to the integral and takes the change in error once per update, rather than per second
+    const Gains gains = ruleGains(experiment.rule, result.ultimateGain, result.ultimatePeriod);
+    result.settings.kP = gains.kP;
+    result.settings.kI = gains.integralTime > 0 ? gains.kP * LOOP_DELAY / gains.integralTime : 0;
+    result.settings.kD = gains.kP * gains.derivativeTime / LOOP_DELAY;
+    // proportional control alone stops where the output drops below the breakaway power
+    result.settings.smallError = std::max({2 * result.noise, hysteresis, result.breakawayPower / gains.kP});
+    result.settings.largeError = 3 * result.settings.smallError;
+    result.ok = true;
+    return result;
+}
+
+AutoTuner::Result AutoTuner::tune(Controller controller, const lemlib::ControllerSettings& base) {
+    return tune(controller, base, Experiment());
+}
+
+void logTuneResult(const AutoTuner::Result& result) {
+    if (!result.ok) {
+        lemlib::infoSink()->info("tune failed: {}", result.error);
+        return;
+    }
+    const lemlib::ControllerSettings& settings = result.settings;
+    lemlib::infoSink()->info("ultimate gain {:.3f}, period {:.0f}ms, amplitude {:.3f}, noise {:.3f}, breakaway power "
+                             "{:.0f} over {} cycles",
+                             result.ultimateGain, result.ultimatePeriod, result.amplitude, result.noise,
+                             result.breakawayPower, result.measuredCycles);
+    lemlib::infoSink()->info("ControllerSettings({:.4g}, {:.4g}, {:.4g}, {:g}, {:.3g}, {:g}, {:.3g}, {:g}, {:g})",
+                             settings.kP, settings.kI, settings.kD, settings.windupRange, settings.smallError,
+                             settings.smallErrorTimeout, settings.largeError, settings.largeErrorTimeout,
+                             settings.slew);
+}
@@ -0,0 +1,479 @@
+#include "autons.hpp"
+#include "Config.hpp"
+#include "main.h"
+#include "lemlib/api.hpp" // IWYU pragma: keep
+
+/**
+ * Stake Left
+ */
+void stakeLeft() {
+    //Start intake drive forward and grab ring.
+    intake.move_velocity(160);
+    chassis.moveToPoint(0, 16, 2000,
+    { .maxSpeed = 60});
+    chassis.waitUntilDone();
+
+    //Spin intake until ring is detected then,
+    //outtake into loader.
+    while(loader.get_distance()>63 && loader2.get_distance()>63){
+    intake.move_velocity(140);}
+    while(loader2.get_distance()<63 || loader.get_distance()<63){
+    intake.move_velocity(-300);}
+    pros::delay(200);
+
+    //Back up and raise arm while also stopping intake
+    chassis.moveToPoint(0, 13, 2000,
+    {.forwards=false, .minSpeed = 20});
+    chassis.waitUntilDone();
+    while (armrotation.get_angle() < 9000){
+        arm.move_velocity(600);}
+    arm.brake();
+    intake.move_velocity(0);
+
+    //Turn to face alliance stake and lower arm on it.
+    chassis.turnToHeading(58, 1000, 
+    {.direction = AngularDirection::CW_CLOCKWISE, .maxSpeed = 55});
+    chassis.waitUntilDone();
+    while (armrotation.get_angle() > 6700){
+        arm.move_velocity(-600);}
+    arm.brake();
+
+    //Back up and drive towards mobile goal and grab it.
+    chassis.moveToPose(-6, 8, 60, 500, 
+    {.forwards = false,.minSpeed = 40});
+    chassis.waitUntilDone();
+    chassis.moveToPose(-39, -3.5, 93, 6000, 
+    {.forwards = false, .minSpeed = 35});
+    chassis.waitUntil(30);
+    mogo2.set_value(1);
+    mogo3.set_value(1);
+    pros::c::delay(150);
+    mogo.set_value(1);
+    chassis.waitUntilDone();
+
+    //Turn left and grab the bottom ring.
+    chassis.turnToHeading(225, 1000);
+    chassis.waitUntilDone();
+    intake.move_velocity(600);
+    chassis.moveToPose(-10, -38, 90, 
+    4000,{.minSpeed = 40});
+    chassis.waitUntilDone();
+
+    //Drive to the corner and grab the bottom ring from stack.
+    chassis.moveToPose(6, -47, 135, 6000, 
+    {.minSpeed = 20});
+    chassis.waitUntilDone();
+    pros::delay(300);
+
+    //Back up, turn to face tower and touch.
+    chassis.moveToPoint(-8.5,-27.6,2000,
+    {.forwards=false, .minSpeed = 50});
+    chassis.waitUntilDone();
+    chassis.moveToPose(-40, 0,310, 6000, 
+    {.minSpeed = 70});
+    arm.move_velocity(600);
+    chassis.waitUntil(14);
+    arm.brake();
+}
+
+/**
+ * Stake Right
+ */
+void stakeRight() {
+    //Start intake drive forward and grab ring.
+    intake.move_velocity(160);
+    chassis.moveToPoint(0, 16, 2000,
+    { .maxSpeed = 60});
+    chassis.waitUntilDone();
+
+    //Spin intake until ring is dected then,
+    //outtake into loader.
+    while(loader.get_distance()>63 && loader2.get_distance()>63){
+    intake.move_velocity(140);}
+    while(loader2.get_distance()<63 || loader.get_distance()<63){
+    intake.move_velocity(-285);}
+
+    pros::delay(200);
+    //Back up and raise arm while also stopping intake
+    chassis.moveToPoint(0, 13.75, 2000,
+    {.forwards=false, .minSpeed = 20});
+    chassis.waitUntilDone();
+    while (armrotation.get_angle() < 9000){
+        arm.move_velocity(600);}
+    arm.brake();
+    intake.move_velocity(0);
+
+    //Turn to face alliance stake and lower arm on it.
+    chassis.turnToHeading(297, 1000, 
+    {.direction = AngularDirection::CCW_COUNTERCLOCKWISE, .maxSpeed = 55});
+    chassis.waitUntilDone();
+    while (armrotation.get_angle() > 7100){
+        arm.move_velocity(-600);}
+    arm.brake();
+
+    //Back up and drive towards mobile goal and grab it.
+    chassis.moveToPose(6, 8, 295, 500, 
+    {.forwards = false,.minSpeed = 40});
+    chassis.waitUntilDone();
+    chassis.moveToPose(37, -5, 272, 5000, 
+    {.forwards = false, .minSpeed = 35});
+    chassis.waitUntil(30);
+    mogo2.set_value(1);
+    mogo3.set_value(1);
+    pros::c::delay(150);
+    mogo.set_value(1);
+    chassis.waitUntilDone();
+
+    //Turn left and grab the bottom ring.
+    chassis.turnToHeading(135, 1000, {.direction = 
+    AngularDirection::CCW_COUNTERCLOCKWISE, .maxSpeed = 60});
+    chassis.waitUntilDone();
+    intake.move_velocity(600);
+    chassis.moveToPose(10, -36, 270, 4000, {.minSpeed =50});
+    chassis.waitUntilDone();
+
+    //Drive to the corner and grab the bottom ring from stack.
+    chassis.moveToPose(-6, -45, 220, 2500);
+    chassis.waitUntilDone();
+    pros::delay(300);
+
+    //Back up, turn to face tower and touch.
+    chassis.moveToPoint(8.5,-27.6,2000,
+    {.forwards = false, .maxSpeed = 65});
+    chassis.waitUntilDone();
+    chassis.moveToPose(45, 0,45, 6000, 
+    {.minSpeed = 70});
+    arm.move_velocity(600);
+    chassis.waitUntil(8);
+    arm.brake();
+}
+
+/**
+ * Goal Right
+ */
+void goalRight() {
+    //Back up and grab the Mobile goal.
+    intake.move_velocity(600);
+    chassis.moveToPoint(0,-25,4000,{.forwards = false, 
+    .maxSpeed = 50 });
+    chassis.waitUntil(19);
+    mogo2.set_value(1);
+    mogo3.set_value(1);
+    pros::c::delay(150);
+    mogo.set_value(1);
+    chassis.waitUntilDone();
+    intake.move_velocity(0);
+    pros::delay(200);
+
+    //Raise arm and move towards ring 
+    //stack and grab bottom ring.
+    while (armrotation.get_angle() < 11000){
+        arm.move_velocity(600);}
+    arm.brake();
+    intake.move_velocity(600);
+    chassis.turnToHeading(225, 1000, {.direction = 
+    AngularDirection::CCW_COUNTERCLOCKWISE, .maxSpeed = 60});
+    chassis.waitUntilDone();
+    pros::delay(100);
+
+    //Go to corner and grab bottom ring and score on mogo.
+    chassis.moveToPose(-30, -10, 0, 4000, 
+    {.minSpeed =40});
+    chassis.waitUntilDone();
+    chassis.moveToPose(-40, 13,311, 
+    5000, {.minSpeed= 40});
+    chassis.waitUntilDone();
+    pros::delay(500);
+
+    //Back away from the corner with ring.
+    chassis.moveToPoint(-22, -6,1000, 
+    {.forwards = false,.minSpeed= 50});
+    chassis.waitUntilDone();
+
+    //drive towards the alliance stake and turn
+    chassis.moveToPose(16, 8,43.5, 4000);
+    chassis.waitUntilDone();
+    intake.move_velocity(0);
+
+    //lower arm to score ring on stake.
+    while (armrotation.get_angle() > 7200){
+        arm.move_velocity(-600);}
+    arm.brake();
+    pros::delay(500);
+
+    //Back away from alliance stake and goal towards tower.
+    chassis.moveToPoint(6, 2,3000, 
+    {.forwards = false});
+    chassis.waitUntilDone();
+    arm.move_velocity(600);
+    chassis.moveToPose(16, -40,115, 
+    6000,{.minSpeed=50});
+    chassis.waitUntil(5);
+    arm.brake();
+}
+
+/**
+ * Goal Left
+ */
+void goalLeft() {
+    //Back up and grab the Mobile goal.
+    intake.move_velocity(600);
+    chassis.moveToPoint(0,-25,4000,{.forwards 
+    = false, .maxSpeed = 50 });
+    chassis.waitUntil(19);
+    mogo2.set_value(1);
+    mogo3.set_value(1);
+    pros::c::delay(150);
+    mogo.set_value(1);
+    chassis.waitUntilDone();
+    intake.move_velocity(0);
+    pros::delay(200);
+
+    //Raise arm and move towards ring 
+    //stack and grab bottom ring.
+    while (armrotation.get_angle() < 11000){
+        arm.move_velocity(600);}
+    arm.brake();
+    intake.move_velocity(600);
+    chassis.turnToHeading(135, 1000, 
+    {.direction = AngularDirection::CW_CLOCKWISE, .maxSpeed = 60});
+    chassis.waitUntilDone();
+    pros::delay(100);
+
+    //Go to corner and grab bottom ring and score on mogo.
+    chassis.moveToPose(30, -10, 0, 4000, 
+    {.minSpeed =40});
+    chassis.waitUntilDone();
+    chassis.moveToPose(40, 13,49, 
+    5000, {.minSpeed= 40});
+    chassis.waitUntilDone();
+    pros::delay(500);
+
+    //Back away from the corner with ring.
+    chassis.moveToPoint(22, -6,1000, {.forwards 
+    = false,.minSpeed= 50});
+    chassis.waitUntilDone();
+
+    //drive towards the alliance stake and turn
+    chassis.moveToPose(-14, 7,317.5, 4000);
+    chassis.waitUntilDone();
+
+    //lower arm to score ring on stake.
+    while (armrotation.get_angle() > 7200){
+        arm.move_velocity(-600);}
+    arm.brake();
+    pros::delay(500);
+
+    //Back away from alliance stake and goal towards tower.
+    chassis.moveToPoint(-6, 2,3000, 
+    {.forwards = false});
+    chassis.waitUntilDone();
+    intake.move_velocity(0);
+    arm.move_velocity(600);
+    chassis.moveToPose(-16, -40,245, 
+    6000,{.minSpeed=50});
+    chassis.waitUntil(5);
+    arm.brake();
+}
+
+/**
+ * Skills
+ */
+void skills() {
+    //TODO SKILLS
+    //Raise the arm, move forward and score preload.
+    intake.move_velocity(600);
+    pros::delay(200);
+    while (armrotation.get_angle() < 11000){
+        arm.move_velocity(600);}
+    arm.brake();
+    intake.move_velocity(0);
+    chassis.moveToPoint(0, 4, 2000,{.maxSpeed=80});
+    chassis.waitUntilDone();
+    pros::delay(200);
+    while (armrotation.get_angle() > 7000){
+        arm.move_velocity(-600);}
+    arm.brake();
+    pros::delay(200);
+    chassis.moveToPoint(0, -5, 2000,
+    {.forwards= false, .maxSpeed=80});
+    chassis.waitUntilDone();
+
+    //Back up and grab the mobile goal.
+    chassis.moveToPose(23,-6,236,2800,
+    {.forwards=false, .maxSpeed=95});
+    chassis.waitUntil(27);
+    mogo2.set_value(1);
+    mogo3.set_value(1);
+    pros::c::delay(150);
+    mogo.set_value(1);
+    chassis.waitUntilDone();
+    pros::delay(200);
+
+    //Turn left and grab two rings and raise arm
+    chassis.moveToPose(31,-27,90,4000,
+    {.maxSpeed=90,.minSpeed=40});
+    chassis.waitUntil(11);
+    intake.move_velocity(600);
+    chassis.moveToPoint(48,-27,3000,
+    {.maxSpeed=65});
+    chassis.waitUntilDone();
+    while (armrotation.get_angle() < 9000){
+        arm.move_velocity(600);}
+    arm.brake();
+
+    //Grab one ring and back up
+    chassis.moveToPoint(58,-5,3000,
+    {.maxSpeed=65});
+    chassis.waitUntilDone();
+    pros::delay(300);
+    chassis.moveToPoint(58,-25,1500,
+    {.forwards=false,.maxSpeed=60});
+    chassis.waitUntilDone();
+
+    //Grab two more rings and back up.
+    chassis.moveToPose(49,7,0,4000,
+    {.maxSpeed=65});
+    chassis.waitUntilDone();
+    chassis.moveToPose(49,0,0,2000,
+    {.forwards=false,.maxSpeed=70});
+    chassis.waitUntilDone();
+
+    //Place Mogo in corner and drop it.
+    chassis.moveToPose(59,3,225,2100,
+    {.forwards=false});
+    chassis.waitUntilDone();
+    intake.move_velocity(0);
+    mogo2.set_value(0);
+    mogo3.set_value(0);
+    mogo.set_value(0);
+
+    //Drive to Mogo #2 and grab it.
+    chassis.moveToPose(-19,-5,90,6000,
+    {.forwards=false,.maxSpeed=65});
+    chassis.waitUntil(77);
+    mogo2.set_value(1);
+    mogo3.set_value(1);
+    pros::c::delay(150);
+    mogo.set_value(1);
+    chassis.waitUntilDone();
+    pros::delay(200);
+
+    //Turn right and grab two rings.
+    chassis.turnToHeading(180, 500);
+    chassis.waitUntilDone();
+    chassis.moveToPose(-23,-30,235,2500);
+    chassis.waitUntil(10);
+    intake.move_velocity(600);
+    chassis.moveToPose(-50,-30,270,2500,
+    {.minSpeed=50});
+    chassis.waitUntilDone();
+
+    //Turn left, then drive grab ring and backup.
+    chassis.moveToPose(-57,-2,0,4000);
+    chassis.waitUntilDone();
+    chassis.moveToPoint(-57,-25,3000,{.forwards=false,
+    .maxSpeed=60});
+    chassis.waitUntilDone();
+    pros::delay(200);
+
+    //Grab two more rings and back up
+    chassis.moveToPose(-46,11.5,.5,4000,
+    {.minSpeed=50});
+    chassis.waitUntilDone();
+    chassis.moveToPoint(-46,0,2000,{.forwards=false});
+    chassis.waitUntilDone();
+
+    //Place goal in corner and drop.
+    chassis.moveToPose(-60,6,137,1800,{
+    .forwards=false});
+    chassis.waitUntilDone();
+    intake.move_velocity(0);
+    mogo2.set_value(0);
+    mogo3.set_value(0);
+    mogo.set_value(0);
+
+    //Drive to Mogo #3 and turn away.
+    intake.move_velocity(600);
+    chassis.moveToPose(-30,-80,165,5000);
+    chassis.waitUntilDone();
+    chassis.turnToHeading(345, 500);
+    chassis.waitUntilDone();
+    intake.move_velocity(0);
+
+    //Back up into goal and grab it.
+    chassis.moveToPose(-26,-102,330,3000,
+    {.forwards=false,.maxSpeed=65});
+    chassis.waitUntil(30);
+    mogo2.set_value(1);
+    mogo3.set_value(1);
+    pros::c::delay(150);
+    mogo.set_value(1);
+    chassis.waitUntilDone();
+    pros::delay(200);
+
+    //Turn and maneuver the goal into the corner.
+    chassis.turnToHeading(77, 500);
+    chassis.waitUntilDone();
+    chassis.moveToPose(-63.5,-112,65,2200,
+    {.forwards=false,.minSpeed=30});
+    chassis.waitUntilDone();
+    mogo2.set_value(0);
+    mogo3.set_value(0);
+    mogo.set_value(0);
+
+    //Drive towards Mogo #4.
+    chassis.moveToPose(-20,-105,90,3000);
+    chassis.waitUntilDone();
+
+    //Turn and grab the goal.
+    chassis.turnToHeading(225,  500);
+    chassis.waitUntilDone();
+    chassis.moveToPose(6,-95,225,3000,
+    {.forwards=false,.maxSpeed=65});
+    chassis.waitUntil(25);
+    mogo2.set_value(1);
+    mogo3.set_value(1);
+    pros::c::delay(150);
+    mogo.set_value(1);
+    chassis.waitUntilDone();
+    pros::delay(200);
+
+    //Turn and drive towards two rings
+    intake.move_velocity(600);
+    chassis.turnToHeading(50, 500);
+    chassis.waitUntilDone();
+    chassis.moveToPose(22,-73,47,3000);
+    chassis.waitUntilDone();
+    chassis.moveToPose(53,-73,90,3000);
+    chassis.waitUntilDone();
+
+    //Drive towards the last the corner and place goal.
+    chassis.moveToPose(57, -70, 0,1000);
+    chassis.waitUntilDone();
+    intake.move_velocity(0);
+    chassis.moveToPose(65,-116,330,2600,
+    {.forwards=false,.minSpeed=45});
+    chassis.waitUntilDone();
+    mogo2.set_value(0);
+    mogo3.set_value(0);
+    mogo.set_value(0);
+
+    //Move away from corner.
+    chassis.moveToPose(55, -70, 0,3000);
+    chassis.waitUntilDone();
+}
+
+// the starts are roughly where the robot lines up with its back to the alliance wall. Measure them on the field
+const AutonRoutine autonRoutines[] = {
+    {"Stake Left", stakeLeft, {-63, 12, 90}},
+    {"Stake Right", stakeRight, {-63, -12, 90}},
+    {"Goal Right", goalRight, {-63, -36, 90}},
+    {"Goal Left", goalLeft, {-63, 36, 90}},
+    {"Skills", skills, {-63, 0, 90}, 60},
+};
+
+const int autonRoutineCount = sizeof(autonRoutines) / sizeof(autonRoutines[0]);
+
+// Stake Right is the routine we run in matches
+int selectedAuton = 1;
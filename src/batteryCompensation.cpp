@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include "batteryCompensation.hpp"
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+
+namespace {
+constexpr uint32_t PERIOD = 10;
+constexpr int32_t MAX_MILLIVOLTS = 12000;
+// a battery never reads more than this, in volts. PROS_ERR does
+constexpr float MAX_VOLTAGE = 20;
+
+// written by the compensation task, read by every task that commands a motor
+std::atomic<float> filtered = 0;
+std::atomic<float> scale = 1;
+
+// a command out of 127, like pros::Motor::move() takes, in millivolts
+int32_t toMillivolts(int32_t power) { return std::clamp<int32_t>(power, -127, 127) * MAX_MILLIVOLTS / 127; }
+} // namespace
+
+#ifdef BATTERY_COMP
+namespace {
+// the settings, which any task can change
+std::atomic<float> referenceVoltage = BatteryCompensationSettings().referenceVoltage;
+std::atomic<uint32_t> timeConstant = BatteryCompensationSettings().timeConstant;
+std::atomic<float> minVoltage = BatteryCompensationSettings().minVoltage;
+std::atomic<bool> started = false;
+
+void runCompensation() {
+    uint32_t previous = pros::millis();
+    while (true) {
+        const float reading = pros::battery::get_voltage() / 1000.0f;
+        const uint32_t now = pros::millis();
+        const float dt = now - previous;
+        previous = now;
+        if (reading > 0 && reading < MAX_VOLTAGE) {
+            const float last = filtered.load(std::memory_order_relaxed);
+            const float weight = dt / (timeConstant.load(std::memory_order_relaxed) + dt);
+            const float voltage = last == 0 ? reading : last + (reading - last) * weight;
+            filtered.store(voltage, std::memory_order_relaxed);
+            const float battery = std::max(voltage, minVoltage.load(std::memory_order_relaxed));
+            scale.store(referenceVoltage.load(std::memory_order_relaxed) / battery, std::memory_order_relaxed);
+        }
+        pros::delay(PERIOD);
+    }
+}
+} // namespace
+#endif
+
+bool startBatteryCompensation(const BatteryCompensationSettings& settings) {
+#ifdef BATTERY_COMP
+    referenceVoltage.store(settings.referenceVoltage, std::memory_order_relaxed);
+    timeConstant.store(settings.timeConstant, std::memory_order_relaxed);
+    minVoltage.store(settings.minVoltage, std::memory_order_relaxed);
+    if (!started.exchange(true))
+        pros::Task task(runCompensation, TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT, "battery");
+    return true;
+#else
+    (void)settings;
+    return false;
+#endif
+}
+
+float batteryVoltage() { return filtered.load(std::memory_order_relaxed); }
+
+float batteryCompensation() { return scale.load(std::memory_order_relaxed); }
+
+int32_t compensateVoltage(int32_t millivolts) {
+    const float scaled = millivolts * scale.load(std::memory_order_relaxed);
+    return std::clamp<int32_t>(std::lround(scaled), -MAX_MILLIVOLTS, MAX_MILLIVOLTS);
+}
+
+std::int32_t CompensatedMotorGroup::move(std::int32_t voltage) const {
+    return pros::MotorGroup::move_voltage(compensateVoltage(toMillivolts(voltage)));
+}
+
+std::int32_t CompensatedMotorGroup::move_voltage(std::int32_t voltage) const {
+    return pros::MotorGroup::move_voltage(compensateVoltage(voltage));
+}
+
+std::int32_t CompensatedMotor::move(std::int32_t voltage) const {
+    return pros::Motor::move_voltage(compensateVoltage(toMillivolts(voltage)));
+}
+
+std::int32_t CompensatedMotor::move_voltage(std::int32_t voltage) const {
+    return pros::Motor::move_voltage(compensateVoltage(voltage));
+}
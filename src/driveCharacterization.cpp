@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+#include "driveCharacterization.hpp"
+#include "pros/rtos.hpp"
+
+namespace {
+// how often the tests read the pose and set the voltage, in milliseconds
+constexpr uint32_t SAMPLE_INTERVAL = 10;
+// velocity and acceleration are central differences over this many samples either side, to smooth out sensor noise
+constexpr int DERIVATIVE_SPAN = 2;
+// the robot is at rest once it moves less than this in REST_WINDOW, in inches or degrees
+constexpr float REST_MOVEMENT = 0.05;
+constexpr uint32_t REST_WINDOW = 200;
+constexpr uint32_t REST_TIMEOUT = 3000;
+
+enum class Motion { LINEAR, ANGULAR };
+
+struct Sample {
+        uint32_t time;
+        // where the robot is, in inches or degrees
+        float position;
+        // voltage applied from this sample to the next, in volts. Negative drives backwards or counterclockwise
+        float voltage;
+};
+
+class Tester {
+    public:
+        Tester(lemlib::Chassis& chassis, const lemlib::Drivetrain& drivetrain, Motion motion)
+            : chassis(chassis),
+              drivetrain(drivetrain),
+              motion(motion),
+              start(chassis.getPose()) {}
+
+        float position() {
+            const lemlib::Pose pose = chassis.getPose();
+            if (motion == Motion::ANGULAR) return pose.theta - start.theta;
+            // distance along the heading the robot started the tests at
+            const float heading = start.theta * M_PI / 180;
+            return (pose.x - start.x) * std::sin(heading) + (pose.y - start.y) * std::cos(heading);
+        }
+
+        void apply(float voltage) {
+            const int millivolts = std::lround(voltage * 1000);
+            drivetrain.leftMotors->move_voltage(millivolts);
+            drivetrain.rightMotors->move_voltage(motion == Motion::ANGULAR ? -millivolts : millivolts);
+        }
+
+        void waitForRest() {
+            apply(0);
+            const uint32_t begin = pros::millis();
+            float last = position();
+            uint32_t still = pros::millis();
+            while (pros::millis() - begin < REST_TIMEOUT && pros::millis() - still < REST_WINDOW) {
+                pros::delay(SAMPLE_INTERVAL);
+                const float now = position();
+                if (std::fabs(now - last) > REST_MOVEMENT) {
+                    last = now;
+                    still = pros::millis();
+                }
+            }
+        }
+
+        /**
+         * @brief Drive one pattern
+         *
+         * @param direction 1 for forwards or clockwise, -1 for backwards or counterclockwise
+         * @param rate how fast to raise the voltage, in volts per second. 0 for a step
+         * @param voltage highest voltage, in volts
+         * @param maxTime how long the pattern lasts at most, in milliseconds
+         * @param limit how far the robot may move, in inches or degrees
+         */
+        std::vector<Sample> drive(int direction, float rate, float voltage, uint32_t maxTime, float limit) {
+            std::vector<Sample> samples;
+            const float origin = position();
+            const uint32_t begin = pros::millis();
+            while (true) {
+                const uint32_t elapsed = pros::millis() - begin;
+                const float now = position();
+                if (elapsed > maxTime || std::fabs(now - origin) > limit) break;
+                const float applied = direction * (rate > 0 ? std::min(voltage, rate * elapsed / 1000) : voltage);
+                samples.push_back({pros::millis(), now, applied});
+                apply(applied);
+                pros::delay(SAMPLE_INTERVAL);
+            }
+            waitForRest();
+            return samples;
+        }
+    private:
+        lemlib::Chassis& chassis;
+        const lemlib::Drivetrain& drivetrain;
+        Motion motion;
+        lemlib::Pose start;
+};
+
+/**
+ * @brief Least squares fit of voltage = kS * sign(velocity) + kV * velocity + kA * acceleration
+ */
+class Fitter {
+    public:
+        void add(const std::vector<Sample>& samples, float minVelocity) {
+            const int count = samples.size();
+            std::vector<double> velocity(count, NAN);
+            auto difference = [&](auto value, int i) {
+                const double dt = (samples[i + DERIVATIVE_SPAN].time - samples[i - DERIVATIVE_SPAN].time) / 1000.0;
+                return (value(i + DERIVATIVE_SPAN) - value(i - DERIVATIVE_SPAN)) / dt;
+            };
+            for (int i = DERIVATIVE_SPAN; i < count - DERIVATIVE_SPAN; i++)
+                velocity[i] = difference([&](int j) { return double(samples[j].position); }, i);
+            for (int i = 2 * DERIVATIVE_SPAN; i < count - 2 * DERIVATIVE_SPAN; i++) {
+                if (std::fabs(velocity[i]) < minVelocity || samples[i].voltage == 0) continue;
+                const double acceleration = difference([&](int j) { return velocity[j]; }, i);
+                const double row[3] = {double((velocity[i] > 0) - (velocity[i] < 0)), velocity[i], acceleration};
+                const double voltage = samples[i].voltage;
+                for (int r = 0; r < 3; r++) {
+                    for (int c = 0; c < 3; c++) normal[r][c] += row[r] * row[c];
+                    target[r] += row[r] * voltage;
+                }
+                sumVoltage += voltage;
+                sumSquaredVoltage += voltage * voltage;
+                rows.push_back({row[0], row[1], row[2], voltage});
+            }
+        }
+
+        /**
+         * @brief Solve the normal equations
+         *
+         * @return false there weren't enough samples, or they didn't tell the terms apart
+         */
+        bool solve(CharacterizationFit& fit) {
+            fit.samples = rows.size();
+            if (rows.size() < 10) return false;
+            // gaussian elimination with partial pivoting
+            double a[3][4];
+            for (int r = 0; r < 3; r++) {
+                for (int c = 0; c < 3; c++) a[r][c] = normal[r][c];
+                a[r][3] = target[r];
+            }
+            for (int col = 0; col < 3; col++) {
+                int pivot = col;
+                for (int r = col + 1; r < 3; r++) {
+                    if (std::fabs(a[r][col]) > std::fabs(a[pivot][col])) pivot = r;
+                }
+                if (std::fabs(a[pivot][col]) < 1e-9) return false;
+                std::swap(a[col], a[pivot]);
+                for (int r = 0; r < 3; r++) {
+                    if (r == col) continue;
+                    const double factor = a[r][col] / a[col][col];
+                    for (int c = col; c < 4; c++) a[r][c] -= factor * a[col][c];
+                }
+            }
+            const double kS = a[0][3] / a[0][0];
+            const double kV = a[1][3] / a[1][1];
+            const double kA = a[2][3] / a[2][2];
+            fit.gains = {float(kS), float(kV), float(kA)};
+            double residual = 0;
+            for (const auto& row : rows) {
+                const double error = row[3] - (kS * row[0] + kV * row[1] + kA * row[2]);
+                residual += error * error;
+            }
+            const double mean = sumVoltage / rows.size();
+            const double total = sumSquaredVoltage - rows.size() * mean * mean;
+            fit.rSquared = total > 0 ? 1 - residual / total : 0;
+            return true;
+        }
+    private:
+        double normal[3][3] = {};
+        double target[3] = {};
+        double sumVoltage = 0;
+        double sumSquaredVoltage = 0;
+        // sign, velocity, acceleration and voltage of every sample, to work out the residual
+        std::vector<std::array<double, 4>> rows;
+};
+
+bool characterize(lemlib::Chassis& chassis, const lemlib::Drivetrain& drivetrain, const CharacterizationTest& test,
+                  Motion motion, CharacterizationFit& fit) {
+    Tester tester(chassis, drivetrain, motion);
+    Fitter fitter;
+    const float limit = motion == Motion::LINEAR ? test.maxDistance : test.maxAngle;
+    const float minVelocity = motion == Motion::LINEAR ? test.minLinearVelocity : test.minAngularVelocity;
+    const uint32_t rampTime = test.rampRate > 0 ? uint32_t(test.rampVoltage / test.rampRate * 1000) : 0;
+    for (int direction : {1, -1})
+        fitter.add(tester.drive(direction, test.rampRate, test.rampVoltage, rampTime, limit), minVelocity);
+    for (int direction : {1, -1})
+        fitter.add(tester.drive(direction, 0, test.stepVoltage, test.stepTime, limit), minVelocity);
+    return fitter.solve(fit);
+}
+} // namespace
+
+CharacterizationResult characterizeDrivetrain(lemlib::Chassis& chassis, const lemlib::Drivetrain& drivetrain,
+                                              const CharacterizationTest& test) {
+    CharacterizationResult result;
+    chassis.cancelAllMotions();
+    if (!characterize(chassis, drivetrain, test, Motion::LINEAR, result.linear)) {
+        result.error = "the straight tests didn't move the robot enough to fit";
+        return result;
+    }
+    if (!characterize(chassis, drivetrain, test, Motion::ANGULAR, result.angular)) {
+        result.error = "the turning tests didn't move the robot enough to fit";
+        return result;
+    }
+    result.model = {result.linear.gains, result.angular.gains};
+    result.ok = true;
+    return result;
+}
+
+void logCharacterization(const CharacterizationResult& result) {
+    if (!result.ok) {
+        lemlib::infoSink()->info("characterization failed: {}", result.error);
+        return;
+    }
+    const DriveCharacterization& model = result.model;
+    lemlib::infoSink()->info("linear fit r^2 {:.4f} over {} samples, angular fit r^2 {:.4f} over {} samples",
+                             result.linear.rSquared, result.linear.samples, result.angular.rSquared,
+                             result.angular.samples);
+    lemlib::infoSink()->info("DriveCharacterization characterization {{{{{:.4g}, {:.4g}, {:.4g}}}, "
+                             "{{{:.4g}, {:.4g}, {:.4g}}}}};",
+                             model.linear.kS, model.linear.kV, model.linear.kA, model.angular.kS, model.angular.kV,
+                             model.angular.kA);
+}
@@ -0,0 +1,147 @@
+#include <atomic>
+#include <cmath>
+#include "fastOdometry.hpp"
+#include "pros/rtos.hpp"
+
+namespace {
+// below this half turn, in radians, the series are accurate to a few ulp
+constexpr float SERIES_LIMIT = 0.1;
+
+FastOdometry* fastOdometry = nullptr;
+std::atomic<bool> fastSelected = false;
+} // namespace
+
+SinCos fastSinCos(float angle) {
+    // which quarter turn the angle is closest to. Reduced in double so the remainder is exact for large angles
+    const double quarter = std::nearbyint(angle * (2 / M_PI));
+    const float r = float(angle - quarter * (M_PI / 2));
+    const float r2 = r * r;
+    const float sin = r * (1 + r2 * (-1.0f / 6 + r2 * (1.0f / 120 + r2 * (-1.0f / 5040 + r2 * (1.0f / 362880)))));
+    const float cos = 1 + r2 * (-1.0f / 2 + r2 * (1.0f / 24 + r2 * (-1.0f / 720 + r2 * (1.0f / 40320))));
+    switch (int64_t(quarter) & 3) {
+        case 0: return {sin, cos};
+        case 1: return {cos, -sin};
+        case 2: return {-sin, -cos};
+        default: return {-cos, sin};
+    }
+}
+
+FastOdometry::FastOdometry(const lemlib::OdomSensors& sensors, const lemlib::Drivetrain& drivetrain)
+    : reader(sensors, drivetrain) {
+    // the same order LemLib picks its heading source in
+    if (reader.hasWheel(2) && reader.hasWheel(3)) {
+        headingSource = HeadingSource::HORIZONTAL_WHEELS;
+        inverseSpan = 1 / (reader.offset(2) - reader.offset(3));
+    } else if (!reader.powered(0) && !reader.powered(1)) {
+        headingSource = HeadingSource::VERTICAL_WHEELS;
+    } else if (reader.hasImu()) {
+        headingSource = HeadingSource::IMU;
+    } else {
+        headingSource = HeadingSource::DRIVETRAIN;
+    }
+    if (headingSource == HeadingSource::VERTICAL_WHEELS || headingSource == HeadingSource::DRIVETRAIN)
+        inverseSpan = 1 / (reader.offset(0) - reader.offset(1));
+    // a wheel that isn't made out of the drivetrain measures forward motion better
+    vertical = !reader.powered(0) ? 0 : !reader.powered(1) ? 1 : 0;
+    horizontal = reader.hasWheel(2) ? 2 : reader.hasWheel(3) ? 3 : -1;
+    verticalOffset = reader.offset(vertical);
+    horizontalOffset = horizontal >= 0 ? reader.offset(horizontal) : 0;
+    setPose({0, 0, 0});
+}
+
+void FastOdometry::resync() {
+    const SinCos trig = fastSinCos(theta);
+    sinTheta = trig.sin;
+    cosTheta = trig.cos;
+    sinceResync = 0;
+}
+
+void FastOdometry::update() {
+    OdometrySnapshot snapshot;
+    reader.read(snapshot);
+    update(snapshot);
+}
+
+void FastOdometry::update(const OdometrySnapshot& snapshot) {
+    float delta[4];
+    for (int i = 0; i < 4; i++) delta[i] = snapshot.wheels[i] - previous.wheels[i];
+    const float imuDelta = lemlib::degToRad(snapshot.imu - previous.imu);
+    previous = snapshot;
+
+    float turned;
+    switch (headingSource) {
+        case HeadingSource::HORIZONTAL_WHEELS: turned = -(delta[2] - delta[3]) * inverseSpan; break;
+        case HeadingSource::IMU: turned = imuDelta; break;
+        default: turned = -(delta[0] - delta[1]) * inverseSpan; break;
+    }
+    const float dy = delta[vertical];
+    const float dx = horizontal >= 0 ? delta[horizontal] : 0;
+
+    // sine and cosine of half the turn, and the length of the chord of the arc over the length of the arc
+    const float half = turned / 2;
+    float sinHalf;
+    float cosHalf;
+    float chord;
+    const bool small = std::fabs(half) < SERIES_LIMIT;
+    if (small) {
+        const float h2 = half * half;
+        chord = 1 + h2 * (-1.0f / 6 + h2 * (1.0f / 120));
+        sinHalf = half * chord;
+        cosHalf = 1 + h2 * (-1.0f / 2 + h2 * (1.0f / 24 + h2 * (-1.0f / 720)));
+    } else {
+        const SinCos trig = fastSinCos(half);
+        sinHalf = trig.sin;
+        cosHalf = trig.cos;
+        chord = sinHalf / half;
+    }
+    // 2 * sin(half) * (d / turned + offset), without dividing by the turn
+    const float localY = chord * (dy + turned * verticalOffset);
+    const float localX = chord * (dx + turned * horizontalOffset);
+
+    // the heading halfway through the turn, from the cached trig of the last heading
+    const float sinMiddle = sinTheta * cosHalf + cosTheta * sinHalf;
+    const float cosMiddle = cosTheta * cosHalf - sinTheta * sinHalf;
+    x += localY * sinMiddle - localX * cosMiddle;
+    y += localY * cosMiddle + localX * sinMiddle;
+    theta += turned;
+
+    if (!small || ++sinceResync >= RESYNC_INTERVAL) {
+        resync();
+        return;
+    }
+    sinTheta = sinMiddle * cosHalf + cosMiddle * sinHalf;
+    cosTheta = cosMiddle * cosHalf - sinMiddle * sinHalf;
+}
+
+void FastOdometry::setPose(const lemlib::Pose& pose) {
+    reader.read(previous);
+    x = pose.x;
+    y = pose.y;
+    theta = pose.theta;
+    resync();
+}
+
+void FastOdometry::setGyroBias(GyroBiasEstimator* estimator) {
+    if (estimator == reader.getGyroBias()) return;
+    reader.setGyroBias(estimator);
+    // the two rotations start from different places, so only measure turns from the new one
+    previous.imu = reader.readImu(pros::micros());
+}
+
+lemlib::Pose FastOdometry::getPose() const { return {x, y, theta}; }
+
+bool useFastOdometry(const lemlib::OdomSensors& sensors, const lemlib::Drivetrain& drivetrain) {
+#ifdef ODOM_TASK
+    if (fastOdometry == nullptr) fastOdometry = new FastOdometry(sensors, drivetrain);
+    fastSelected.store(true, std::memory_order_release);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void useLemLibOdometry() { fastSelected.store(false, std::memory_order_release); }
+
+FastOdometry* selectedFastOdometry() {
+    return fastSelected.load(std::memory_order_acquire) ? fastOdometry : nullptr;
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include "gyroBias.hpp"
+#include "odomTask.hpp"
+#include "pros/rtos.hpp"
+
+namespace {
+GyroBiasEstimator* gyroBias = nullptr;
+std::atomic<bool> gyroBiasSelected = false;
+} // namespace
+
+GyroBiasEstimator::GyroBiasEstimator(std::vector<pros::Imu*> imus, std::vector<pros::MotorGroup*> motors,
+                                     const GyroBiasSettings& settings)
+    : motors(std::move(motors)),
+      settings(settings) {
+    for (pros::Imu* imu : imus) gyros.push_back({imu});
+    votes.reserve(gyros.size());
+}
+
+bool GyroBiasEstimator::motorsStopped() const {
+    // without a motor that reads, there is no telling whether the robot moves
+    bool read = false;
+    for (pros::MotorGroup* group : motors) {
+        for (int i = 0; i < group->size(); i++) {
+            const double velocity = group->get_actual_velocity(i);
+            if (!std::isfinite(velocity)) continue;
+            if (std::fabs(velocity) > settings.stoppedVelocity) return false;
+            read = true;
+        }
+    }
+    return read;
+}
+
+double GyroBiasEstimator::update(uint32_t timeMicros) {
+    const double dt = started ? (timeMicros - lastTime) * 1e-6 : 0;
+    if (!started || !motorsStopped()) movedTime = timeMicros;
+    started = true;
+    lastTime = timeMicros;
+    const bool still = timeMicros - movedTime >= settings.settleTime * 1000;
+
+    votes.clear();
+    for (Gyro& gyro : gyros) {
+        // the sensor itself, since a GyroBiasImu reads as this estimator
+        const double raw = gyro.imu->pros::Imu::get_rotation();
+        gyro.step = 0;
+        gyro.reading = false;
+        if (!std::isfinite(raw)) {
+            gyro.last = NAN;
+            continue;
+        }
+        // just started reading. It is lined up with the others below
+        if (std::isnan(gyro.last)) {
+            gyro.last = raw;
+            continue;
+        }
+        const double turned = raw - gyro.last;
+        gyro.last = raw;
+        if (still) {
+            // the running average of the drift rate, over at most biasMemory seconds
+            gyro.biasWeight = std::fmin(gyro.biasWeight + dt, settings.biasMemory);
+            if (gyro.biasWeight > 0) gyro.bias += (turned - gyro.bias * dt) / gyro.biasWeight;
+            gyro.bias = std::clamp<double>(gyro.bias, -settings.maxBias, settings.maxBias);
+        }
+        if (!still || !settings.holdWhenStationary) gyro.step = turned - gyro.bias * dt;
+        gyro.heading += gyro.step;
+        gyro.reading = true;
+        votes.push_back(gyro.heading);
+    }
+
+    // with fewer than 3 there is no telling which one is wrong
+    const bool vote = votes.size() >= 3;
+    double median = 0;
+    if (vote) {
+        std::nth_element(votes.begin(), votes.begin() + votes.size() / 2, votes.end());
+        median = votes[votes.size() / 2];
+    }
+    double step = 0;
+    double bias = 0;
+    int used = 0;
+    for (Gyro& gyro : gyros) {
+        gyro.used = gyro.reading && (!vote || std::fabs(gyro.heading - median) <= settings.outlierThreshold);
+        if (!gyro.used) continue;
+        step += gyro.step;
+        bias += gyro.bias;
+        used++;
+    }
+    if (used > 0) heading += step / used;
+
+    // the heading starts at the average of the first readings
+    if (std::isnan(heading)) {
+        double sum = 0;
+        int count = 0;
+        for (const Gyro& gyro : gyros) {
+            if (std::isnan(gyro.last)) continue;
+            sum += gyro.last;
+            count++;
+        }
+        if (count > 0) heading = sum / count;
+    }
+    // line up IMUs that just started reading, and those that were voted out once they can't be turning
+    for (Gyro& gyro : gyros) {
+        if (std::isnan(gyro.last) || std::isnan(heading)) continue;
+        if (!gyro.reading || (!gyro.used && still)) gyro.heading = heading;
+    }
+
+    lastRotation.store(heading, std::memory_order_relaxed);
+    lastBias.store(used > 0 ? bias / used : 0, std::memory_order_relaxed);
+    wasStationary.store(still, std::memory_order_relaxed);
+    lastUsed.store(used, std::memory_order_relaxed);
+    return heading;
+}
+
+double GyroBiasImu::get_rotation() const {
+    const double raw = pros::Imu::get_rotation();
+    if (!inOdometryTask()) return raw;
+    GyroBiasEstimator* estimator = selectedGyroBias();
+    const double corrected = estimator != nullptr ? estimator->update(pros::micros()) : NAN;
+    // the estimator has no reading yet
+    if (!std::isfinite(corrected)) estimator = nullptr;
+    const double rotation = estimator != nullptr ? corrected : raw;
+    if (!std::isfinite(rotation)) return rotation;
+    // the two rotations start from different places, so carry on from the last one returned
+    if (estimator != source && std::isfinite(last)) offset = last - rotation;
+    source = estimator;
+    last = rotation + offset;
+    return last;
+}
+
+bool useGyroBias(std::vector<pros::Imu*> imus, std::vector<pros::MotorGroup*> motors,
+                 const GyroBiasSettings& settings) {
+#ifdef ODOM_TASK
+    if (gyroBias == nullptr) gyroBias = new GyroBiasEstimator(std::move(imus), std::move(motors), settings);
+    gyroBiasSelected.store(true, std::memory_order_release);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void stopGyroBias() { gyroBiasSelected.store(false, std::memory_order_release); }
+
+GyroBiasEstimator* selectedGyroBias() {
+    return gyroBiasSelected.load(std::memory_order_acquire) ? gyroBias : nullptr;
+}
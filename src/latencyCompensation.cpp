@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+#include "latencyCompensation.hpp"
+#include "lemlib/chassis/odom.hpp"
+#include "lemlib/util.hpp"
+#include "motionEstimator.hpp"
+#include "motionTasks.hpp"
+#include "pros/rtos.hpp"
+#include "sensorSnapshot.hpp"
+
+namespace {
+constexpr float MAX_COMPENSATION = 50;
+// the odometry task publishes an estimate at least every 10ms, in milliseconds
+constexpr int32_t MAX_ESTIMATE_AGE = 100;
+// the robot is at rest once no wheel moves more than this in REST_WINDOW, in inches. The readings of that window are
+// how much the wheels wobble at rest
+constexpr float REST_MOVEMENT = 0.005;
+constexpr uint32_t REST_WINDOW = 200;
+constexpr uint32_t REST_TIMEOUT = 3000;
+// the four wheel slots of a snapshot, and the IMU
+constexpr int SOURCES = 5;
+constexpr int IMU = 4;
+
+std::atomic<float> compensation = 0;
+
+/**
+ * @brief How often one sensor's reading changes while the robot moves
+ */
+struct Source {
+        bool present = false;
+        float last = 0;
+        // when the reading last changed this step, in microseconds, or 0 before it has
+        uint32_t lastChange = 0;
+        // the times between changes, in milliseconds
+        std::vector<float> intervals;
+
+        /**
+         * @brief The median time between changes. A sensor the robot barely moves sometimes reads the same twice, which
+         * only makes a few of the times longer
+         */
+        float interval() {
+            if (intervals.empty()) return 0;
+            std::nth_element(intervals.begin(), intervals.begin() + intervals.size() / 2, intervals.end());
+            return intervals[intervals.size() / 2];
+        }
+};
+
+float value(const OdometrySnapshot& snapshot, int source) {
+    return source == IMU ? snapshot.imu : snapshot.wheels[source];
+}
+
+struct Step {
+        // from setting the voltage to the first reading that moved, in milliseconds
+        float delay;
+        // the sensor that read it
+        int source;
+};
+} // namespace
+
+LatencyMeasurement measureLatency(const lemlib::OdomSensors& sensors, const lemlib::Drivetrain& drivetrain,
+                                  const LatencyTest& test) {
+    LatencyMeasurement result;
+    SnapshotReader reader(sensors, drivetrain);
+    Source sources[SOURCES];
+    for (int i = 0; i < 4; i++) sources[i].present = reader.hasWheel(i);
+    sources[IMU].present = reader.hasImu();
+    std::vector<Step> steps;
+    OdometrySnapshot snapshot;
+
+    for (int step = 0; step < test.steps; step++) {
+        // the range each wheel reads once the robot has stopped. The IMU drifts and shakes, so only the wheels tell
+        // when the robot moves
+        float low[4];
+        float high[4];
+        const uint32_t begin = pros::millis();
+        uint32_t still = begin;
+        reader.read(snapshot);
+        for (int i = 0; i < 4; i++) low[i] = high[i] = snapshot.wheels[i];
+        while (pros::millis() - still < REST_WINDOW && pros::millis() - begin < REST_TIMEOUT) {
+            pros::delay(1);
+            reader.read(snapshot);
+            for (int i = 0; i < 4; i++) {
+                low[i] = std::min(low[i], snapshot.wheels[i]);
+                high[i] = std::max(high[i], snapshot.wheels[i]);
+            }
+            for (int i = 0; i < 4; i++) {
+                if (high[i] - low[i] <= REST_MOVEMENT) continue;
+                // still coasting from the last step
+                for (int j = 0; j < 4; j++) low[j] = high[j] = snapshot.wheels[j];
+                still = pros::millis();
+                break;
+            }
+        }
+        for (int i = 0; i < SOURCES; i++) {
+            sources[i].last = value(snapshot, i);
+            sources[i].lastChange = 0;
+        }
+
+        // forwards, backwards, clockwise and counterclockwise, so the IMU and horizontal wheels move too
+        const int millivolts = std::lround((step % 2 == 0 ? 1 : -1) * test.stepVoltage * 1000);
+        const bool turning = step % 4 >= 2;
+        drivetrain.leftMotors->move_voltage(millivolts);
+        drivetrain.rightMotors->move_voltage(turning ? -millivolts : millivolts);
+        const uint32_t start = uint32_t(pros::micros());
+        bool moved = false;
+        while (uint32_t(pros::micros()) - start < test.stepTime * 1000) {
+            reader.read(snapshot);
+            for (int i = 0; i < SOURCES; i++) {
+                Source& source = sources[i];
+                const float now = value(snapshot, i);
+                if (!source.present || now == source.last || !std::isfinite(now)) continue;
+                source.last = now;
+                // readings only change once the robot moves, so time the changes from then on
+                if (moved) {
+                    if (source.lastChange != 0)
+                        source.intervals.push_back((snapshot.time - source.lastChange) * 1e-3f);
+                    source.lastChange = snapshot.time;
+                }
+            }
+            if (!moved) {
+                for (int i = 0; i < 4 && !moved; i++) {
+                    if (!sources[i].present || (snapshot.wheels[i] >= low[i] && snapshot.wheels[i] <= high[i]))
+                        continue;
+                    steps.push_back({(snapshot.time - start) * 1e-3f, i});
+                    moved = true;
+                    sources[i].lastChange = snapshot.time;
+                }
+                if (!moved && uint32_t(pros::micros()) - start > test.timeout * 1000) break;
+            }
+            pros::delay(1);
+        }
+        // hold the wheels still, so the robot doesn't creep into the next step
+        drivetrain.leftMotors->move_velocity(0);
+        drivetrain.rightMotors->move_velocity(0);
+        if (!moved) break;
+    }
+    drivetrain.leftMotors->brake();
+    drivetrain.rightMotors->brake();
+    if (int(steps.size()) < test.steps) {
+        result.error = "the robot didn't move within the timeout of a step";
+        return result;
+    }
+    if (steps.empty()) {
+        result.error = "no steps to measure";
+        return result;
+    }
+
+    for (Source& source : sources) result.sensorInterval = std::max(result.sensorInterval, source.interval());
+    result.sensorLatency = result.sensorInterval / 2;
+    // the reading that first moved was on average half its sensor's interval old when it was read
+    std::vector<float> delays;
+    for (const Step& step : steps)
+        delays.push_back(std::max(step.delay - sources[step.source].interval() / 2, 0.0f));
+    std::nth_element(delays.begin(), delays.begin() + delays.size() / 2, delays.end());
+    result.actuatorLatency = delays[delays.size() / 2];
+    result.total = result.actuatorLatency + result.sensorLatency;
+    result.ok = true;
+    return result;
+}
+
+void logLatency(const LatencyMeasurement& measurement) {
+    if (!measurement.ok) {
+        lemlib::infoSink()->info("latency measurement failed: {}", measurement.error);
+        return;
+    }
+    lemlib::infoSink()->info("actuator latency {:.1f}ms, sensor latency {:.1f}ms (every {:.1f}ms), total {:.1f}ms",
+                             measurement.actuatorLatency, measurement.sensorLatency, measurement.sensorInterval,
+                             measurement.total);
+}
+
+bool setLatencyCompensation(float milliseconds) {
+#ifdef ODOM_TASK
+    compensation.store(std::clamp(milliseconds, 0.0f, MAX_COMPENSATION), std::memory_order_relaxed);
+    return true;
+#else
+    return false;
+#endif
+}
+
+float latencyCompensation() { return compensation.load(std::memory_order_relaxed); }
+
+lemlib::Pose compensatePose(const lemlib::Pose& pose) {
+    const float lead = compensation.load(std::memory_order_relaxed);
+    MotionEstimate estimate;
+    if (lead <= 0 || !getMotionEstimate(estimate, true)) return pose;
+    // predict from when the sensors were read, not from now. An older estimate is from an odometry task that stopped
+    // updating, and predicting from it would only move the pose further off
+    const int32_t age = int32_t(pros::millis() - estimate.time);
+    if (age < 0 || age > MAX_ESTIMATE_AGE) return pose;
+    const float time = (lead + age) * 1e-3f;
+    return pose + (estimate.velocity + estimate.acceleration * (time / 2)) * time;
+}
+
+lemlib::Pose getCompensatedPose(bool radians) {
+    // a motion's task already gets the prediction from lemlib::getPose()
+    if (inMotionTask()) return lemlib::getPose(radians);
+    lemlib::Pose pose = compensatePose(lemlib::getPose(true));
+    if (!radians) pose.theta = lemlib::radToDeg(pose.theta);
+    return pose;
+}
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cmath>
+#include "lemlib/api.hpp" // IWYU pragma: keep
+#include "loopTiming.hpp"
+#include "odomTask.hpp"
+#include "pros/rtos.hpp"
+#include "sensorLog.hpp"
+
+namespace {
+LoopStats odometry;
+LoopStats motion;
+LoopStats allMotions;
+
+void atomicMax(std::atomic<uint32_t>& value, uint32_t sample) {
+    uint32_t current = value.load(std::memory_order_relaxed);
+    while (sample > current && !value.compare_exchange_weak(current, sample, std::memory_order_relaxed));
+}
+
+float toMillis(uint32_t micros) { return micros / 1000.0f; }
+} // namespace
+
+void LoopHistogram::record(uint32_t micros) {
+    counts[std::min(micros / BIN_WIDTH, BINS - 1)].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t LoopHistogram::percentile(float fraction) const {
+    const uint32_t count = total();
+    if (count == 0) return 0;
+    const uint32_t rank = std::max(uint32_t(1), uint32_t(std::ceil(fraction * count)));
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < BINS; i++) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return (i + 1) * BIN_WIDTH;
+    }
+    // samples were counted after total() was read
+    return BINS * BIN_WIDTH;
+}
+
+uint32_t LoopHistogram::total() const {
+    uint32_t count = 0;
+    for (const auto& bin : counts) count += bin.load(std::memory_order_relaxed);
+    return count;
+}
+
+void LoopHistogram::reset() {
+    for (auto& bin : counts) bin.store(0, std::memory_order_relaxed);
+}
+
+void LoopStats::add(const LoopStats& other) {
+    for (uint32_t i = 0; i < LoopHistogram::BINS; i++) {
+        period.counts[i].fetch_add(other.period.counts[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        work.counts[i].fetch_add(other.work.counts[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        jitter.counts[i].fetch_add(other.jitter.counts[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    iterations.fetch_add(other.iterations.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    missedDeadlines.fetch_add(other.missedDeadlines.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    atomicMax(maxPeriod, other.maxPeriod.load(std::memory_order_relaxed));
+    atomicMax(maxJitter, other.maxJitter.load(std::memory_order_relaxed));
+}
+
+void LoopStats::reset() {
+    period.reset();
+    work.reset();
+    jitter.reset();
+    iterations.store(0, std::memory_order_relaxed);
+    missedDeadlines.store(0, std::memory_order_relaxed);
+    maxPeriod.store(0, std::memory_order_relaxed);
+    maxJitter.store(0, std::memory_order_relaxed);
+}
+
+const LoopStats& odometryTiming() { return odometry; }
+
+const LoopStats& motionTiming() { return motion; }
+
+const LoopStats& allMotionTiming() { return allMotions; }
+
+void resetLoopTiming() {
+    odometry.reset();
+    motion.reset();
+    allMotions.reset();
+}
+
+void logLoopTiming(const char* name, const LoopStats& stats) {
+    lemlib::infoSink()->info("{}: {} iterations, period p50 {:.1f}ms p99 {:.1f}ms max {:.1f}ms, work p99 {:.1f}ms, "
+                             "jitter p99 {:.1f}ms max {:.1f}ms, {} missed deadlines",
+                             name, stats.iterations.load(), toMillis(stats.period.percentile(0.5)),
+                             toMillis(stats.period.percentile(0.99)), toMillis(stats.maxPeriod.load()),
+                             toMillis(stats.work.percentile(0.99)), toMillis(stats.jitter.percentile(0.99)),
+                             toMillis(stats.maxJitter.load()), stats.missedDeadlines.load());
+}
+
+#ifdef LOOP_TIMING
+// LemLib is not built with this project, so its loops are timed by linking with --wrap for each of the functions
+// below (see LOOP_TIMING_WRAP in common.mk). Every call LemLib makes to them goes through here first. The sensor log
+// uses the same hooks to see what the odometry task reads. Motions are hooked in motionTasks.cpp, which calls in here
+
+namespace {
+/**
+ * @brief A task whose loop is being timed
+ *
+ * Only the task itself touches a capture once it has claimed it, so the only shared state is which task owns it.
+ */
+struct Capture {
+        std::atomic<pros::task_t> task = nullptr;
+        LoopStats* stats = nullptr;
+        // when the current iteration started, in microseconds
+        uint32_t iterationStart = 0;
+};
+
+// the odometry task, the task running a motion, and the callers of async motions while they hand the motion over
+constexpr int MAX_CAPTURES = 8;
+Capture captures[MAX_CAPTURES];
+// the task that runs odometry, once it has read a tracking wheel
+std::atomic<pros::task_t> odometryTask = nullptr;
+
+uint32_t now() { return uint32_t(pros::c::micros()); }
+
+Capture* find(pros::task_t task) {
+    for (Capture& capture : captures) {
+        if (capture.task.load(std::memory_order_acquire) == task) return &capture;
+    }
+    return nullptr;
+}
+
+void begin(LoopStats& stats) {
+    const pros::task_t task = pros::c::task_get_current();
+    Capture* capture = find(task);
+    for (int i = 0; capture == nullptr && i < MAX_CAPTURES; i++) {
+        pros::task_t free = nullptr;
+        if (captures[i].task.compare_exchange_strong(free, task, std::memory_order_acq_rel)) capture = &captures[i];
+    }
+    // every capture is in use, so this loop goes untimed
+    if (capture == nullptr) return;
+    capture->stats = &stats;
+    capture->iterationStart = now();
+}
+
+/**
+ * @brief Time a delay that ends an iteration
+ *
+ * @param milliseconds the period the loop asked for
+ * @param wake when the loop asked to wake up, in microseconds
+ * @param delay does the delay
+ */
+template <typename Delay> void timedDelay(uint32_t milliseconds, uint32_t wake, Delay delay) {
+    Capture* capture = find(pros::c::task_get_current());
+    if (capture == nullptr) {
+        delay();
+        return;
+    }
+    LoopStats& stats = *capture->stats;
+#ifdef SENSOR_LOG
+    // the odometry task delays once per update, after it has read every sensor
+    if (capture->stats == &odometry) finishSensorLogRecord();
+#endif
+    const uint32_t start = now();
+    stats.work.record(start - capture->iterationStart);
+    delay();
+    const uint32_t end = now();
+    const uint32_t requested = milliseconds * 1000;
+    const uint32_t late = int32_t(end - wake) > 0 ? end - wake : 0;
+    const uint32_t period = end - capture->iterationStart;
+    stats.period.record(period);
+    stats.jitter.record(late);
+    atomicMax(stats.maxPeriod, period);
+    atomicMax(stats.maxJitter, late);
+    if (period > requested + LoopStats::DEADLINE_SLACK) stats.missedDeadlines.fetch_add(1, std::memory_order_relaxed);
+    stats.iterations.fetch_add(1, std::memory_order_relaxed);
+    capture->iterationStart = end;
+}
+} // namespace
+
+extern "C" {
+void __real_delay(uint32_t milliseconds);
+void __real_task_delay(uint32_t milliseconds);
+void __real_task_delay_until(uint32_t* previous, uint32_t milliseconds);
+float __real__ZN6lemlib13TrackingWheel19getDistanceTraveledEv(lemlib::TrackingWheel* wheel);
+
+void __wrap_delay(uint32_t milliseconds) {
+    timedDelay(milliseconds, now() + milliseconds * 1000, [&] { __real_delay(milliseconds); });
+}
+
+void __wrap_task_delay(uint32_t milliseconds) {
+    timedDelay(milliseconds, now() + milliseconds * 1000, [&] { __real_task_delay(milliseconds); });
+}
+
+void __wrap_task_delay_until(uint32_t* previous, uint32_t milliseconds) {
+    timedDelay(milliseconds, (*previous + milliseconds) * 1000, [&] { __real_task_delay_until(previous, milliseconds); });
+}
+
+float __wrap__ZN6lemlib13TrackingWheel19getDistanceTraveledEv(lemlib::TrackingWheel* wheel) {
+    // lemlib::update() is called from the file it is defined in, where --wrap can't reach it, so the odometry task is
+    // found by the tracking wheels it reads instead: the task of include/odomTask.hpp when it runs, or else the first
+    // task that reads one. Others that read them, like measureLatency(), aren't odometry
+    const pros::task_t current = pros::c::task_get_current();
+    pros::task_t latched = nullptr;
+    if (!odometryTaskRunning() || inOdometryTask()) odometryTask.compare_exchange_strong(latched, current);
+    if (current == odometryTask.load() && find(current) == nullptr) begin(odometry);
+    const float distance = __real__ZN6lemlib13TrackingWheel19getDistanceTraveledEv(wheel);
+#ifdef SENSOR_LOG
+    logWheelReading(wheel, distance);
+#endif
+    return distance;
+}
+}
+
+void startMotionTiming() {
+    motion.reset();
+    begin(motion);
+}
+
+void endMotionTiming() {
+    Capture* capture = find(pros::c::task_get_current());
+    if (capture != nullptr && capture->stats == &motion) {
+        allMotions.add(motion);
+        capture->task.store(nullptr, std::memory_order_release);
+    }
+}
+#endif
@@ -0,0 +1,161 @@
+#include <atomic>
+#include <cmath>
+#include "lemlib/chassis/odom.hpp"
+#include "lemlib/util.hpp"
+#include "motionEstimator.hpp"
+#include "pros/rtos.hpp"
+#include "seqlock.hpp"
+
+namespace {
+// the settings, which any task can change
+std::atomic<float> linearTimeConstant = MotionEstimatorSettings().linearTimeConstant;
+std::atomic<float> angularTimeConstant = MotionEstimatorSettings().angularTimeConstant;
+std::atomic<float> noiseMemory = MotionEstimatorSettings().noiseMemory;
+std::atomic<uint32_t> maxGap = MotionEstimatorSettings().maxGap;
+
+/**
+ * @brief One of x, y and theta
+ */
+struct Axis {
+        float position = 0;
+        float velocity = 0;
+        float acceleration = 0;
+        // average square of how far the measured position was from the predicted one
+        float variance = 0;
+        float velocityNoise = 0;
+        float accelerationNoise = 0;
+
+        void restart(float measured) { *this = {measured}; }
+
+        /**
+         * @brief Predict the position, and correct the prediction by the measurement
+         *
+         * @param dt time since the last step, in seconds
+         * @param timeConstant in seconds
+         * @param noiseWeight how much of the variance is the square error of this step
+         */
+        void step(float measured, float dt, float timeConstant, float noiseWeight) {
+            // critically damped: all three gains come from how much of an error is left after one step
+            const float left = timeConstant > 0 ? std::exp(-dt / timeConstant) : 0;
+            const float gained = 1 - left;
+            const float g = 1 - left * left * left;
+            const float h = 1.5f * gained * gained * (1 + left);
+            const float k = 0.5f * gained * gained * gained;
+
+            const float predicted = position + (velocity + acceleration * dt / 2) * dt;
+            const float error = measured - predicted;
+            position = predicted + g * error;
+            velocity += acceleration * dt + h * error / dt;
+            acceleration += 2 * k * error / (dt * dt);
+
+            variance += (error * error - variance) * noiseWeight;
+            const float deviation = std::sqrt(variance);
+            velocityNoise = h * deviation / dt;
+            accelerationNoise = 2 * k * deviation / (dt * dt);
+        }
+};
+
+// the filter. Only the odometry task touches these
+Axis axes[3];
+bool started = false;
+uint32_t lastTime = 0;
+MotionEstimate estimate;
+
+// the last estimate, in radians, written by the odometry task and read by any task without a lock
+Seqlock<MotionEstimate> published;
+
+void publish() { published.write(estimate); }
+
+/**
+ * @brief A field frame value in the frame of the robot
+ */
+lemlib::Pose toLocal(const lemlib::Pose& field, float theta) {
+    const float sin = std::sin(theta);
+    const float cos = std::cos(theta);
+    return {field.x * cos - field.y * sin, field.x * sin + field.y * cos, field.theta};
+}
+
+lemlib::Pose inUnits(lemlib::Pose pose, bool radians) {
+    if (!radians) pose.theta = lemlib::radToDeg(pose.theta);
+    return pose;
+}
+} // namespace
+
+void setMotionEstimatorSettings(const MotionEstimatorSettings& settings) {
+    linearTimeConstant.store(settings.linearTimeConstant, std::memory_order_relaxed);
+    angularTimeConstant.store(settings.angularTimeConstant, std::memory_order_relaxed);
+    noiseMemory.store(settings.noiseMemory, std::memory_order_relaxed);
+    maxGap.store(settings.maxGap, std::memory_order_relaxed);
+}
+
+bool getMotionEstimate(MotionEstimate& estimate, bool radians) {
+    MotionEstimate copy;
+    if (!published.read(copy)) return false;
+    if (!radians) {
+        for (lemlib::Pose* pose : {&copy.pose, &copy.velocity, &copy.acceleration, &copy.localVelocity,
+                                   &copy.localAcceleration, &copy.velocityNoise, &copy.accelerationNoise})
+            pose->theta = lemlib::radToDeg(pose->theta);
+    }
+    estimate = copy;
+    return true;
+}
+
+lemlib::Pose getVelocity(bool local, bool radians) {
+    MotionEstimate estimate;
+    if (!getMotionEstimate(estimate, radians)) return {0, 0, 0};
+    return local ? estimate.localVelocity : estimate.velocity;
+}
+
+lemlib::Pose getAcceleration(bool local, bool radians) {
+    MotionEstimate estimate;
+    if (!getMotionEstimate(estimate, radians)) return {0, 0, 0};
+    return local ? estimate.localAcceleration : estimate.acceleration;
+}
+
+lemlib::Pose predictPose(float time, bool radians) {
+    MotionEstimate estimate;
+    if (!getMotionEstimate(estimate, true)) return lemlib::getPose(radians);
+    // the sensors were read a moment before the estimate was published
+    time += int32_t(pros::millis() - estimate.time) * 1e-3f;
+    return inUnits(estimate.pose + (estimate.velocity + estimate.acceleration * (time / 2)) * time, radians);
+}
+
+lemlib::Pose updateMotionEstimate(uint32_t time, const lemlib::Pose& pose) {
+    const float measured[3] = {pose.x, pose.y, pose.theta};
+    const float dt = (time - lastTime) * 1e-6f;
+    if (!started || dt * 1000 > maxGap.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < 3; i++) axes[i].restart(measured[i]);
+        started = true;
+        lastTime = time;
+        return {0, 0, 0};
+    }
+    // a second reading of the same sensors has nothing new in it
+    if (dt <= 0) return estimate.velocity;
+    lastTime = time;
+
+    const float memory = noiseMemory.load(std::memory_order_relaxed) * 1e-3f;
+    const float noiseWeight = dt / (memory + dt);
+    const float linear = linearTimeConstant.load(std::memory_order_relaxed) * 1e-3f;
+    axes[0].step(measured[0], dt, linear, noiseWeight);
+    axes[1].step(measured[1], dt, linear, noiseWeight);
+    axes[2].step(measured[2], dt, angularTimeConstant.load(std::memory_order_relaxed) * 1e-3f, noiseWeight);
+
+    // time is on the 32 bit microsecond clock, which wraps after about 71 minutes, so only its age is used, to stamp
+    // the estimate on the millisecond clock predictPose() measures from
+    estimate.time = pros::millis() - (uint32_t(pros::micros()) - time) / 1000;
+    estimate.pose = pose;
+    estimate.velocity = {axes[0].velocity, axes[1].velocity, axes[2].velocity};
+    estimate.acceleration = {axes[0].acceleration, axes[1].acceleration, axes[2].acceleration};
+    estimate.localVelocity = toLocal(estimate.velocity, pose.theta);
+    estimate.localAcceleration = toLocal(estimate.acceleration, pose.theta);
+    estimate.velocityNoise = {axes[0].velocityNoise, axes[1].velocityNoise, axes[2].velocityNoise};
+    estimate.accelerationNoise = {axes[0].accelerationNoise, axes[1].accelerationNoise, axes[2].accelerationNoise};
+    publish();
+    return estimate.velocity;
+}
+
+void moveMotionEstimate(const lemlib::Pose& pose) {
+    axes[0].position = pose.x;
+    axes[1].position = pose.y;
+    axes[2].position = pose.theta;
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cmath>
+#include "motionProfile.hpp"
+
+namespace {
+// enough to find the peak velocity to well under a thousandth of an inch per second
+constexpr int BISECTIONS = 30;
+
+/**
+ * @brief An S-curve from one velocity to another
+ */
+struct Ramp {
+        float time = 0;
+        // how long the acceleration takes to build up, and to let off again
+        float jerkTime = 0;
+        float peakAcceleration = 0;
+};
+
+Ramp ramp(float change, const ProfileConstraints& constraints) {
+    const float acceleration = constraints.maxAcceleration;
+    const float jerk = constraints.maxJerk;
+    change = std::fabs(change);
+    if (change <= 0) return {};
+    if (jerk <= 0) return {change / acceleration, 0, acceleration};
+    // long enough to reach the acceleration limit
+    if (change * jerk >= acceleration * acceleration)
+        return {change / acceleration + acceleration / jerk, acceleration / jerk, acceleration};
+    const float jerkTime = std::sqrt(change / jerk);
+    return {2 * jerkTime, jerkTime, jerkTime * jerk};
+}
+
+float rampDistance(float from, float to, const ProfileConstraints& constraints) {
+    return (from + to) / 2 * ramp(to - from, constraints).time;
+}
+
+/**
+ * @brief Where an increasing function crosses 0, between low and high
+ */
+template <typename F> float bisect(float low, float high, F f) {
+    for (int i = 0; i < BISECTIONS; i++) {
+        const float middle = (low + high) / 2;
+        if (f(middle) > 0) high = middle;
+        else low = middle;
+    }
+    return low;
+}
+} // namespace
+
+MotionProfile::MotionProfile(float distance, const ProfileConstraints& constraints, float startVelocity,
+                             float endVelocity) {
+    if (constraints.maxVelocity <= 0 || constraints.maxAcceleration <= 0) return;
+    sign = distance < 0 ? -1 : 1;
+    distance = std::fabs(distance);
+    const float top = constraints.maxVelocity;
+    const float start = std::clamp(startVelocity, 0.0f, top);
+    float finish = std::clamp(endVelocity, 0.0f, top);
+    auto total = [&](float peak) {
+        return rampDistance(start, peak, constraints) + rampDistance(peak, finish, constraints);
+    };
+
+    float peak;
+    if (total(std::max(start, finish)) > distance) {
+        if (finish > start) {
+            // too short to speed up to the end velocity, so arrive as fast as the distance allows
+            finish = bisect(start, finish, [&](float v) { return rampDistance(start, v, constraints) - distance; });
+            peak = finish;
+        } else {
+            // too fast to slow down in time
+            peak = start;
+        }
+    } else if (total(top) <= distance) {
+        peak = top;
+    } else {
+        peak = bisect(std::max(start, finish), top, [&](float v) { return total(v) - distance; });
+    }
+    const float cruise = peak > 0 ? std::max(distance - total(peak), 0.0f) / peak : 0;
+
+    const Ramp up = ramp(peak - start, constraints);
+    const Ramp down = ramp(peak - finish, constraints);
+    const float jerk = std::max(constraints.maxJerk, 0.0f);
+    const float durations[PHASES] = {up.jerkTime, std::max(up.time - 2 * up.jerkTime, 0.0f), up.jerkTime, cruise,
+                                     down.jerkTime, std::max(down.time - 2 * down.jerkTime, 0.0f), down.jerkTime};
+    const float accelerations[PHASES] = {0, up.peakAcceleration, up.peakAcceleration, 0, 0, -down.peakAcceleration,
+                                         -down.peakAcceleration};
+    const float phaseJerks[PHASES] = {jerk, 0, -jerk, 0, -jerk, 0, jerk};
+
+    starts[0] = {0, start, 0};
+    for (int i = 0; i < PHASES; i++) {
+        const float t = durations[i];
+        const float a = accelerations[i];
+        // a phase without a jerk time has no jerk, or a trapezoidal profile would pick it up
+        jerks[i] = durations[i] > 0 ? phaseJerks[i] : 0;
+        starts[i].acceleration = a;
+        starts[i + 1].position = starts[i].position + (starts[i].velocity + (a / 2 + jerks[i] * t / 6) * t) * t;
+        starts[i + 1].velocity = starts[i].velocity + (a + jerks[i] * t / 2) * t;
+        startTimes[i + 1] = startTimes[i] + t;
+    }
+    starts[PHASES].velocity = finish;
+}
+
+ProfileState MotionProfile::sample(float time) const {
+    time = std::max(time, 0.0f);
+    int phase = 0;
+    while (phase < PHASES && time >= startTimes[phase + 1]) phase++;
+    if (phase == PHASES) return {sign * starts[PHASES].position, sign * starts[PHASES].velocity, 0};
+    const ProfileState& from = starts[phase];
+    const float t = time - startTimes[phase];
+    const float j = jerks[phase];
+    return {sign * (from.position + (from.velocity + (from.acceleration / 2 + j * t / 6) * t) * t),
+            sign * (from.velocity + (from.acceleration + j * t / 2) * t), sign * (from.acceleration + j * t)};
+}
@@ -0,0 +1,84 @@
+#include <atomic>
+#include "loopTiming.hpp"
+#include "motionTasks.hpp"
+#include "pros/rtos.hpp"
+
+namespace {
+/**
+ * @brief The task running a motion on a chassis
+ *
+ * A chassis runs one motion at a time, so a motion that starts takes over the slot of its chassis. A task that was
+ * stopped in the middle of a motion, like the autonomous task at the end of the period, is forgotten that way.
+ */
+struct MotionSlot {
+        std::atomic<lemlib::Chassis*> chassis = nullptr;
+        std::atomic<pros::task_t> task = nullptr;
+};
+
+// chassis running motions at once. Motions on any more go untracked
+constexpr int MAX_CHASSIS = 4;
+MotionSlot slots[MAX_CHASSIS];
+
+std::atomic<void (*)(lemlib::Chassis*)> startedListener = nullptr;
+std::atomic<void (*)(lemlib::Chassis*)> endedListener = nullptr;
+} // namespace
+
+bool inMotionTask() {
+    const pros::task_t task = pros::c::task_get_current();
+    for (const MotionSlot& slot : slots) {
+        if (slot.task.load(std::memory_order_acquire) != task) continue;
+        lemlib::Chassis* const chassis = slot.chassis.load(std::memory_order_relaxed);
+        // a task that was stopped in a motion can be followed by a new one with the same handle
+        return chassis != nullptr && chassis->isInMotion();
+    }
+    return false;
+}
+
+void setMotionListener(void (*started)(lemlib::Chassis* chassis), void (*ended)(lemlib::Chassis* chassis)) {
+    startedListener = started;
+    endedListener = ended;
+}
+
+#ifdef MOTION_HOOKS
+extern "C" {
+void __real__ZN6lemlib7Chassis18requestMotionStartEv(lemlib::Chassis* chassis);
+void __real__ZN6lemlib7Chassis9endMotionEv(lemlib::Chassis* chassis);
+
+void __wrap__ZN6lemlib7Chassis18requestMotionStartEv(lemlib::Chassis* chassis) {
+    __real__ZN6lemlib7Chassis18requestMotionStartEv(chassis);
+    if (auto started = startedListener.load()) started(chassis);
+    // a motion that was cancelled while it waited in the queue never runs
+    if (!chassis->isInMotion()) return;
+    const pros::task_t task = pros::c::task_get_current();
+    MotionSlot* claimed = nullptr;
+    for (MotionSlot& slot : slots) {
+        lemlib::Chassis* free = nullptr;
+        if (slot.chassis.load(std::memory_order_acquire) == chassis ||
+            slot.chassis.compare_exchange_strong(free, chassis, std::memory_order_acq_rel)) {
+            claimed = &slot;
+            break;
+        }
+    }
+    if (claimed != nullptr) claimed->task.store(task, std::memory_order_release);
+#ifdef LOOP_TIMING
+    startMotionTiming();
+#endif
+}
+
+void __wrap__ZN6lemlib7Chassis9endMotionEv(lemlib::Chassis* chassis) {
+#ifdef LOOP_TIMING
+    endMotionTiming();
+#endif
+    const pros::task_t task = pros::c::task_get_current();
+    for (MotionSlot& slot : slots) {
+        if (slot.chassis.load(std::memory_order_acquire) != chassis) continue;
+        // the caller of an async motion ends its part after the motion's own task may have taken over the slot
+        pros::task_t running = task;
+        slot.task.compare_exchange_strong(running, nullptr, std::memory_order_acq_rel);
+        break;
+    }
+    if (auto ended = endedListener.load()) ended(chassis);
+    __real__ZN6lemlib7Chassis9endMotionEv(chassis);
+}
+}
+#endif
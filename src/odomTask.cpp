@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <atomic>
+#include "lemlib/chassis/odom.hpp"
+#include "fastOdometry.hpp"
+#include "gyroBias.hpp"
+#include "latencyCompensation.hpp"
+#include "lemlib/util.hpp"
+#include "motionEstimator.hpp"
+#include "motionTasks.hpp"
+#include "odomTask.hpp"
+#include "poseEstimator.hpp"
+#include "poseHistory.hpp"
+#include "pros/rtos.hpp"
+#include "seqlock.hpp"
+#include "slipDetector.hpp"
+
+namespace {
+constexpr uint32_t MIN_PERIOD = 1;
+constexpr uint32_t MAX_PERIOD = 10;
+
+std::atomic<uint32_t> period = 5;
+std::atomic<pros::task_t> odometryTask = nullptr;
+} // namespace
+
+void setOdometryPeriod(uint32_t milliseconds) { period = std::clamp(milliseconds, MIN_PERIOD, MAX_PERIOD); }
+
+#ifdef ODOM_TASK
+uint32_t odometryPeriod() { return period.load(); }
+#else
+uint32_t odometryPeriod() { return 10; }
+#endif
+
+bool odometryTaskRunning() { return odometryTask.load() != nullptr; }
+
+bool inOdometryTask() {
+    const pros::task_t task = odometryTask.load();
+    return task != nullptr && task == pros::c::task_get_current();
+}
+
+#ifdef ODOM_TASK
+namespace {
+// the pose after the last update, in radians
+Seqlock<lemlib::Pose> published;
+// the last pose passed to setPose(), in radians. Written under pendingMutex, since any task can set the pose
+Seqlock<lemlib::Pose> pending;
+pros::Mutex pendingMutex;
+// how many times setPose() has been called, and how many of those the odometry task has applied
+std::atomic<uint32_t> pendingCount = 0;
+std::atomic<uint32_t> appliedCount = 0;
+
+lemlib::Pose read(const Seqlock<lemlib::Pose>& seqlock) {
+    // published is written before the odometry task starts, and pending before pendingCount moves
+    lemlib::Pose pose(0, 0, 0);
+    seqlock.read(pose);
+    return pose;
+}
+} // namespace
+
+extern "C" {
+lemlib::Pose __real__ZN6lemlib7getPoseEb(bool radians);
+void __real__ZN6lemlib7setPoseENS_4PoseEb(lemlib::Pose pose, bool radians);
+}
+
+namespace {
+void runOdometry() {
+    uint32_t wake = pros::millis();
+    // the integrator of the last update
+    FastOdometry* integrator = nullptr;
+    while (true) {
+        // a task that is setting the pose holds the mutex for a moment. Rather than wait for it, apply the pose next
+        // update
+        uint32_t applying = appliedCount.load(std::memory_order_relaxed);
+        if (pendingCount.load(std::memory_order_acquire) != applying && pendingMutex.take(0)) {
+            applying = pendingCount.load(std::memory_order_relaxed);
+            const lemlib::Pose pose = read(pending);
+            __real__ZN6lemlib7setPoseENS_4PoseEb(pose, true);
+            pendingMutex.give();
+            if (integrator != nullptr) integrator->setPose(pose);
+            resetPoseEstimate(pose);
+            clearPoseHistory();
+            moveMotionEstimate(pose);
+        }
+        // switch integrators without moving the pose
+        FastOdometry* const selected = selectedFastOdometry();
+        if (selected != integrator) {
+            const lemlib::Pose pose = __real__ZN6lemlib7getPoseEb(true);
+            if (selected != nullptr) {
+                selected->setPose(pose);
+            } else {
+                // LemLib only keeps the last readings, so catch them up. The pose is put back below
+                lemlib::update();
+            }
+            __real__ZN6lemlib7setPoseENS_4PoseEb(pose, true);
+            integrator = selected;
+        }
+        uint32_t time = pros::micros();
+        if (integrator != nullptr) {
+            integrator->setGyroBias(selectedGyroBias());
+            integrator->update();
+            // keep LemLib's pose up to date, for switching back and for estimatePose()
+            __real__ZN6lemlib7setPoseENS_4PoseEb(integrator->getPose(), true);
+            publishOdometrySnapshot(integrator->lastSnapshot());
+            time = integrator->lastSnapshot().time;
+        } else {
+            lemlib::update();
+        }
+        detectSlip(integrator != nullptr ? &integrator->lastSnapshot() : nullptr);
+        lemlib::Pose pose = __real__ZN6lemlib7getPoseEb(true);
+        if (poseEstimatorRunning()) pose = fusePose(pose);
+        published.write(pose);
+        // lemlib::getSpeed() assumes odometry updates every 10ms, and is noisy, so filter the velocity here instead
+        recordPoseSample(time, pose, updateMotionEstimate(time, pose));
+        // only once the new pose is published, so readers always see one or the other
+        appliedCount.store(applying, std::memory_order_release);
+        // the C call, so the loop timing hooks see it
+        pros::c::task_delay_until(&wake, period.load(std::memory_order_relaxed));
+    }
+}
+
+lemlib::Pose inUnits(lemlib::Pose pose, bool radians) {
+    if (!radians) pose.theta = lemlib::radToDeg(pose.theta);
+    return pose;
+}
+} // namespace
+
+// the project is linked with --wrap for each of these, so every call LemLib and the project make goes through here
+extern "C" {
+void __wrap__ZN6lemlib4initEv() {
+    if (odometryTask.load() != nullptr) return;
+    published.write(__real__ZN6lemlib7getPoseEb(true));
+    pros::Task task(runOdometry, TASK_PRIORITY_MAX - 2, TASK_STACK_DEPTH_DEFAULT, "odometry");
+    odometryTask = static_cast<pros::task_t>(task);
+}
+
+lemlib::Pose __wrap__ZN6lemlib7getPoseEb(bool radians) {
+    const pros::task_t task = odometryTask.load();
+    if (task == nullptr || task == pros::c::task_get_current()) return __real__ZN6lemlib7getPoseEb(radians);
+    // a pose that was set but not applied yet is newer than the published one
+    const bool applied = pendingCount.load(std::memory_order_acquire) == appliedCount.load(std::memory_order_acquire);
+    const lemlib::Pose pose = read(applied ? published : pending);
+    // motions steer by where the robot will be once their commands take effect. Everything else, like code that reads
+    // the pose to set it again, gets the measured pose
+    return inUnits(inMotionTask() ? compensatePose(pose) : pose, radians);
+}
+
+void __wrap__ZN6lemlib7setPoseENS_4PoseEb(lemlib::Pose pose, bool radians) {
+    if (odometryTask.load() == nullptr) {
+        __real__ZN6lemlib7setPoseENS_4PoseEb(pose, radians);
+        return;
+    }
+    if (!radians) pose.theta = lemlib::degToRad(pose.theta);
+    pendingMutex.take();
+    pending.write(pose);
+    pendingCount.fetch_add(1, std::memory_order_release);
+    pendingMutex.give();
+}
+}
+#endif
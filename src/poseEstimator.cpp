@@ -0,0 +1,228 @@
+#include <atomic>
+#include <cmath>
+#include "lemlib/util.hpp"
+#include "poseEstimator.hpp"
+#include "pros/rtos.hpp"
+#include "seqlock.hpp"
+
+namespace {
+using Matrix = std::array<std::array<float, 3>, 3>;
+
+constexpr float INCHES_PER_METER = 39.3701;
+// GPS readings are never trusted more than this, in inches
+constexpr float MIN_GPS_ERROR = 0.25;
+
+enum { X, Y, THETA };
+
+float square(float value) { return value * value; }
+
+// set once by startPoseEstimator, before running is
+PoseEstimatorSettings settings;
+pros::Imu* imu = nullptr;
+pros::Gps* gps = nullptr;
+std::atomic<bool> running = false;
+
+// the filter. Only the odometry task touches these
+bool initialized = false;
+float state[3] = {};
+Matrix covariance = {};
+// the odometry pose of the last update, in radians
+lemlib::Pose lastOdometry(0, 0, 0);
+// added to the IMU rotation to get the heading, in radians. NAN until the IMU has been read
+double imuOffset = NAN;
+uint32_t lastGps = 0;
+int outliers = 0;
+uint32_t gpsFused = 0;
+uint32_t gpsRejected = 0;
+
+// the last estimate, written by the odometry task and read by any task without a lock
+Seqlock<PoseEstimate> published;
+
+void publish() {
+    PoseEstimate estimate;
+    estimate.pose = {state[X], state[Y], state[THETA]};
+    estimate.covariance = covariance;
+    estimate.gpsFused = gpsFused;
+    estimate.gpsRejected = gpsRejected;
+    published.write(estimate);
+}
+
+// NAN without an IMU, which is always the case without ODOM_TASK
+double imuHeading() {
+    const double rotation = imu != nullptr ? imu->get_rotation() : NAN;
+    return std::isfinite(rotation) ? lemlib::degToRad(rotation) : NAN;
+}
+
+/**
+ * @brief Kalman update with a measurement of one state variable
+ *
+ * Measurements with independent noise can be fused one variable at a time, which saves inverting a matrix.
+ *
+ * @param index the variable measured
+ * @param innovation the measurement minus the estimate
+ * @param variance variance of the measurement
+ */
+void fuse(int index, float innovation, float variance) {
+    const float total = covariance[index][index] + variance;
+    float gain[3];
+    for (int r = 0; r < 3; r++) gain[r] = covariance[r][index] / total;
+    for (int r = 0; r < 3; r++) state[r] += gain[r] * innovation;
+    Matrix next;
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) next[r][c] = covariance[r][c] - gain[r] * covariance[index][c];
+    }
+    // keep it symmetric as rounding errors add up
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) covariance[r][c] = (next[r][c] + next[c][r]) / 2;
+    }
+}
+
+/**
+ * @brief Move the estimate by how far odometry moved, in the frame of the robot
+ */
+void predict(const lemlib::Pose& odometry) {
+    const float dx = odometry.x - lastOdometry.x;
+    const float dy = odometry.y - lastOdometry.y;
+    const float turned = odometry.theta - lastOdometry.theta;
+    // how far the robot moved forwards and to its right, at the heading halfway through the update
+    const float odometryHeading = lastOdometry.theta + turned / 2;
+    const float forward = dx * std::sin(odometryHeading) + dy * std::cos(odometryHeading);
+    const float lateral = dx * std::cos(odometryHeading) - dy * std::sin(odometryHeading);
+    lastOdometry = odometry;
+
+    const float heading = state[THETA] + turned / 2;
+    const float sin = std::sin(heading);
+    const float cos = std::cos(heading);
+    state[X] += forward * sin + lateral * cos;
+    state[Y] += forward * cos - lateral * sin;
+    state[THETA] += turned;
+
+    // covariance = F * covariance * F^T, where F is the jacobian of the motion. Only the heading column differs from
+    // the identity
+    const float dxByTheta = forward * cos - lateral * sin;
+    const float dyByTheta = -forward * sin - lateral * cos;
+    Matrix next = covariance;
+    for (int c = 0; c < 3; c++) {
+        next[X][c] += dxByTheta * covariance[THETA][c];
+        next[Y][c] += dyByTheta * covariance[THETA][c];
+    }
+    for (int r = 0; r < 3; r++) {
+        covariance[r][X] = next[r][X] + next[r][THETA] * dxByTheta;
+        covariance[r][Y] = next[r][Y] + next[r][THETA] * dyByTheta;
+        covariance[r][THETA] = next[r][THETA];
+    }
+
+    // process noise, turned from the frame of the robot into the global frame. The variance grows with how far the
+    // robot moved rather than with its square, so it adds up the same however often odometry updates
+    const float distance = std::hypot(forward, lateral);
+    const float forwardVariance = square(settings.forwardNoise) * distance;
+    const float lateralVariance = square(settings.lateralNoise) * distance;
+    const float headingVariance = square(lemlib::degToRad(settings.turnNoise)) * lemlib::radToDeg(std::fabs(turned)) +
+                                  square(lemlib::degToRad(settings.driftNoise)) * distance;
+    covariance[X][X] += sin * sin * forwardVariance + cos * cos * lateralVariance;
+    covariance[Y][Y] += cos * cos * forwardVariance + sin * sin * lateralVariance;
+    covariance[X][Y] += sin * cos * (forwardVariance - lateralVariance);
+    covariance[Y][X] = covariance[X][Y];
+    covariance[THETA][THETA] += headingVariance;
+}
+
+void fuseGps() {
+    const uint32_t now = pros::millis();
+    if (now - lastGps < settings.gpsInterval) return;
+    lastGps = now;
+    const double error = gps->get_error() * INCHES_PER_METER;
+    const pros::gps_status_s_t status = gps->get_position_and_orientation();
+    if (!std::isfinite(error) || !std::isfinite(status.x) || !std::isfinite(status.y)) return;
+    if (error > settings.gpsMaxError) return;
+    const float variance = square(std::fmax(error, MIN_GPS_ERROR));
+    const float x = status.x * INCHES_PER_METER;
+    const float y = status.y * INCHES_PER_METER;
+
+    // squared mahalanobis distance of the position from the estimate
+    const float ex = x - state[X];
+    const float ey = y - state[Y];
+    const float sxx = covariance[X][X] + variance;
+    const float syy = covariance[Y][Y] + variance;
+    const float sxy = covariance[X][Y];
+    const float distance = (syy * ex * ex - 2 * sxy * ex * ey + sxx * ey * ey) / (sxx * syy - sxy * sxy);
+    if (distance > square(settings.gpsGate) && ++outliers <= settings.gpsMaxOutliers) {
+        gpsRejected++;
+        return;
+    }
+    outliers = 0;
+    gpsFused++;
+    fuse(X, x - state[X], variance);
+    fuse(Y, y - state[Y], variance);
+    if (settings.gpsHeadingNoise > 0 && std::isfinite(status.yaw)) {
+        const float innovation = std::remainder(lemlib::degToRad(status.yaw) - state[THETA], 2 * M_PI);
+        fuse(THETA, innovation, square(lemlib::degToRad(settings.gpsHeadingNoise)));
+    }
+}
+} // namespace
+
+bool startPoseEstimator(pros::Imu* imu, pros::Gps* gps, const PoseEstimatorSettings& settings) {
+#ifdef ODOM_TASK
+    if (running.load()) return false;
+    ::imu = imu;
+    ::gps = gps;
+    ::settings = settings;
+    running.store(true, std::memory_order_release);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool poseEstimatorRunning() { return running.load(std::memory_order_acquire); }
+
+bool getPoseEstimate(PoseEstimate& estimate, bool radians) {
+    if (!running.load(std::memory_order_acquire)) return false;
+    PoseEstimate copy;
+    if (!published.read(copy)) return false;
+    if (!radians) {
+        const float scale = lemlib::radToDeg(1);
+        copy.pose.theta *= scale;
+        for (int i = 0; i < 3; i++) {
+            copy.covariance[THETA][i] *= scale;
+            copy.covariance[i][THETA] *= scale;
+        }
+    }
+    estimate = copy;
+    return true;
+}
+
+lemlib::Pose fusePose(const lemlib::Pose& odometry) {
+    if (!initialized) resetPoseEstimate(odometry);
+    predict(odometry);
+    if (imu != nullptr) {
+        const double heading = imuHeading();
+        // the IMU wasn't ready when the pose was set, so line it up with the estimate now
+        if (std::isfinite(heading) && !std::isfinite(imuOffset)) imuOffset = state[THETA] - heading;
+        if (std::isfinite(heading))
+            fuse(THETA, heading + imuOffset - state[THETA], square(lemlib::degToRad(settings.imuNoise)));
+    }
+    if (gps != nullptr) fuseGps();
+    publish();
+    return {state[X], state[Y], state[THETA]};
+}
+
+void resetPoseEstimate(const lemlib::Pose& pose) {
+    if (!running.load(std::memory_order_acquire)) return;
+    initialized = true;
+    state[X] = pose.x;
+    state[Y] = pose.y;
+    state[THETA] = pose.theta;
+    lastOdometry = pose;
+    covariance = {};
+    covariance[X][X] = covariance[Y][Y] = square(settings.initialPositionError);
+    covariance[THETA][THETA] = square(lemlib::degToRad(settings.initialHeadingError));
+    outliers = 0;
+    if (imu != nullptr) imuOffset = pose.theta - imuHeading();
+}
+
+void widenPoseEstimate(float positionError, float headingError) {
+    if (!running.load(std::memory_order_acquire) || !initialized) return;
+    // grow the standard deviations rather than the variances, since the error is all in the same direction
+    const float errors[3] = {positionError, positionError, headingError};
+    for (int i = 0; i < 3; i++) covariance[i][i] = square(std::sqrt(covariance[i][i]) + std::fabs(errors[i]));
+}
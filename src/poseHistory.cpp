@@ -0,0 +1,139 @@
+#include <atomic>
+#include "lemlib/chassis/odom.hpp"
+#include "lemlib/util.hpp"
+#include "poseHistory.hpp"
+
+namespace {
+struct Slot {
+        // the number of the sample in the slot, or EMPTY while it is being written
+        std::atomic<uint32_t> index = EMPTY;
+        uint32_t time = 0;
+        float pose[3] = {};
+        float velocity[3] = {};
+
+        static constexpr uint32_t EMPTY = UINT32_MAX;
+};
+
+Slot slots[POSE_HISTORY_CAPACITY];
+// how many samples have been recorded. The newest is in slot (written - 1) % POSE_HISTORY_CAPACITY
+std::atomic<uint32_t> written = 0;
+// samples numbered below this were recorded before the pose was last set
+std::atomic<uint32_t> cleared = 0;
+
+/**
+ * @brief Copy a sample out of its slot
+ *
+ * Leaves the time of the sample in microseconds, as it was recorded.
+ *
+ * @return false the sample has been overwritten, or is being
+ */
+bool read(uint32_t index, PoseSample& sample) {
+    const Slot& slot = slots[index % POSE_HISTORY_CAPACITY];
+    if (slot.index.load(std::memory_order_acquire) != index) return false;
+    sample.time = slot.time;
+    sample.pose = {slot.pose[0], slot.pose[1], slot.pose[2]};
+    sample.velocity = {slot.velocity[0], slot.velocity[1], slot.velocity[2]};
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.index.load(std::memory_order_relaxed) == index;
+}
+
+// time is in microseconds, which wrap around after about 71 minutes
+bool before(uint32_t a, uint32_t b) { return int32_t(a - b) < 0; }
+
+// lemlib::Pose::lerp() keeps the heading of the first pose, so interpolate all three here
+lemlib::Pose interpolate(const lemlib::Pose& from, const lemlib::Pose& to, float t) {
+    return {from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t, from.theta + (to.theta - from.theta) * t};
+}
+
+enum class Lookup { FOUND, EMPTY, TOO_OLD, TOO_NEW };
+
+/**
+ * @brief Find the samples either side of a time
+ *
+ * @param time the time, in microseconds
+ * @param older the newest sample at or before the time, or the oldest sample if the time is too old
+ * @param newer the sample after older, or the newest sample if the time is too new
+ */
+Lookup find(uint32_t time, PoseSample& older, PoseSample& newer) {
+    while (true) {
+        const uint32_t end = written.load(std::memory_order_acquire);
+        const uint32_t start = cleared.load(std::memory_order_acquire);
+        // the slot of the oldest sample is the next to be overwritten, so leave it out
+        const uint32_t first = end - start >= POSE_HISTORY_CAPACITY ? end - POSE_HISTORY_CAPACITY + 1 : start;
+        if (first == end) return Lookup::EMPTY;
+        if (!read(end - 1, newer)) continue;
+        if (!before(time, newer.time)) {
+            older = newer;
+            return time == newer.time ? Lookup::FOUND : Lookup::TOO_NEW;
+        }
+        if (!read(first, older)) continue;
+        if (before(time, older.time)) {
+            newer = older;
+            return Lookup::TOO_OLD;
+        }
+        // binary search for the last sample at or before the time. older is at low, newer at high
+        uint32_t low = first;
+        uint32_t high = end - 1;
+        bool overwritten = false;
+        while (high - low > 1) {
+            const uint32_t middle = low + (high - low) / 2;
+            PoseSample sample;
+            if (!read(middle, sample)) {
+                overwritten = true;
+                break;
+            }
+            if (before(time, sample.time)) {
+                high = middle;
+                newer = sample;
+            } else {
+                low = middle;
+                older = sample;
+            }
+        }
+        if (!overwritten) return Lookup::FOUND;
+    }
+}
+} // namespace
+
+void recordPoseSample(uint32_t time, const lemlib::Pose& pose, const lemlib::Pose& velocity) {
+    const uint32_t index = written.load(std::memory_order_relaxed);
+    Slot& slot = slots[index % POSE_HISTORY_CAPACITY];
+    slot.index.store(Slot::EMPTY, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.time = time;
+    slot.pose[0] = pose.x;
+    slot.pose[1] = pose.y;
+    slot.pose[2] = pose.theta;
+    slot.velocity[0] = velocity.x;
+    slot.velocity[1] = velocity.y;
+    slot.velocity[2] = velocity.theta;
+    slot.index.store(index, std::memory_order_release);
+    written.store(index + 1, std::memory_order_release);
+}
+
+void clearPoseHistory() { cleared.store(written.load(std::memory_order_relaxed), std::memory_order_release); }
+
+bool getPoseSampleAt(uint32_t time, PoseSample& sample) {
+    const uint32_t micros = time * 1000;
+    PoseSample older;
+    PoseSample newer;
+    if (find(micros, older, newer) != Lookup::FOUND) return false;
+    const float t = newer.time == older.time ? 0 : float(micros - older.time) / float(newer.time - older.time);
+    sample.time = time;
+    sample.pose = interpolate(older.pose, newer.pose, t);
+    sample.velocity = interpolate(older.velocity, newer.velocity, t);
+    return true;
+}
+
+lemlib::Pose getPoseAt(uint32_t time, bool radians) {
+    PoseSample sample;
+    if (!getPoseSampleAt(time, sample)) {
+        PoseSample older;
+        PoseSample newer;
+        // older and newer are the same sample when the time is outside the history
+        if (find(time * 1000, older, newer) == Lookup::EMPTY) return lemlib::getPose(radians);
+        sample = older;
+    }
+    if (!radians) sample.pose.theta = lemlib::radToDeg(sample.pose.theta);
+    return sample.pose;
+}
@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <cmath>
+#include "latencyCompensation.hpp"
+#include "lemlib/util.hpp"
+#include "motionEstimator.hpp"
+#include "profiledChassis.hpp"
+#include "pros/rtos.hpp"
+
+namespace {
+// in inches per second squared. Wheels can't push the robot harder than about 1g
+constexpr float MAX_ACCELERATION = 386;
+// like LemLib's motions, the robot stops steering at the carrot this close to the point, in inches
+constexpr float CLOSE_DISTANCE = 7.5;
+// segments the curve to a pose is measured in
+constexpr int CURVE_SEGMENTS = 8;
+// LemLib's PIDs output motor power out of 127
+constexpr float VOLTS_PER_POWER = 12.0f / 127;
+
+struct Point {
+        float x;
+        float y;
+};
+
+/**
+ * @brief Set the sides of the drivetrain, keeping their ratio within a voltage
+ */
+void drive(const lemlib::Drivetrain& drivetrain, float left, float right, float limit) {
+    const float ratio = std::max(std::fabs(left), std::fabs(right)) / limit;
+    if (ratio > 1) {
+        left /= ratio;
+        right /= ratio;
+    }
+    drivetrain.leftMotors->move_voltage(left * 1000);
+    drivetrain.rightMotors->move_voltage(right * 1000);
+}
+
+/**
+ * @brief How far to turn from one heading to another, in degrees
+ */
+float turnDistance(float from, float to, lemlib::AngularDirection direction) {
+    const float shortest = std::remainder(to - from, 360);
+    switch (direction) {
+        case lemlib::AngularDirection::CW_CLOCKWISE: return shortest < 0 ? shortest + 360 : shortest;
+        case lemlib::AngularDirection::CCW_COUNTERCLOCKWISE: return shortest > 0 ? shortest - 360 : shortest;
+        default: return shortest;
+    }
+}
+
+/**
+ * @brief Length of the quadratic curve from start to end, pulled towards control. Roughly the path moveToPose() takes
+ * while it steers at the carrot
+ */
+float curveLength(Point start, Point control, Point end) {
+    float length = 0;
+    Point last = start;
+    for (int i = 1; i <= CURVE_SEGMENTS; i++) {
+        const float t = float(i) / CURVE_SEGMENTS;
+        const float u = 1 - t;
+        const Point point = {u * u * start.x + 2 * u * t * control.x + t * t * end.x,
+                             u * u * start.y + 2 * u * t * control.y + t * t * end.y};
+        length += std::hypot(point.x - last.x, point.y - last.y);
+        last = point;
+    }
+    return length;
+}
+} // namespace
+
+void ProfiledChassis::setProfile(const DriveCharacterization& model, const ProfileSettings& settings) {
+    this->model = model;
+    this->settings = settings;
+    lateralCorrection.reset();
+    angularCorrection.reset();
+    const CorrectionGains& lateral = settings.lateral;
+    const CorrectionGains& angular = settings.angular;
+    if (lateral.kP > 0)
+        lateralCorrection.emplace(lateral.kP, lateral.kI, lateral.kD, lateralSettings.windupRange, true);
+    if (angular.kP > 0)
+        angularCorrection.emplace(angular.kP, angular.kI, angular.kD, angularSettings.windupRange, true);
+}
+
+ProfileConstraints ProfiledChassis::profileConstraints(bool angular) const {
+    const Feedforward& gains = angular ? model.angular : model.linear;
+    // what the wheels can push, as a turn about the middle of the drivetrain in degrees
+    const float limit =
+        angular ? lemlib::radToDeg(2 * MAX_ACCELERATION / std::fmax(drivetrain.trackWidth, 1)) : MAX_ACCELERATION;
+    ProfileConstraints constraints;
+    constraints.maxVelocity = gains.maxVelocity(settings.maxVoltage);
+    float acceleration = angular ? 0 : settings.maxAcceleration;
+    // at half the top speed, half of what's left after friction goes to accelerating
+    if (acceleration <= 0) acceleration = gains.kA > 0 ? (settings.maxVoltage - gains.kS) / (2 * gains.kA) : limit;
+    constraints.maxAcceleration = std::clamp(acceleration, 0.0f, limit);
+    constraints.maxJerk = settings.rampTime > 0 ? constraints.maxAcceleration / (settings.rampTime * 1e-3f) : 0;
+    return constraints;
+}
+
+void ProfiledChassis::moveToPointProfiled(float x, float y, int timeout, lemlib::MoveToPointParams params,
+                                          bool async) {
+    if (model.linear.kV <= 0) {
+        moveToPoint(x, y, timeout, params, async);
+        return;
+    }
+    requestMotionStart();
+    // were all motions cancelled?
+    if (!motionRunning) return;
+    if (async) {
+        pros::Task task([=, this]() { moveToPointProfiled(x, y, timeout, params, false); });
+        endMotion();
+        pros::delay(10); // give the task time to start
+        return;
+    }
+    followProfile(x, y, std::nullopt, timeout,
+                  {.forwards = params.forwards,
+                   .lead = 0,
+                   .maxSpeed = params.maxSpeed,
+                   .minSpeed = params.minSpeed,
+                   .earlyExitRange = params.earlyExitRange});
+}
+
+void ProfiledChassis::moveToPoseProfiled(float x, float y, float theta, int timeout, lemlib::MoveToPoseParams params,
+                                         bool async) {
+    if (model.linear.kV <= 0) {
+        moveToPose(x, y, theta, timeout, params, async);
+        return;
+    }
+    requestMotionStart();
+    // were all motions cancelled?
+    if (!motionRunning) return;
+    if (async) {
+        pros::Task task([=, this]() { moveToPoseProfiled(x, y, theta, timeout, params, false); });
+        endMotion();
+        pros::delay(10); // give the task time to start
+        return;
+    }
+    followProfile(x, y, theta, timeout, params);
+}
+
+void ProfiledChassis::turnToHeadingProfiled(float theta, int timeout, lemlib::TurnToHeadingParams params, bool async) {
+    if (model.angular.kV <= 0) {
+        turnToHeading(theta, timeout, params, async);
+        return;
+    }
+    requestMotionStart();
+    // were all motions cancelled?
+    if (!motionRunning) return;
+    if (async) {
+        pros::Task task([=, this]() { turnToHeadingProfiled(theta, timeout, params, false); });
+        endMotion();
+        pros::delay(10); // give the task time to start
+        return;
+    }
+    followTurn(theta, timeout, params);
+}
+
+void ProfiledChassis::followProfile(float x, float y, std::optional<float> theta, int timeout,
+                                    const lemlib::MoveToPoseParams& params) {
+    lemlib::PID& correction = lateralCorrection ? *lateralCorrection : lateralPID;
+    lemlib::PID& steering = angularCorrection ? *angularCorrection : angularPID;
+    correction.reset();
+    steering.reset();
+    lateralSmallExit.reset();
+    lateralLargeExit.reset();
+    angularSmallExit.reset();
+    angularLargeExit.reset();
+
+    const Point target = {x, y};
+    const float direction = params.forwards ? 1 : -1;
+    const float heading = theta ? lemlib::degToRad(*theta) : 0;
+    // the way the robot arrives at the pose, which is behind it when driving backwards
+    const float approach = heading + (params.forwards ? 0 : M_PI);
+    auto carrot = [&](const lemlib::Pose& pose) -> Point {
+        const float lead = params.lead * std::hypot(x - pose.x, y - pose.y);
+        return {x - lead * std::sin(approach), y - lead * std::cos(approach)};
+    };
+
+    // plan the profile along the path from where the robot is, and how fast it's already going
+    const lemlib::Pose start = getPose(true);
+    const float length = curveLength({start.x, start.y}, carrot(start), target);
+    const float speed = std::clamp(params.maxSpeed, 0.0f, 127.0f) / 127;
+    ProfileConstraints constraints = profileConstraints();
+    constraints.maxVelocity = model.linear.maxVelocity(std::min(settings.maxVoltage, 12 * speed));
+    const float startVelocity = getVelocity(true).y * direction;
+    const float endVelocity = model.linear.maxVelocity(12 * std::clamp(params.minSpeed, 0.0f, 127.0f) / 127);
+    const MotionProfile profile(length, constraints, startVelocity, endVelocity);
+    const bool chaining = params.minSpeed > 0;
+
+    lemlib::Pose last = start;
+    distTraveled = 0;
+    float profileTime = 0;
+    bool close = false;
+    const uint32_t begin = pros::millis();
+    uint32_t previous = begin;
+    while (motionRunning && pros::millis() - begin < uint32_t(timeout)) {
+        // steer by where the robot will be once the voltage takes effect
+        const lemlib::Pose pose = getCompensatedPose(true);
+        const uint32_t now = pros::millis();
+        const float elapsed = (now - previous) * 1e-3f;
+        previous = now;
+        distTraveled += std::hypot(pose.x - last.x, pose.y - last.y);
+        last = pose;
+
+        const float distance = std::hypot(x - pose.x, y - pose.y);
+        if (distance < CLOSE_DISTANCE) close = true;
+        // the way the robot drives
+        const float travel = pose.theta + (params.forwards ? 0 : M_PI);
+        const Point aim = close ? target : carrot(pose);
+        const float steer = std::remainder(std::atan2(aim.x - pose.x, aim.y - pose.y) - travel, 2 * M_PI);
+        // how far ahead of the robot the point is, negative once it has passed it
+        const float ahead = distance * std::cos(std::remainder(std::atan2(x - pose.x, y - pose.y) - travel, 2 * M_PI));
+        const float headingError = lemlib::radToDeg(std::remainder(heading - pose.theta, 2 * M_PI));
+
+        if (chaining) {
+            if (close && ahead <= params.earlyExitRange) break;
+        } else if (close) {
+            lateralSmallExit.update(ahead);
+            lateralLargeExit.update(ahead);
+            angularSmallExit.update(headingError);
+            angularLargeExit.update(headingError);
+            const bool lateralDone = lateralSmallExit.getExit() || lateralLargeExit.getExit();
+            const bool angularDone = !theta || angularSmallExit.getExit() || angularLargeExit.getExit();
+            if (lateralDone && angularDone) break;
+        }
+
+        // how far along the path the robot is. The profile holds back while the robot can't keep up with it
+        const float progress = length - (close ? ahead : curveLength({pose.x, pose.y}, aim, target));
+        if (profile.sample(profileTime).position - progress < settings.maxLag) profileTime += elapsed;
+        const ProfileState state = profile.sample(profileTime);
+
+        // feedforward drives the profile, and the PIDs correct what it misses. Don't drive off while facing away from
+        // the carrot
+        const float facing = close ? 1 : std::max(std::cos(steer), 0.0f);
+        const float linear = (model.linear.voltage(state.velocity, state.acceleration) +
+                              correction.update(state.position - progress) * VOLTS_PER_POWER) *
+                             facing;
+        float angular = 0;
+        if (!close) {
+            // turn along the arc to the carrot. The linear feedforward already overcomes friction, so no kS
+            const float curvature = 2 * std::sin(steer) / std::fmax(std::hypot(aim.x - pose.x, aim.y - pose.y), 1);
+            const float turnRate = lemlib::radToDeg(state.velocity * facing * curvature);
+            angular = model.angular.kV * turnRate + steering.update(lemlib::radToDeg(steer)) * VOLTS_PER_POWER;
+        } else if (theta) {
+            angular = steering.update(headingError) * VOLTS_PER_POWER;
+        }
+
+        drive(drivetrain, direction * linear + angular, direction * linear - angular, 12 * speed);
+        pros::delay(10);
+    }
+
+    // stop the drivetrain
+    drivetrain.leftMotors->move(0);
+    drivetrain.rightMotors->move(0);
+    // set distTraveled to -1 to indicate that the function has finished
+    distTraveled = -1;
+    endMotion();
+}
+
+void ProfiledChassis::followTurn(float theta, int timeout, const lemlib::TurnToHeadingParams& params) {
+    lemlib::PID& correction = angularCorrection ? *angularCorrection : angularPID;
+    correction.reset();
+    angularSmallExit.reset();
+    angularLargeExit.reset();
+
+    const float start = getPose().theta;
+    const float distance = turnDistance(start, theta, params.direction);
+    const float direction = distance < 0 ? -1 : 1;
+    const float speed = std::clamp(float(params.maxSpeed), 0.0f, 127.0f) / 127;
+    ProfileConstraints constraints = profileConstraints(true);
+    constraints.maxVelocity = model.angular.maxVelocity(std::min(settings.maxVoltage, 12 * speed));
+    const float startVelocity = getVelocity(false).theta * direction;
+    const float endVelocity = model.angular.maxVelocity(12 * std::clamp(float(params.minSpeed), 0.0f, 127.0f) / 127);
+    const MotionProfile profile(distance, constraints, startVelocity, endVelocity);
+    const bool chaining = params.minSpeed > 0;
+
+    // how far the robot has turned, which keeps counting past a full turn
+    float progress = 0;
+    float last = start;
+    distTraveled = 0;
+    float profileTime = 0;
+    const uint32_t begin = pros::millis();
+    uint32_t previous = begin;
+    while (motionRunning && pros::millis() - begin < uint32_t(timeout)) {
+        const float heading = getCompensatedPose().theta;
+        const uint32_t now = pros::millis();
+        const float elapsed = (now - previous) * 1e-3f;
+        previous = now;
+        progress += std::remainder(heading - last, 360);
+        last = heading;
+        distTraveled = std::fabs(progress);
+
+        // how far is left to turn in the direction of the turn, negative once the robot has passed the heading
+        const float left = (distance - progress) * direction;
+        if (chaining) {
+            if (left <= params.earlyExitRange) break;
+        } else if (profileTime >= profile.duration()) {
+            angularSmallExit.update(left);
+            angularLargeExit.update(left);
+            if (angularSmallExit.getExit() || angularLargeExit.getExit()) break;
+        }
+
+        if ((profile.sample(profileTime).position - progress) * direction < settings.maxAngularLag)
+            profileTime += elapsed;
+        const ProfileState state = profile.sample(profileTime);
+        const float angular = model.angular.voltage(state.velocity, state.acceleration) +
+                              correction.update(state.position - progress) * VOLTS_PER_POWER;
+        drive(drivetrain, angular, -angular, 12 * speed);
+        pros::delay(10);
+    }
+
+    // stop the drivetrain
+    drivetrain.leftMotors->move(0);
+    drivetrain.rightMotors->move(0);
+    // set distTraveled to -1 to indicate that the function has finished
+    distTraveled = -1;
+    endMotion();
+}
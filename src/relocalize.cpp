@@ -0,0 +1,88 @@
+#include <cmath>
+#include "poseHistory.hpp"
+#include "pros/rtos.hpp"
+#include "relocalize.hpp"
+
+namespace {
+constexpr float MM_PER_INCH = 25.4;
+// the sensor only reports a confidence beyond this, in millimeters
+constexpr int32_t CONFIDENCE_RANGE = 200;
+// what the sensor reads when it sees nothing, in millimeters
+constexpr int32_t NO_OBJECT = 9999;
+
+/**
+ * @brief Where each sensor that faces a wall puts the robot along one axis
+ */
+struct Axis {
+        float sum = 0;
+        float min = INFINITY;
+        float max = -INFINITY;
+        int count = 0;
+
+        void add(float position) {
+            sum += position;
+            min = std::fmin(min, position);
+            max = std::fmax(max, position);
+            count++;
+        }
+};
+} // namespace
+
+RelocalizeResult relocalize(lemlib::Chassis& chassis, const std::vector<WallSensor>& sensors,
+                            const FieldWalls& walls, const RelocalizeSettings& settings) {
+    RelocalizeResult result;
+    // the readings were taken a little while ago, so compare them with where the robot was then
+    const lemlib::Pose then = getPoseAt(pros::millis() - settings.latency, true);
+    Axis x;
+    Axis y;
+    for (const WallSensor& wall : sensors) {
+        const float heading = then.theta + lemlib::degToRad(wall.heading);
+        // which of the four walls the sensor faces, 0 being the top one and going clockwise
+        const int side = (int(std::lround(heading / (M_PI / 2))) % 4 + 4) % 4;
+        const float angleError = std::remainder(heading, M_PI / 2);
+        if (std::fabs(angleError) > lemlib::degToRad(settings.maxAngleError)) continue;
+
+        const int32_t millimeters = wall.sensor->get_distance();
+        const int32_t confidence = wall.sensor->get_confidence();
+        const float distance = millimeters * std::cos(angleError) / MM_PER_INCH;
+        const bool confident = millimeters <= CONFIDENCE_RANGE || confidence >= settings.minConfidence;
+        if (millimeters == PROS_ERR || millimeters >= NO_OBJECT || confidence == PROS_ERR || !confident ||
+            distance < settings.minDistance || distance > settings.maxDistance) {
+            result.rejected++;
+            continue;
+        }
+
+        // where the sensor is on the field, and where the wall says the robot is
+        const float sensorX = then.x + wall.x * std::cos(then.theta) + wall.y * std::sin(then.theta);
+        const float sensorY = then.y - wall.x * std::sin(then.theta) + wall.y * std::cos(then.theta);
+        float correction;
+        switch (side) {
+            case 0: correction = walls.top - distance - sensorY; break;
+            case 1: correction = walls.right - distance - sensorX; break;
+            case 2: correction = walls.bottom + distance - sensorY; break;
+            default: correction = walls.left + distance - sensorX; break;
+        }
+        if (std::fabs(correction) > settings.maxCorrection) {
+            result.rejected++;
+            continue;
+        }
+        (side % 2 == 0 ? y : x).add(correction);
+    }
+
+    for (Axis* axis : {&x, &y}) {
+        if (axis->count > 1 && axis->max - axis->min > settings.maxDisagreement) {
+            result.rejected += axis->count;
+            axis->count = 0;
+        }
+        result.accepted += axis->count;
+    }
+    if (x.count == 0 && y.count == 0) return result;
+
+    result.correctedX = x.count > 0;
+    result.correctedY = y.count > 0;
+    result.dx = result.correctedX ? x.sum / x.count : 0;
+    result.dy = result.correctedY ? y.sum / y.count : 0;
+    const lemlib::Pose now = chassis.getPose();
+    chassis.setPose(now.x + result.dx, now.y + result.dy, now.theta);
+    return result;
+}
@@ -0,0 +1,241 @@
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "lemlib/chassis/odom.hpp"
+#include "odomTask.hpp"
+#include "pros/rtos.hpp"
+#include "sensorLog.hpp"
+
+namespace {
+constexpr int MAX_WHEELS = 4;
+// records waiting for the writer. 256 updates is 2.5 seconds of odometry
+constexpr uint32_t BUFFERED_RECORDS = 256;
+// how often the writer empties the buffer, in milliseconds
+constexpr uint32_t WRITE_INTERVAL = 50;
+
+struct Record {
+        uint32_t sequence;
+        uint32_t time;
+        float wheels[MAX_WHEELS];
+        double imu;
+        float leftMotors;
+        float rightMotors;
+        float x;
+        float y;
+        float theta;
+};
+
+// set by startSensorLog before logging starts
+#ifdef SENSOR_LOG
+FILE* file = nullptr;
+#endif
+lemlib::OdomSensors odomSensors(nullptr, nullptr, nullptr, nullptr, nullptr);
+pros::MotorGroup* leftMotors = nullptr;
+pros::MotorGroup* rightMotors = nullptr;
+std::atomic<bool> logging = false;
+// whether the writer task is still running
+std::atomic<bool> writing = false;
+// the task LemLib runs odometry in, found by the first wheel reading after the log starts
+std::atomic<pros::task_t> odometryTask = nullptr;
+
+// only touched by the odometry task, until the first record is handed to the writer
+// the log can start halfway through an update, so recording starts with the update after that one
+bool started = false;
+lemlib::TrackingWheel* wheels[MAX_WHEELS];
+SensorLogWheel layout[MAX_WHEELS];
+int wheelCount = 0;
+bool layoutDone = false;
+Record pending;
+uint32_t sequence = 0;
+
+// records handed from the odometry task to the writer
+Record buffer[BUFFERED_RECORDS];
+std::atomic<uint32_t> head = 0;
+std::atomic<uint32_t> tail = 0;
+std::atomic<uint32_t> written = 0;
+std::atomic<uint32_t> dropped = 0;
+
+bool isOdometryTask() { return logging.load() && pros::c::task_get_current() == odometryTask.load(); }
+
+/**
+ * @brief Work out where in lemlib::OdomSensors each wheel the odometry task read is
+ *
+ * LemLib replaces missing vertical wheels with wheels made from the drivetrain, so a wheel that isn't one of the
+ * sensors the chassis was created with fills the first missing vertical slot.
+ */
+void describeWheels() {
+    bool taken[MAX_WHEELS] = {};
+    lemlib::TrackingWheel* const slots[MAX_WHEELS] = {odomSensors.vertical1, odomSensors.vertical2,
+                                                      odomSensors.horizontal1, odomSensors.horizontal2};
+    for (int i = 0; i < wheelCount; i++) {
+        int slot = -1;
+        for (int j = 0; j < MAX_WHEELS && slot < 0; j++) {
+            if (slots[j] == wheels[i]) slot = j;
+        }
+        for (int j = SensorLogWheel::VERTICAL1; j <= SensorLogWheel::VERTICAL2 && slot < 0; j++) {
+            if (slots[j] == nullptr && !taken[j]) slot = j;
+        }
+        if (slot >= 0) taken[slot] = true;
+        layout[i] = {uint8_t(slot), uint8_t(wheels[i]->getType()), 0, wheels[i]->getOffset()};
+    }
+    layoutDone = true;
+}
+
+#ifdef SENSOR_LOG
+void writeHeader() {
+    const SensorLogHeader header = {{SENSOR_LOG_MAGIC[0], SENSOR_LOG_MAGIC[1], SENSOR_LOG_MAGIC[2],
+                                     SENSOR_LOG_MAGIC[3]},
+                                    SENSOR_LOG_VERSION, uint8_t(wheelCount), odomSensors.imu != nullptr, 0};
+    std::fwrite(&header, sizeof(header), 1, file);
+    std::fwrite(layout, sizeof(SensorLogWheel), wheelCount, file);
+}
+
+void writeRecord(const Record& record) {
+    // the same fields as Record, without the unused wheels or the padding
+    uint8_t bytes[sizeof(Record)];
+    size_t size = 0;
+    auto put = [&](const void* value, size_t length) {
+        std::memcpy(bytes + size, value, length);
+        size += length;
+    };
+    put(&record.sequence, sizeof(record.sequence));
+    put(&record.time, sizeof(record.time));
+    put(record.wheels, sizeof(float) * wheelCount);
+    if (odomSensors.imu != nullptr) put(&record.imu, sizeof(record.imu));
+    put(&record.leftMotors, sizeof(record.leftMotors));
+    put(&record.rightMotors, sizeof(record.rightMotors));
+    put(&record.x, sizeof(record.x));
+    put(&record.y, sizeof(record.y));
+    put(&record.theta, sizeof(record.theta));
+    std::fwrite(bytes, size, 1, file);
+}
+
+void writeLog() {
+    bool headerWritten = false;
+    while (true) {
+        // check before emptying the buffer, so everything recorded before the log stopped gets written
+        const bool stopping = !logging.load();
+        for (uint32_t next = tail.load(); next != head.load(std::memory_order_acquire); next++) {
+            if (!headerWritten) writeHeader();
+            headerWritten = true;
+            writeRecord(buffer[next % BUFFERED_RECORDS]);
+            tail.store(next + 1, std::memory_order_release);
+            written++;
+        }
+        std::fflush(file);
+        if (stopping) break;
+        pros::delay(WRITE_INTERVAL);
+    }
+    std::fclose(file);
+    file = nullptr;
+    writing = false;
+}
+#endif
+
+/**
+ * @brief The average position of the motors of a group, read motor by motor since get_position_all() allocates
+ */
+float averagePosition(const pros::MotorGroup* motors) {
+    if (motors == nullptr) return 0;
+    double total = 0;
+    int count = 0;
+    for (int i = 0; i < motors->size(); i++) {
+        const double position = motors->get_position(i);
+        if (!std::isfinite(position)) continue;
+        total += position;
+        count++;
+    }
+    return count > 0 ? total / count : 0;
+}
+} // namespace
+
+double LoggedImu::get_rotation() const {
+    const double rotation = GyroBiasImu::get_rotation();
+    // started is only the odometry task's to touch
+    if (isOdometryTask() && started) pending.imu = rotation;
+    return rotation;
+}
+
+bool startSensorLog(const char* path, const lemlib::OdomSensors& sensors, const lemlib::Drivetrain& drivetrain) {
+#ifdef SENSOR_LOG
+    if (logging.load() || writing.load()) return false;
+    // readings of any other IMU can't be recorded
+    if (sensors.imu != nullptr && dynamic_cast<LoggedImu*>(sensors.imu) == nullptr) return false;
+    file = std::fopen(path, "wb");
+    if (file == nullptr) return false;
+    odomSensors = sensors;
+    leftMotors = drivetrain.leftMotors;
+    rightMotors = drivetrain.rightMotors;
+    odometryTask = nullptr;
+    started = false;
+    wheelCount = 0;
+    layoutDone = false;
+    pending = {};
+    sequence = 0;
+    head = 0;
+    tail = 0;
+    written = 0;
+    dropped = 0;
+    writing = true;
+    logging = true;
+    pros::Task writer([] { writeLog(); }, TASK_PRIORITY_DEFAULT - 2, TASK_STACK_DEPTH_DEFAULT, "sensor log");
+    return true;
+#else
+    (void)path;
+    (void)sensors;
+    (void)drivetrain;
+    return false;
+#endif
+}
+
+void stopSensorLog() {
+    logging = false;
+    while (writing.load()) pros::delay(10);
+}
+
+uint32_t sensorLogRecords() { return written.load(); }
+
+uint32_t sensorLogDropped() { return dropped.load(); }
+
+void logWheelReading(lemlib::TrackingWheel* wheel, float distance) {
+    if (!logging.load()) return;
+    pros::task_t task = nullptr;
+    // the task of include/odomTask.hpp when it runs, and not another task that reads the wheels
+    if (!odometryTaskRunning() || inOdometryTask())
+        odometryTask.compare_exchange_strong(task, pros::c::task_get_current());
+    if (!isOdometryTask() || !started) return;
+    for (int i = 0; i < wheelCount; i++) {
+        if (wheels[i] != wheel) continue;
+        pending.wheels[i] = distance;
+        return;
+    }
+    // the wheels are found during the first update, and can't change once the header describes them
+    if (layoutDone || wheelCount == MAX_WHEELS) return;
+    wheels[wheelCount] = wheel;
+    pending.wheels[wheelCount++] = distance;
+}
+
+void finishSensorLogRecord() {
+    if (!isOdometryTask()) return;
+    if (!started) {
+        started = true;
+        return;
+    }
+    if (!layoutDone) describeWheels();
+    const lemlib::Pose pose = lemlib::getPose(true);
+    pending.sequence = sequence++;
+    pending.time = uint32_t(pros::c::micros());
+    pending.leftMotors = averagePosition(leftMotors);
+    pending.rightMotors = averagePosition(rightMotors);
+    pending.x = pose.x;
+    pending.y = pose.y;
+    pending.theta = pose.theta;
+    const uint32_t next = head.load(std::memory_order_relaxed);
+    if (next - tail.load(std::memory_order_acquire) >= BUFFERED_RECORDS) {
+        dropped++;
+        return;
+    }
+    buffer[next % BUFFERED_RECORDS] = pending;
+    head.store(next + 1, std::memory_order_release);
+}
@@ -0,0 +1,72 @@
+#include "pros/rtos.hpp"
+#include "sensorSnapshot.hpp"
+#include "seqlock.hpp"
+
+namespace {
+// the last snapshot, written by the odometry task and read by any task without a lock
+Seqlock<OdometrySnapshot> published;
+
+float cartridgeRpm(pros::MotorGears gearing) {
+    switch (gearing) {
+        case pros::MotorGears::red: return 100;
+        case pros::MotorGears::blue: return 600;
+        default: return 200;
+    }
+}
+} // namespace
+
+SnapshotReader::SnapshotReader(const lemlib::OdomSensors& sensors, const lemlib::Drivetrain& drivetrain)
+    : imu(sensors.imu) {
+    lemlib::TrackingWheel* const given[4] = {sensors.vertical1, sensors.vertical2, sensors.horizontal1,
+                                             sensors.horizontal2};
+    for (int slot = 0; slot < 4; slot++) {
+        if (given[slot] == nullptr) continue;
+        wheels[slot].wheel = given[slot];
+        wheels[slot].offset = given[slot]->getOffset();
+        wheels[slot].powered = given[slot]->getType();
+    }
+    // the same wheels Chassis::calibrate() makes when the vertical ones are missing
+    pros::MotorGroup* const sides[2] = {drivetrain.leftMotors, drivetrain.rightMotors};
+    for (int slot = 0; slot < 2; slot++) {
+        if (given[slot] != nullptr || sides[slot] == nullptr) continue;
+        Wheel& wheel = wheels[slot];
+        wheel.motors = sides[slot];
+        wheel.offset = slot == 0 ? -drivetrain.trackWidth / 2 : drivetrain.trackWidth / 2;
+        wheel.powered = true;
+        wheel.motors->set_encoder_units_all(pros::MotorUnits::rotations);
+        for (int i = 0; i < wheel.motors->size(); i++) {
+            wheel.inchesPerRotation.push_back(drivetrain.wheelDiameter * M_PI * drivetrain.rpm /
+                                              cartridgeRpm(wheel.motors->get_gearing(i)));
+        }
+    }
+}
+
+float SnapshotReader::distance(Wheel& wheel) {
+    if (wheel.wheel != nullptr) return wheel.wheel->getDistanceTraveled();
+    if (wheel.motors == nullptr) return 0;
+    // the average of every motor that reads, like LemLib
+    float total = 0;
+    int count = 0;
+    for (size_t i = 0; i < wheel.inchesPerRotation.size(); i++) {
+        const double rotations = wheel.motors->get_position(i);
+        if (!std::isfinite(rotations)) continue;
+        total += rotations * wheel.inchesPerRotation[i];
+        count++;
+    }
+    return count > 0 ? total / count : 0;
+}
+
+void SnapshotReader::read(OdometrySnapshot& snapshot) {
+    snapshot.time = pros::micros();
+    for (int slot = 0; slot < 4; slot++) snapshot.wheels[slot] = distance(wheels[slot]);
+    snapshot.imu = readImu(snapshot.time);
+}
+
+double SnapshotReader::readImu(uint32_t timeMicros) {
+    if (gyroBias != nullptr) return gyroBias->update(timeMicros);
+    return imu != nullptr ? imu->get_rotation() : NAN;
+}
+
+void publishOdometrySnapshot(const OdometrySnapshot& snapshot) { published.write(snapshot); }
+
+bool getOdometrySnapshot(OdometrySnapshot& snapshot) { return published.read(snapshot); }
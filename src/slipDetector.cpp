@@ -0,0 +1,193 @@
+#include <atomic>
+#include <cmath>
+#include "lemlib/util.hpp"
+#include "poseEstimator.hpp"
+#include "pros/rtos.hpp"
+#include "seqlock.hpp"
+#include "slipDetector.hpp"
+
+namespace {
+// set once by startSlipDetector, before running is
+SlipDetectorSettings settings;
+// the chassis sensors, and the drive motors on their own as slots 0 and 1
+SnapshotReader* wheels = nullptr;
+SnapshotReader* drive = nullptr;
+pros::Imu* imu = nullptr;
+float trackWidth = 0;
+// the slots of the tracking wheels, or -1 when there isn't one
+int vertical = -1;
+int horizontal = -1;
+std::atomic<bool> running = false;
+
+// the detector. Only the odometry task touches these
+bool started = false;
+OdometrySnapshot lastWheels;
+OdometrySnapshot lastDrive;
+double lastRotation = NAN;
+// averaged speeds, in inches and radians per second
+float driveSpeed = 0;
+float trackingSpeed = 0;
+float lateralSpeed = 0;
+float driveTurnRate = 0;
+float imuTurnRate = 0;
+// averaged acceleration of the tracking wheel, in inches per second squared
+float trackingAcceleration = 0;
+// whether the drive wheels slipped along the robot last update, so a slip stays one until it ends
+bool forwardSlipping = false;
+// when each was last seen, and when any of them was, in milliseconds
+uint32_t lastSlip = 0;
+uint32_t lastPush = 0;
+uint32_t lastCollision = 0;
+uint32_t lastDisturbed = 0;
+bool disturbedOnce = false;
+MotionStatus status;
+
+// the last status, written by the odometry task and read by any task without a lock
+Seqlock<MotionStatus> published;
+
+void publish() { published.write(status); }
+
+/**
+ * @brief Count an event when it starts. It only ends once it hasn't been seen for a window, so it isn't counted
+ * again each time the speeds wobble around a threshold
+ */
+void track(bool seen, bool& active, uint32_t& lastSeen, uint32_t& count, MotionEventType type, float magnitude,
+           uint32_t time) {
+    if (seen) {
+        if (!active) {
+            count++;
+            status.last = {type, time, magnitude};
+        }
+        active = true;
+        lastSeen = time;
+    } else if (time - lastSeen > settings.window) {
+        active = false;
+    }
+}
+
+void average(float& average, float value, float weight) { average += (value - average) * weight; }
+} // namespace
+
+bool startSlipDetector(const lemlib::OdomSensors& sensors, const lemlib::Drivetrain& drivetrain,
+                       const SlipDetectorSettings& settings) {
+#ifdef ODOM_TASK
+    if (running.load()) return false;
+    ::settings = settings;
+    wheels = new SnapshotReader(sensors, drivetrain);
+    drive = new SnapshotReader(lemlib::OdomSensors(nullptr, nullptr, nullptr, nullptr, nullptr), drivetrain);
+    imu = sensors.imu;
+    trackWidth = drivetrain.trackWidth;
+    // only a wheel that isn't driven tells how far the robot really moved
+    vertical = wheels->hasWheel(0) && !wheels->powered(0) ? 0 : wheels->hasWheel(1) && !wheels->powered(1) ? 1 : -1;
+    horizontal = wheels->hasWheel(2) ? 2 : wheels->hasWheel(3) ? 3 : -1;
+    running.store(true, std::memory_order_release);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool slipDetectorRunning() { return running.load(std::memory_order_acquire); }
+
+bool getMotionStatus(MotionStatus& status) {
+    if (!running.load(std::memory_order_acquire)) return false;
+    return published.read(status);
+}
+
+bool poseTrusted() {
+    MotionStatus status;
+    return !getMotionStatus(status) || status.trusted;
+}
+
+void detectSlip(const OdometrySnapshot* snapshot) {
+    // the readers are made by startSlipDetector(), so they are never there without ODOM_TASK
+    if (!running.load(std::memory_order_acquire) || wheels == nullptr || drive == nullptr) return;
+    OdometrySnapshot read;
+    if (snapshot == nullptr) {
+        wheels->read(read);
+        snapshot = &read;
+    }
+    OdometrySnapshot driven;
+    drive->read(driven);
+    // the snapshot IMU may be corrected for drift, so read the sensor itself
+    const double rotation = imu != nullptr ? imu->pros::Imu::get_rotation() : NAN;
+    const pros::imu_accel_s_t accel = imu != nullptr ? imu->get_accel() : pros::imu_accel_s_t {NAN, NAN, NAN};
+    const OdometrySnapshot previous = lastWheels;
+    const OdometrySnapshot previousDrive = lastDrive;
+    const double previousRotation = lastRotation;
+    lastWheels = *snapshot;
+    lastDrive = driven;
+    lastRotation = rotation;
+    const float dt = (snapshot->time - previous.time) * 1e-6f;
+    if (!started || dt <= 0) {
+        started = true;
+        return;
+    }
+
+    // how far the drive wheels say the robot moved forwards and turned, clockwise
+    const float left = driven.wheels[0] - previousDrive.wheels[0];
+    const float right = driven.wheels[1] - previousDrive.wheels[1];
+    const float driveTurned = trackWidth > 0 ? (left - right) / trackWidth : 0;
+    const float imuTurned = lemlib::degToRad(rotation - previousRotation);
+    const bool hasImu = std::isfinite(imuTurned);
+    // the IMU knows best how far the robot turned, which the tracking wheels are corrected for
+    const float turned = hasImu ? imuTurned : driveTurned;
+
+    const float weight = dt / (settings.window * 1e-3f + dt);
+    average(driveSpeed, (left + right) / 2 / dt, weight);
+    average(driveTurnRate, driveTurned / dt, weight);
+    if (hasImu) average(imuTurnRate, imuTurned / dt, weight);
+    const float lastTrackingSpeed = trackingSpeed;
+    if (vertical >= 0) {
+        const float moved = snapshot->wheels[vertical] - previous.wheels[vertical] + turned * wheels->offset(vertical);
+        average(trackingSpeed, moved / dt, weight);
+        average(trackingAcceleration, (trackingSpeed - lastTrackingSpeed) / dt, weight);
+    }
+    if (horizontal >= 0) {
+        const float moved =
+            snapshot->wheels[horizontal] - previous.wheels[horizontal] + turned * wheels->offset(horizontal);
+        average(lateralSpeed, moved / dt, weight);
+    }
+
+    // how much faster the drive wheels go than the robot. Faster in the direction they drive is wheel spin, and slower
+    // while the robot slows down is a skid. Anything else is the robot being moved
+    const float excess = vertical >= 0 ? driveSpeed - trackingSpeed : 0;
+    const bool slowing = trackingAcceleration * trackingSpeed < 0;
+    const float turnExcess = hasImu ? lemlib::radToDeg(driveTurnRate - imuTurnRate) : 0;
+    const float scrub = settings.turnRate + settings.scrubRatio * lemlib::radToDeg(std::fabs(imuTurnRate));
+    const bool forwardSlip =
+        (forwardSlipping || excess * driveSpeed > 0 || slowing) && std::fabs(excess) > settings.slipSpeed;
+    forwardSlipping = forwardSlip;
+    const bool turnSlip = turnExcess * driveTurnRate > 0 && std::fabs(turnExcess) > scrub;
+    const float acceleration = std::hypot(accel.x, accel.y);
+
+    const bool slipping = forwardSlip || turnSlip;
+    const bool pushed = (excess * driveSpeed <= 0 && !slowing && std::fabs(excess) > settings.pushSpeed) ||
+                        std::fabs(lateralSpeed) > settings.lateralSpeed ||
+                        (!turnSlip && std::fabs(turnExcess) > settings.turnRate);
+    const bool colliding = std::isfinite(acceleration) && acceleration > settings.collisionAcceleration;
+
+    // the snapshot time is in microseconds, and wraps after about 71 minutes
+    const uint32_t now = pros::millis();
+    const bool collided = colliding && !status.colliding;
+    track(slipping, status.slipping, lastSlip, status.slips, MotionEventType::SLIP,
+          forwardSlip ? std::fabs(excess) : std::fabs(turnExcess), now);
+    track(pushed, status.pushed, lastPush, status.pushes, MotionEventType::PUSH,
+          std::fmax(std::fmax(std::fabs(excess), std::fabs(lateralSpeed)), std::fabs(turnExcess)), now);
+    track(colliding, status.colliding, lastCollision, status.collisions, MotionEventType::COLLISION, acceleration,
+          now);
+    if (slipping || pushed || colliding) {
+        lastDisturbed = now;
+        disturbedOnce = true;
+    }
+    status.trusted = !disturbedOnce || now - lastDisturbed >= settings.recoveryTime;
+    publish();
+
+    if (!settings.degrade || !(slipping || pushed || colliding)) return;
+    // whatever the sensors disagree on this update could have gone into the pose. The IMU is right about turns
+    // unless the robot was turned by something else
+    const float positionError =
+        (std::fabs(excess) + std::fabs(lateralSpeed)) * dt + (collided ? settings.collisionError : 0);
+    const float headingError = pushed ? lemlib::degToRad(std::fabs(turnExcess)) * dt : 0;
+    widenPoseEstimate(positionError, headingError);
+}
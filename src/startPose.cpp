@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <cmath>
+#include "lemlib/util.hpp"
+#include "pros/rtos.hpp"
+#include "startPose.hpp"
+
+namespace {
+constexpr float MM_PER_INCH = 25.4;
+constexpr float INCHES_PER_METER = 39.3701;
+// the sensor only reports a confidence beyond this, in millimeters
+constexpr int32_t CONFIDENCE_RANGE = 200;
+// what the sensor reads when it sees nothing, in millimeters
+constexpr int32_t NO_OBJECT = 9999;
+// distance sensors report a new reading every 33ms
+constexpr uint32_t SAMPLE_INTERVAL = 33;
+constexpr int ITERATIONS = 10;
+// how far each of x, y and theta is moved to work out how the residuals change, in inches and radians
+constexpr float STEP[3] = {1e-2, 1e-2, 1e-3};
+
+enum { X, Y, THETA };
+
+float square(float value) { return value * value; }
+
+float determinant(const float m[3][3]) {
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+           m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+}
+
+struct Reading {
+        const WallSensor* sensor;
+        // along the beam, in inches
+        float distance;
+};
+
+/**
+ * @brief Where a sensor's beam meets the walls
+ *
+ * @param pose the pose of the robot, in radians
+ * @return the distance along the beam, in inches
+ */
+float predict(const WallSensor& sensor, const float pose[3], const FieldWalls& walls) {
+    const float sin = std::sin(pose[THETA]);
+    const float cos = std::cos(pose[THETA]);
+    const float x = pose[X] + sensor.x * cos + sensor.y * sin;
+    const float y = pose[Y] - sensor.x * sin + sensor.y * cos;
+    const float beam = pose[THETA] + lemlib::degToRad(sensor.heading);
+    const float dx = std::sin(beam);
+    const float dy = std::cos(beam);
+    float distance = INFINITY;
+    if (dx > 0) distance = std::fmin(distance, (walls.right - x) / dx);
+    if (dx < 0) distance = std::fmin(distance, (walls.left - x) / dx);
+    if (dy > 0) distance = std::fmin(distance, (walls.top - y) / dy);
+    if (dy < 0) distance = std::fmin(distance, (walls.bottom - y) / dy);
+    return distance;
+}
+
+/**
+ * @brief Finds the pose near a start that best explains the readings
+ */
+class Fit {
+    public:
+        Fit(const std::vector<Reading>& readings, const FieldWalls& walls, const StartPoseSettings& settings)
+            : readings(readings),
+              walls(walls),
+              settings(settings),
+              inlier(readings.size()) {}
+
+        // the average GPS pose, in inches and radians. theta is NAN when the GPS heading isn't used
+        bool hasGps = false;
+        float gps[3] = {0, 0, NAN};
+        float gpsVariance = 0;
+
+        /**
+         * @brief Gauss-Newton from the start, with the readings that fit each iteration
+         *
+         * @param start the start, in radians
+         * @param pose the pose found, in radians
+         * @return the sum of the squared residuals, with the readings left out counted at outlierDistance
+         */
+        float solve(const float start[3], float pose[3]) {
+            std::copy(start, start + 3, pose);
+            for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+                // the robot may be further from the start than a reading may be off, so let in anything within the
+                // placement spread until the pose has moved to the readings
+                classify(pose, iteration < ITERATIONS / 2 ? std::fmax(settings.outlierDistance,
+                                                                      2 * settings.placementSpread)
+                                                          : settings.outlierDistance);
+                float residual[MAX_ROWS];
+                const int rows = residuals(start, pose, residual);
+                float jacobian[MAX_ROWS][3];
+                for (int j = 0; j < 3; j++) {
+                    float moved[3] = {pose[X], pose[Y], pose[THETA]};
+                    moved[j] += STEP[j];
+                    float shifted[MAX_ROWS];
+                    residuals(start, moved, shifted);
+                    for (int i = 0; i < rows; i++) jacobian[i][j] = (shifted[i] - residual[i]) / STEP[j];
+                }
+                // the normal equations, solved by Cramer's rule
+                float a[3][3] = {};
+                float b[3] = {};
+                for (int i = 0; i < rows; i++) {
+                    for (int j = 0; j < 3; j++) {
+                        b[j] -= jacobian[i][j] * residual[i];
+                        for (int k = 0; k < 3; k++) a[j][k] += jacobian[i][j] * jacobian[i][k];
+                    }
+                }
+                const float divisor = determinant(a);
+                if (std::fabs(divisor) < 1e-12f) break;
+                float step[3];
+                for (int j = 0; j < 3; j++) {
+                    float replaced[3][3];
+                    for (int r = 0; r < 3; r++) {
+                        for (int c = 0; c < 3; c++) replaced[r][c] = c == j ? b[r] : a[r][c];
+                    }
+                    step[j] = determinant(replaced) / divisor;
+                }
+                for (int j = 0; j < 3; j++) pose[j] += step[j];
+                const bool settled = std::fabs(step[X]) + std::fabs(step[Y]) < 1e-3f && std::fabs(step[THETA]) < 1e-4f;
+                if (settled && iteration >= ITERATIONS / 2) break;
+            }
+            classify(pose, settings.outlierDistance);
+            float residual[MAX_ROWS];
+            const int rows = residuals(start, pose, residual);
+            float cost = 0;
+            for (int i = 0; i < rows; i++) cost += square(residual[i]);
+            return cost + (readings.size() - inliers()) * square(settings.outlierDistance / settings.distanceNoise);
+        }
+
+        int inliers() const { return std::count(inlier.begin(), inlier.end(), true); }
+    private:
+        // the placement, the readings and the GPS. Any readings past MAX_READINGS are left out
+        static constexpr size_t MAX_READINGS = 16;
+        static constexpr int MAX_ROWS = 3 + MAX_READINGS + 3;
+
+        /**
+         * @brief Which readings are of a wall, seen from a pose
+         *
+         * @param gate how far a reading may be from what the pose predicts, in inches
+         */
+        void classify(const float pose[3], float gate) {
+            for (size_t i = 0; i < readings.size(); i++) {
+                const float error = readings[i].distance - predict(*readings[i].sensor, pose, walls);
+                inlier[i] = i < MAX_READINGS && std::fabs(error) <= gate;
+            }
+        }
+
+        /**
+         * @brief How far each measurement is from what the pose predicts, in standard deviations
+         *
+         * @return how many there are
+         */
+        int residuals(const float start[3], const float pose[3], float* residual) const {
+            int rows = 0;
+            residual[rows++] = (pose[X] - start[X]) / settings.placementSpread;
+            residual[rows++] = (pose[Y] - start[Y]) / settings.placementSpread;
+            residual[rows++] =
+                std::remainder(pose[THETA] - start[THETA], 2 * M_PI) / lemlib::degToRad(settings.headingSpread);
+            for (size_t i = 0; i < readings.size(); i++) {
+                if (!inlier[i]) continue;
+                residual[rows++] =
+                    (predict(*readings[i].sensor, pose, walls) - readings[i].distance) / settings.distanceNoise;
+            }
+            if (hasGps) {
+                const float deviation = std::sqrt(gpsVariance);
+                residual[rows++] = (pose[X] - gps[X]) / deviation;
+                residual[rows++] = (pose[Y] - gps[Y]) / deviation;
+                if (std::isfinite(gps[THETA])) {
+                    residual[rows++] = std::remainder(pose[THETA] - gps[THETA], 2 * M_PI) /
+                                       lemlib::degToRad(settings.gpsHeadingNoise);
+                }
+            }
+            return rows;
+        }
+
+        const std::vector<Reading>& readings;
+        const FieldWalls& walls;
+        const StartPoseSettings& settings;
+        std::vector<bool> inlier;
+};
+} // namespace
+
+StartPoseResult detectStartPose(lemlib::Chassis& chassis, const std::vector<WallSensor>& sensors, pros::Gps* gps,
+                                const lemlib::Pose& expected, const std::vector<lemlib::Pose>& starts,
+                                const FieldWalls& walls, const StartPoseSettings& settings) {
+    StartPoseResult result;
+    // read everything for a moment, since a single reading of a distance sensor is noisy
+    std::vector<std::vector<float>> samples(sensors.size());
+    float gpsSum[4] = {};
+    int gpsSamples = 0;
+    float gpsError = 0;
+    const uint32_t begin = pros::millis();
+    do {
+        for (size_t i = 0; i < sensors.size(); i++) {
+            const int32_t millimeters = sensors[i].sensor->get_distance();
+            const int32_t confidence = sensors[i].sensor->get_confidence();
+            const bool confident = millimeters <= CONFIDENCE_RANGE || confidence >= settings.minConfidence;
+            const float distance = millimeters / MM_PER_INCH;
+            if (millimeters == PROS_ERR || millimeters >= NO_OBJECT || confidence == PROS_ERR || !confident ||
+                distance > settings.maxDistance)
+                continue;
+            samples[i].push_back(distance);
+        }
+        if (gps != nullptr) {
+            const double error = gps->get_error() * INCHES_PER_METER;
+            const pros::gps_status_s_t status = gps->get_position_and_orientation();
+            if (std::isfinite(error) && error <= settings.gpsMaxError && std::isfinite(status.x) &&
+                std::isfinite(status.y) && std::isfinite(status.yaw)) {
+                gpsSum[X] += status.x * INCHES_PER_METER;
+                gpsSum[Y] += status.y * INCHES_PER_METER;
+                // headings are averaged as vectors, so 359 and 1 average to 0
+                gpsSum[2] += std::sin(lemlib::degToRad(status.yaw));
+                gpsSum[3] += std::cos(lemlib::degToRad(status.yaw));
+                gpsError = std::fmax(gpsError, error);
+                gpsSamples++;
+            }
+        }
+        pros::delay(SAMPLE_INTERVAL);
+    } while (pros::millis() - begin < settings.sampleTime);
+
+    std::vector<Reading> readings;
+    for (size_t i = 0; i < sensors.size(); i++) {
+        std::vector<float>& taken = samples[i];
+        if (taken.empty()) {
+            result.rejected++;
+            continue;
+        }
+        std::nth_element(taken.begin(), taken.begin() + taken.size() / 2, taken.end());
+        readings.push_back({&sensors[i], taken[taken.size() / 2]});
+    }
+    Fit fit(readings, walls, settings);
+    if (gpsSamples > 0) {
+        fit.hasGps = true;
+        fit.gps[X] = gpsSum[X] / gpsSamples;
+        fit.gps[Y] = gpsSum[Y] / gpsSamples;
+        if (settings.gpsHeadingNoise > 0) fit.gps[THETA] = std::atan2(gpsSum[2], gpsSum[3]);
+        // the readings are averaged, but their errors are mostly the same, so don't trust the average any more
+        fit.gpsVariance = square(std::fmax(gpsError, 0.25f));
+        result.usedGps = true;
+    }
+    if (readings.empty() && !fit.hasGps) {
+        result.error = "no distance sensor or GPS readings";
+        return result;
+    }
+
+    // try every start, and keep the one whose pose explains the readings best
+    const std::vector<lemlib::Pose> candidates = starts.empty() ? std::vector<lemlib::Pose> {expected} : starts;
+    float bestCost = INFINITY;
+    float best[3] = {};
+    int bestInliers = 0;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const float start[3] = {candidates[i].x, candidates[i].y, lemlib::degToRad(candidates[i].theta)};
+        float pose[3];
+        const float cost = fit.solve(start, pose);
+        if (cost >= bestCost) continue;
+        bestCost = cost;
+        std::copy(pose, pose + 3, best);
+        bestInliers = fit.inliers();
+        result.start = i;
+    }
+    result.accepted = bestInliers;
+    result.rejected += readings.size() - bestInliers;
+    if (bestInliers == 0 && !fit.hasGps) {
+        result.start = -1;
+        result.error = "no reading fits any start";
+        return result;
+    }
+
+    result.fieldPose = {best[X], best[Y], lemlib::radToDeg(best[THETA])};
+    const lemlib::Pose& start = candidates[result.start];
+    result.positionError = std::hypot(best[X] - expected.x, best[Y] - expected.y);
+    result.headingError = lemlib::radToDeg(std::remainder(best[THETA] - lemlib::degToRad(expected.theta), 2 * M_PI));
+    const bool otherStart = std::hypot(start.x - expected.x, start.y - expected.y) > settings.tolerance ||
+                            std::fabs(std::remainder(start.theta - expected.theta, 360)) > settings.headingTolerance;
+    result.misplaced = otherStart || result.positionError > settings.tolerance ||
+                       std::fabs(result.headingError) > settings.headingTolerance;
+    result.ok = true;
+    // the robot was set up for another routine. Running the selected one from a pose in the frame of the wrong start
+    // would send it somewhere else entirely, so report it and leave the pose alone
+    if (otherStart) return result;
+
+    // routines start at (0, 0, 0) at the expected start, so put the robot where it is relative to that
+    const float heading = lemlib::degToRad(expected.theta);
+    const float dx = best[X] - expected.x;
+    const float dy = best[Y] - expected.y;
+    chassis.setPose(dx * std::cos(heading) - dy * std::sin(heading), dx * std::sin(heading) + dy * std::cos(heading),
+                    result.headingError);
+    result.poseSet = true;
+    return result;
+}